@@ -31,6 +31,7 @@
 const int sensitive_pins[] PROGMEM = SENSITIVE_PINS; // Sensitive pin list for M42
 
 void check_periodical() {
+  DELTA_GENERATE_SEGMENTS;
   if(!execute_periodical) return;
   execute_periodical=0;
   manage_temperatures();
@@ -49,6 +50,9 @@ void check_periodical() {
   commands and manages temperatures.
 */
 void wait_until_end_of_move() {
+#if DRIVE_SYSTEM==3
+  delta_split_continue(true);
+#endif
   while(lines_count) {
     gcode_read_serial();
     check_periodical(); 
@@ -109,7 +113,6 @@ void set_fan_speed(int speed,bool wait) {
 }
 #if DRIVE_SYSTEM==3
 void delta_move_to_top_endstops(float feedrate) {
-  long up_steps = printer_state.zMaxSteps;
   for (byte i=0; i<3; i++)
     printer_state.currentPositionSteps[i] = 0;
   calculate_delta(printer_state.currentPositionSteps, printer_state.currentDeltaPositionSteps);
@@ -117,8 +120,8 @@ void delta_move_to_top_endstops(float feedrate) {
 }
 
 void home_axis(bool xaxis,bool yaxis,bool zaxis) {
-  long steps;
   bool homeallaxis = (xaxis && yaxis && zaxis) || (!xaxis && !yaxis && !zaxis);
+  delta_split_continue(true); // destinationSteps are set from the current position
   if (X_MAX_PIN > -1 && Y_MAX_PIN > -1 && Z_MAX_PIN > -1 && MAX_HARDWARE_ENDSTOP_X & MAX_HARDWARE_ENDSTOP_Y && MAX_HARDWARE_ENDSTOP_Z) {
     UI_STATUS_UPD(UI_TEXT_HOME_DELTA);
     // Homing Z axis means that you must home X and Y
@@ -126,15 +129,15 @@ void home_axis(bool xaxis,bool yaxis,bool zaxis) {
       delta_move_to_top_endstops(homing_feedrate[0]);	
       move_steps(0,0,axis_steps_per_unit[0]*-ENDSTOP_Z_BACK_MOVE,0,homing_feedrate[0]/ENDSTOP_X_RETEST_REDUCTION_FACTOR, true, false);
       delta_move_to_top_endstops(homing_feedrate[0]/ENDSTOP_X_RETEST_REDUCTION_FACTOR);	
-      printer_state.currentPositionSteps[0] = 0;
-      printer_state.currentPositionSteps[1] = 0;
-      printer_state.currentPositionSteps[2] = printer_state.zMaxSteps;
-      calculate_delta(printer_state.currentPositionSteps, printer_state.currentDeltaPositionSteps);
-      printer_state.maxDeltaPositionSteps = printer_state.currentDeltaPositionSteps[0];
+      // All carriages are at the endstops now, the per tower corrections move the effector off x=y=0, z=zMaxSteps
+      long height = delta_endstop_height();
+      for (byte i=0; i<3; i++)
+        printer_state.currentDeltaPositionSteps[i] = printer_state.maxDeltaPositionSteps[i] = height;
+      calculate_cartesian(printer_state.currentDeltaPositionSteps, printer_state.currentPositionSteps);
     } else {
       if (xaxis) printer_state.destinationSteps[0] = 0;
       if (yaxis) printer_state.destinationSteps[1] = 0;
-      split_delta_move(true,false,false);
+      split_delta_move(true,false,false,true);
     }
     printer_state.countZSteps = 0;
     UI_CLEAR_STATUS 
@@ -215,7 +218,7 @@ void home_axis(bool xaxis,bool yaxis,bool zaxis) {
 // Digipot methods for controling current and microstepping
 
 #if defined(DIGIPOTSS_PIN) && DIGIPOTSS_PIN > -1
-int digitalPotWrite(int address, unsigned int value) // From Arduino DigitalPotControl example
+void digitalPotWrite(int address, unsigned int value) // From Arduino DigitalPotControl example
 {
     digitalWrite(DIGIPOTSS_PIN,LOW); // take the SS pin low to select the chip
     SPI.transfer(address); //  send in the address and value via SPI:
@@ -377,6 +380,15 @@ void process_command(GCode *com,byte bufferedCommand)
       return;      
     }
   }
+#endif
+#if ARC_SUPPORT
+  mc_arc_continue(true); // Position is only valid after the last arc segment
+#endif
+#if DRIVE_SYSTEM == 3
+  delta_split_continue(true); // and after the last line of a delta move
+#endif
+#if MOVE_COALESCING
+  if(!GCODE_HAS_G(com) || com->G>1) coalesce_flush(); // Only G0/G1 can be merged
 #endif
   if(GCODE_HAS_G(com))
   {
@@ -385,8 +397,10 @@ void process_command(GCode *com,byte bufferedCommand)
       case 0: // G0 -> G1
       case 1: // G1
         if(get_coordinates(com)) // For X Y Z E F
-#if DRIVE_SYSTEM == 3
-          split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true);
+#if MOVE_COALESCING
+          coalesce_move();
+#elif DRIVE_SYSTEM == 3
+          split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true, false);
 #else
           queue_move(ALWAYS_CHECK_ENDSTOPS,true);
 #endif
@@ -963,7 +977,7 @@ void process_command(GCode *com,byte bufferedCommand)
      case 223: // Extruder interrupt test
         if(GCODE_HAS_S(com))
           printer_state.extruderStepsNeeded+=com->S;
-          break;
+        break;
      case 232:
        out.print_int_P(PSTR(" linear steps:"),maxadv2);
  #ifdef ENABLE_QUADRATIC_ADVANCE
@@ -1030,6 +1044,58 @@ void process_command(GCode *com,byte bufferedCommand)
     case 400: // Finish all moves
       wait_until_end_of_move();
       break;
+#ifdef DEBUG_PLANNER_STATS
+    case 260: // M260 S1 - Report planner statistics, S1 resets them
+      planner_stats_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#endif
+    case 261: // M261 S1 - Report move buffer starvations, S1 resets them
+      buffer_stats_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#ifdef DEBUG_ISR_PROFILER
+    case 262: // M262 S1 - Report stepper interrupt profile, S1 resets it
+      isr_profile_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#endif
+#if STEP_TIMING_MONITOR
+    case 263: // M263 S1 - Report missed step deadlines, S1 resets them
+      step_timing_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#endif
+#if DRIVE_SYSTEM==3
+    case 264: // M264 S1 - Report delta segment cache use, S1 resets peak and waits
+      delta_segment_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#endif
+#if DRIVE_SYSTEM==3
+    case 266: // M266 P<tower 1-3> X<rod> Y<radius> Z<angle> S1 - Per tower delta corrections, S1 stores them
+      if(GCODE_HAS_P(com) && com->P>=1 && com->P<=3 && !GCODE_HAS_NO_XYZ(com)) {
+        byte t = com->P-1;
+        wait_until_end_of_move();
+        if(GCODE_HAS_X(com)) printer_state.deltaRodCorrection[t] = com->X;
+        if(GCODE_HAS_Y(com)) printer_state.deltaRadiusCorrection[t] = com->Y;
+        if(GCODE_HAS_Z(com)) printer_state.deltaAngleCorrection[t] = com->Z;
+        update_ramps_parameter(); // Tower positions stay, so home again to get the cartesian position right
+      }
+      for(byte i=0;i<3;i++) {
+        OUT_P_I("Tower ",i+1);
+        OUT_P_F(" rod:",printer_state.deltaRodCorrection[i]);
+        OUT_P_F(" radius:",printer_state.deltaRadiusCorrection[i]);
+        OUT_P_F_LN(" angle:",printer_state.deltaAngleCorrection[i]);
+      }
+#if EEPROM_MODE!=0
+      if(GCODE_HAS_S(com) && com->S==1) {
+        epr_data_to_eeprom(false);
+        OUT_P_LN("EEPROM updated");
+      }
+#endif
+      break;
+#endif
+#ifdef DEBUG_STEP_TRACE
+    case 265: // M265 S1 - Write step trace, S1 starts a new one
+      step_trace_report(GCODE_HAS_S(com) && com->S==1);
+      break;
+#endif
 #if FEATURE_MEMORY_POSITION
     case 401: // Memory position
       printer_state.memoryX = printer_state.currentPositionSteps[0];
@@ -1049,7 +1115,6 @@ void process_command(GCode *com,byte bufferedCommand)
     case 908: // Control digital trimpot directly.
       {        
 #if STEPPER_CURRENT_CONTROL != CURRENT_CONTROL_MANUAL
-        uint8_t channel,current;
         if(GCODE_HAS_P(com) && GCODE_HAS_S(com)) 
           set_current((uint8_t)com->P, (unsigned int)com->S);
 #endif
@@ -1110,7 +1175,7 @@ void process_command(GCode *com,byte bufferedCommand)
       } else if (com->S == 1) {
 	OUT_P_L_LN("Measure/delta (Steps) =",printer_state.countZSteps * inv_axis_steps_per_unit[2]);
 	OUT_P_L_LN("Measure/delta =",printer_state.countZSteps * inv_axis_steps_per_unit[2]);
-      } else if (com->S = 2) {
+      } else if (com->S == 2) {
         if (printer_state.countZSteps < 0)
 	  printer_state.countZSteps = -printer_state.countZSteps;
 	printer_state.zMin = 0;
@@ -137,6 +137,25 @@ the wrong direction change INVERT_X_DIR or INVERT_Y_DIR.
     Mega. */
     #define MAX_DELTA_SEGMENTS_PER_LINE 30
 
+    /** \brief RAM in bytes for the delta segments of all cached lines.
+
+    All lines take their segments from one ring, so a long line can use the entries short lines don't need.
+    With 0 the ring has MAX_DELTA_SEGMENTS_PER_LINE * MOVE_CACHE_SIZE entries. Otherwise it gets as many
+    7 byte entries (13 byte with DELTA_JIT_SEGMENTS) as fit into this budget, at least MAX_DELTA_SEGMENTS_PER_LINE.
+    A line is queued when all its segments fit. Until then the main loop goes on and the next command waits.
+    M264 reports the usage. */
+    #define DELTA_SEGMENT_RAM 0
+
+    /** \brief Generate the delta segments shortly before they are needed.
+
+    With 1 a queued line stores its start and end position only. The main loop computes the segments one line
+    ahead of the stepper interrupt, so the segment cache needs to hold only two lines and gets
+    2 * MAX_DELTA_SEGMENTS_PER_LINE entries if DELTA_SEGMENT_RAM is 0. Each line needs 49 more bytes and the tower
+    positions are computed twice, once to plan the line and once to generate the segments. A line waits if its
+    segments are not ready when it should start; M264 counts these stalls. The segments store 32 bit step counts,
+    so long moves need no extra segments to stay inside 16 bit. */
+    #define DELTA_JIT_SEGMENTS 0
+
     // Calculations
     #define AXIS_STEPS_PER_MM ((float)(MICRO_STEPS * STEPS_PER_ROTATION) / PULLEY_CIRCUMFERENCE)
     #define XAXIS_STEPS_PER_MM AXIS_STEPS_PER_MM
@@ -681,6 +700,20 @@ on this endstop.
 // can set it on for safety.
 #define ALWAYS_CHECK_ENDSTOPS true
 
+/** \brief Watch the hardware endstops with pin change interrupts.
+
+Instead of reading all endstop pins on every step, a pin change interrupt latches triggered endstops
+in one byte and the stepper interrupt only reads the pins, while that byte is set. Only endstops in the
+direction of the current move are latched, so an endstop held while moving away from it costs nothing.
+Endstops on pins without pin change interrupt are still read on every step of a move towards them.
+Set 1 to enable.
+*/
+#define ENDSTOP_INTERRUPTS 0
+/** Number of consecutive steps an endstop must read triggered, before the move stops on it. Every
+endstop is counted on its own. 1 stops on the first trigger like polling does. Higher values filter
+noise on the endstop lines. Only used with ENDSTOP_INTERRUPTS. */
+#define ENDSTOP_DEBOUNCE 1
+
 // maximum positions in mm - only fixed numbers!
 // For delta robot Z_MAX_LENGTH is maximum travel of the towers and should be set to the distance between the hotend
 // and the platform when the printer is at its home position.
@@ -717,6 +750,26 @@ on this endstop.
 #define DELTA_SEGMENTS_PER_SECOND_PRINT 200 // Move accurate setting for print moves
 #define DELTA_SEGMENTS_PER_SECOND_MOVE 200 // Less accurate setting for other moves
 
+/** \brief Choose the number of delta segments from the path error instead of the move time.
+
+With 1 xy moves get as many segments as needed to keep the effector within DELTA_SEGMENT_MAX_ERROR mm of the
+straight line. Near the center the tower motion is nearly linear and few segments are needed, near the rim
+more segments are used. DELTA_SEGMENTS_PER_SECOND_PRINT and DELTA_SEGMENTS_PER_SECOND_MOVE are then not used.
+*/
+#define DELTA_ADAPTIVE_SEGMENTS 0
+/** \brief Maximum deviation in mm from the straight line for DELTA_ADAPTIVE_SEGMENTS. */
+#define DELTA_SEGMENT_MAX_ERROR 0.01
+
+/** \brief Compute the tower heights with integer math.
+
+With 1 the tower positions are rounded to whole steps and the square roots are computed with integer Newton
+iterations, started at the root of the last computed position. Consecutive segments are close together, so
+normally one iteration with a 32 bit division replaces the float conversions and float sqrt. Results are
+rounded down like before and may differ by one step because of the rounded tower positions. With 0 the float
+math truncates the radicand to a whole number before the square root, as it always did.
+*/
+#define DELTA_INCREMENTAL_IK 0
+
 /** \brief Horizontal offset of the universal joints on the end effector (moving platform).
 */
 #define END_EFFECTOR_HORIZONTAL_OFFSET 33
@@ -733,6 +786,16 @@ on this endstop.
 */
 #define DELTA_RADIUS (PRINTER_RADIUS-END_EFFECTOR_HORIZONTAL_OFFSET-CARRIAGE_HORIZONTAL_OFFSET+0.675)
 
+/** \brief Per tower corrections for tower 1 (front left), 2 (front right) and 3 (back).
+
+Rod length and radius corrections are in mm and are added to DELTA_DIAGONAL_ROD and DELTA_RADIUS. Angle
+corrections are in degree and turn the tower counter clockwise from its nominal 210, 330 and 90 degree.
+The values can be changed with M266 and are stored in EEPROM with a resolution of 0.01.
+*/
+#define DELTA_ROD_CORRECTION {0,0,0}
+#define DELTA_RADIUS_CORRECTION {0,0,0}
+#define DELTA_ANGLE_CORRECTION {0,0,0}
+
 /** \brief Enable counter to count steps for Z max calculations
 */
 #define STEP_COUNTER
@@ -779,6 +842,28 @@ own weight, so this is nearly never needed. */
 /** Comment this to disable ramp acceleration */
 #define RAMP_ACCELERATION 1
 
+/** \brief Use a jerk limited S-curve instead of constant acceleration.
+
+Acceleration and deceleration phases are split into 3 parts each: acceleration rises linear, stays constant,
+and falls back to zero. Together with the plateau this gives the 7 phase profile. Ramp time and distance are the
+same as with the trapezoid profile, but the peak acceleration is higher by 100/(100-S_CURVE_JERK_PERCENT).
+Only used with RAMP_ACCELERATION. Uncomment to enable.
+*/
+//#define S_CURVE_ACCELERATION
+/** Percentage of each ramp where the acceleration changes. Range 10-50, 50 means no constant acceleration part. */
+#define S_CURVE_JERK_PERCENT 25
+
+/** \brief Number of precomputed step intervals per acceleration and deceleration ramp.
+
+With tables the main loop computes the step intervals of both ramps when it computes the step
+parameter of a move, so the stepper interrupt only has to look them up instead of calling ComputeV
+and CPUDivU2 for every step. Each entry covers a power of 2 steps, so the speed rises in small
+stairs. Larger tables give smoother ramps, but each entry needs 4 byte per move cache entry,
+8 byte with USE_ADVANCE. Set 0 to compute the speed in the stepper interrupt. Not usable with
+S_CURVE_ACCELERATION.
+*/
+#define RAMP_TABLE_SIZE 0
+
 /** If your stepper needs a longer high signal then given, you can add a delay here.
 The delay is realized as a simple loop wasting time, which is not available for other
 computations. So make it as low as possible. For the most common drivers no delay is needed, as the
@@ -786,6 +871,35 @@ included delay is already enough.
 */
 #define STEPPER_HIGH_DELAY 0
 
+/** \brief End the last step pulse of an interrupt with the next interrupt.
+
+Normally the stepper and extruder interrupts wait STEPPER_HIGH_DELAY after each step and set the
+step pins low again. With split pulses the pins of the last step stay high until the next call of the
+same interrupt, which is always several microseconds later. The wait is then only needed between
+the steps of a double or quad step loop. Drivers only react on the rising edge, so the longer high
+time is no problem. Set 1 to enable.
+*/
+#define SPLIT_STEP_PULSE 0
+
+/** \brief Let the stepper interrupt make the advance and OPS extruder steps.
+
+With advance or OPS, extruder steps are normally made by a separate timer interrupt at a fixed rate.
+If enabled, the stepper interrupt inserts them between its own steps while moves are executed, with
+the same minimum distance between steps, and the separate interrupt only runs while no move is
+executed. This saves an interrupt call per extruder step. Set 1 to enable.
+*/
+#define UNIFIED_EXTRUDER_STEPPING 0
+
+/** \brief Set the step pins of all axes with one write per port.
+
+The bresenham loop collects the step pins of x, y, z (and the extruder, if only one exists) in masks
+and writes them with one OR per port, followed by one AND per port to end the pulse. Which pins share
+a port is derived from pins.h at compile time. This saves interrupt time per step, but all pulses
+start at the same time and get shorter, so increase STEPPER_HIGH_DELAY if your drivers lose steps.
+Set 1 to enable.
+*/
+#define STEPPER_PORT_BATCHING 0
+
 /** The firmware can only handle 16000Hz interrupt frequency cleanly. If you need higher speeds 
 a faster solution is needed, and this is to double/quadruple the steps in one interrupt call.
 This is like reducing your 1/16th microstepping to 1/8 or 1/4. It is much cheaper then 1 or 3
@@ -793,10 +907,25 @@ additional stepper interrupts with all it's overhead. As a result you can go as
 40000Hz.
 */
 #define STEP_DOUBLER_FREQUENCY 12000
-/** If you need frequencies off more then 30000 you definitely need to enable this. If you have only 1/8 stepping 
-enabling this may cause to stall your moves when 20000Hz is reached.
+/** \brief Maximum number of steps per speed computation. Allowed values are 1, 2, 4 and 8.
+
+The stepper interrupt uses the smallest power of 2 steps per speed computation, that keeps the rate
+of speed computations below STEP_DOUBLER_FREQUENCY, but not more then this. If you need frequencies of
+more then 30000 you need 4. Without STEPPER_LOOP_SPREAD the steps are done in one call and follow each
+other after DOUBLE_STEP_DELAY, so they are up to 3/4 of the call interval early. 8 is only allowed
+with STEPPER_LOOP_SPREAD.
+If you have only 1/8 stepping higher values may cause to stall your moves when 20000Hz is reached.
+Replaces ALLOW_QUADSTEPPING.
+*/
+#define MAX_STEPPER_LOOPS 4
+/** \brief Spread the steps of a speed computation evenly over its interval.
+
+With 1 every step gets its own timer interrupt at 1/MAX_STEPPER_LOOPS of the interval. Only the first
+of them computes the speed, the others just step. This costs the entry and endstop checks of the
+additional interrupts, but the steps are where the speed profile wants them.
+With 0 all steps of a speed computation are done in one interrupt.
 */
-#define ALLOW_QUADSTEPPING true
+#define STEPPER_LOOP_SPREAD 0
 /** If you reach STEP_DOUBLER_FREQUENCY the firmware will do 2 or 4 steps with nearly no delay. That can be too fast
 for some printers causing an early stall. 
 
@@ -808,6 +937,14 @@ the double computation cost. For slow movements this is not an issue, but for re
 too much. The value specified here is the number of clock cycles between a step on the driving axis.
 If the interval at full speed is below this value, smoothing is disabled for that line.*/
 #define MAX_HALFSTEP_INTERVAL 1999
+/** \brief Split slow steps into two interrupts.
+
+With 1 lines slower then MAX_HALFSTEP_INTERVAL step in one interrupt and update the speed in the next one.
+With 0 every interrupt steps and updates the speed, so the step timing does not depend on the line speed and
+the halfstep switching code is not compiled. The speed update comes after the step pulses, so it does not delay
+them. Combine it with RAMP_TABLE_SIZE to make the speed update cost the same for every step.
+*/
+#define HALFSTEPPING 1
 
 //// Acceleration settings
 
@@ -849,6 +986,29 @@ Overridden if EEPROM activated.
 #define MAX_JERK 20.0
 #define MAX_ZJERK 20.0
 
+/** \brief Cornering model used to compute the speed at the join of two segments.
+
+0 = Jerk model. The speed difference at the join is limited by MAX_JERK/MAX_ZJERK as described above.
+1 = Junction deviation model. The corner is treated as a circle that deviates JUNCTION_DEVIATION mm from
+the sharp corner. The junction speed is the speed where the centripetal acceleration on that circle equals
+the acceleration of the segments. Near collinear segments, e.g. from tesselated curves, get much higher
+speeds and sharp corners get slower. MAX_JERK is still used for the start speed.
+*/
+#define JUNCTION_MODEL 0
+/** Deviation from the sharp corner in mm used by the junction deviation model. */
+#define JUNCTION_DEVIATION 0.02
+
+/** \brief Use integer math in the path planner.
+
+If defined, junction, start and end speeds are kept as 16 bit integers (1/16 mm/s) and squared speeds as
+32 bit integers. The look ahead then uses an integer square root instead of float sqrt, which allows more
+short segments per second to be planned, e.g. for dense curves. Speeds above 4095 mm/s are clipped.
+Disabled by default, the float planner is the reference. make check in host/ compares the lines of both
+and reports the lines planned per second of both with planbench. The host has a FPU, so the integer
+planner is not faster there, its gain can only be measured on the AVR.
+*/
+//#define FIXED_POINT_PLANNER
+
 /** \brief Number of moves we can cache in advance.
 
 This number of moves can be cached in advance. If you wan't to cache more, increase this. Especially on
@@ -856,19 +1016,47 @@ many very short moves the cache may go empty. The minimum value is 5.
 */
 #define MOVE_CACHE_SIZE 16
 
-/** \brief Low filled cache size. 
+/** \brief Number of moves, the path planner keeps its planning data for.
+
+Each cached move needs its step data, but the speed planning data is only needed until the end speed of the
+move is fixed. With a smaller planner cache the older moves get fixed with their current end speed, when the
+planner data is needed for a new move. Each planner entry needs 44 byte (40 byte with FIXED_POINT_PLANNER), so a
+smaller planner cache lets you increase MOVE_CACHE_SIZE without using much more RAM. With PLANNER_CACHE_SIZE equal to
+MOVE_CACHE_SIZE, as in the default 16/16, nothing is saved. Must be at least 4 and a divisor of MOVE_CACHE_SIZE, a
+power of 2 is a bit faster. The planner can't look ahead further then PLANNER_CACHE_SIZE moves. If not defined,
+it is MOVE_CACHE_SIZE.
+*/
+#define PLANNER_CACHE_SIZE 16
+
+/** \brief Buffered print time in milliseconds, below which moves get slowed down.
 
-If the cache contains less then MOVE_CACHE_LOW segments, the time per segment is limited to LOW_TICKS_PER_MOVE clock cycles.
-If a move would be shorter, the feedrate will be reduced. This should prevent buffer underflows. Set this to 0 if you
-don't care about empty buffers during print.
+The firmware sums up the time of all moves in the cache. If less then MOVE_BUFFER_HORIZON ms are left and a new
+move would be shorter then LOW_TICKS_PER_MOVE clock cycles, its feedrate is reduced. The less time is buffered, the
+more the move is slowed down. This prevents buffer underflows without slowing down a buffer full of short moves,
+which a simple line count can't distinguish from a buffer full of long moves. Set this to 0 if you don't care about
+empty buffers during print. Starvations and slowed moves are reported with M261.
 */
-#define MOVE_CACHE_LOW 10
-/** \brief Cycles per move, if move cache is low. 
+#define MOVE_BUFFER_HORIZON 100
+/** \brief Cycles per move, if the buffered time is low.
 
 This value must be high enough, that the buffer has time to fill up. The problem only occurs at the beginning of a print or
 if you are printing many very short segments at high speed. Higher delays here allow higher values in PATH_PLANNER_CHECK_SEGMENTS.
 */
 #define LOW_TICKS_PER_MOVE 250000
+/** \brief Detect missed step deadlines at runtime.
+
+If the stepper interrupt needs longer then the interval to the next step, the timer is set to fire 100 cycles
+later and the steps get late. With STEP_TIMING_MONITOR 1 these clamped deadlines, their lateness and the lines
+they occur in are counted and reported with M263. The counting costs a few cycles per interrupt.
+*/
+#define STEP_TIMING_MONITOR 0
+/** \brief Maximum feedrate reduction in percent on missed step deadlines.
+
+Needs STEP_TIMING_MONITOR. Every line with missed deadlines reduces the feedrate of new moves by another 5%
+up to this value. 16 lines without misses take back 1%. Moves already in the cache are not changed. 0 disables
+the reduction.
+*/
+#define STEP_OVERRUN_SLOWDOWN 0
 
 // ##########################################################################################
 // ##                           Extruder control                                           ##
@@ -1046,6 +1234,31 @@ IMPORTANT: With mode <>0 some changes in configuration.h are not set any more, a
 #define SD_EXTENDED_DIR
 // If you want support for G2/G3 arc commands set to true, otherwise false.
 #define ARC_SUPPORT true
+/** Arcs are split into lines, so that the lines deviate at most ARC_MAX_CHORD_ERROR mm from the arc.
+Small radii get short lines, big radii long lines. */
+#define ARC_MAX_CHORD_ERROR 0.01
+/** Upper limit for the number of lines per second of an arc, at the arc speed after the centripetal
+acceleration limit. Each line needs a path planner run, so the limit must be below what your printer can plan,
+otherwise the move cache runs empty. If the limit is reached the chord error gets larger.
+To derive it, enable DEBUG_PLANNER_STATS, print some arcs and read the max. planning time with M260. Serial
+input and the other main loop tasks need time, too, so use at most 500000/max. planning time [us].
+The default of 100 allows 5 ms per line. planbench measures the same on the host (about 30 us per line,
+so over 10000 lines per second), these numbers are no measure for an AVR. */
+#define ARC_SEGMENTS_PER_SECOND 100
+
+/** \brief Merge nearly collinear G0/G1 moves before they reach the path planner.
+
+High resolution STL exports produce long runs of tiny moves on nearly straight lines. Each of them costs a path
+planner run and an entry in the move cache. If enabled, one move is held back and the next move is merged into it,
+if the direction changes less than MOVE_COALESCE_MAX_ANGLE degrees and the extrusion per mm differs less than
+MOVE_COALESCE_MAX_E_RATIO (relative). MOVE_COALESCE_MAX_DEVIATION limits the distance in mm between the skipped
+corners and the merged move, so long runs of small direction changes can't add up to a visible error.
+The held move is queued with the next non mergeable move, any other command or if no command is waiting.
+*/
+#define MOVE_COALESCING false
+#define MOVE_COALESCE_MAX_ANGLE 0.5
+#define MOVE_COALESCE_MAX_E_RATIO 0.02
+#define MOVE_COALESCE_MAX_DEVIATION 0.01
 
 /** You can store the current position with M401 and go back to it with M402. 
    This works only if feature is set to true. */
@@ -32,7 +32,7 @@ byte epr_compute_checksum() {
   byte checksum=0;
   for(i=0;i<2048;i++) {
     if(i==EEPROM_OFFSET+EPR_INTEGRITY_BYTE) continue;
-    checksum += eeprom_read_byte ((unsigned char *)(i));
+    checksum += eeprom_read_byte ((unsigned char *)(size_t)(i));
   }
   return checksum;
 }
@@ -40,16 +40,16 @@ byte epr_compute_checksum() {
 
 
 inline void epr_set_byte(uint pos,byte value) {
-  eeprom_write_byte((unsigned char *)(EEPROM_OFFSET+pos), value);
+  eeprom_write_byte((unsigned char *)(size_t)(EEPROM_OFFSET+pos), value);
 }
 inline void epr_set_int(uint pos,int value) {
-  eeprom_write_word((unsigned int*)(EEPROM_OFFSET+pos),value);
+  eeprom_write_word((unsigned int*)(size_t)(EEPROM_OFFSET+pos),value);
 }
 inline void epr_set_long(uint pos,long value) {
-  eeprom_write_dword((unsigned long*)(EEPROM_OFFSET+pos),value);
+  eeprom_write_dword((unsigned long*)(size_t)(EEPROM_OFFSET+pos),value);
 }
 inline void epr_set_float(uint pos,float value) {
-  eeprom_write_block(&value,(void*)(EEPROM_OFFSET+pos), 4);
+  eeprom_write_block(&value,(void*)(size_t)(EEPROM_OFFSET+pos), 4);
 }
 void epr_out_prefix(uint pos) {
   if(pos<EEPROM_EXTRUDER_OFFSET) return;
@@ -118,7 +118,6 @@ void epr_update(GCode *com) {
 /** \brief Copy data from EEPROM to variables.
 */
 void epr_eeprom_reset() {
-  byte version = EEPROM_PROTOCOL_VERSION;
   baudrate = BAUDRATE;
   max_inactive_time = MAX_INACTIVE_TIME*1000L;
   stepper_inactive_time = STEPPER_INACTIVE_TIME*1000L;
@@ -170,6 +169,9 @@ void epr_eeprom_reset() {
   printer_state.backlashX = X_BACKLASH;
   printer_state.backlashY = Y_BACKLASH;
   printer_state.backlashZ = Z_BACKLASH;
+#endif
+#if DRIVE_SYSTEM==3
+  delta_reset_corrections();
 #endif
   Extruder *e;
 #if NUM_EXTRUDER>0
@@ -431,6 +433,17 @@ void epr_data_to_eeprom(byte corrupted) {
   epr_set_float(EPR_BACKLASH_Y,0);
   epr_set_float(EPR_BACKLASH_Z,0);
 #endif
+  for(byte i=0;i<3;i++) {
+#if DRIVE_SYSTEM==3
+    epr_set_int(EPR_DELTA_ROD_CORRECTION+2*i,(int)(printer_state.deltaRodCorrection[i]*100.0+(printer_state.deltaRodCorrection[i]<0 ? -0.5 : 0.5)));
+    epr_set_int(EPR_DELTA_RADIUS_CORRECTION+2*i,(int)(printer_state.deltaRadiusCorrection[i]*100.0+(printer_state.deltaRadiusCorrection[i]<0 ? -0.5 : 0.5)));
+    epr_set_int(EPR_DELTA_ANGLE_CORRECTION+2*i,(int)(printer_state.deltaAngleCorrection[i]*100.0+(printer_state.deltaAngleCorrection[i]<0 ? -0.5 : 0.5)));
+#else
+    epr_set_int(EPR_DELTA_ROD_CORRECTION+2*i,0);
+    epr_set_int(EPR_DELTA_RADIUS_CORRECTION+2*i,0);
+    epr_set_int(EPR_DELTA_ANGLE_CORRECTION+2*i,0);
+#endif
+  }
 
   // now the extruder
   for(byte i=0;i<NUM_EXTRUDER;i++) {
@@ -535,6 +548,15 @@ void epr_eeprom_to_data() {
   printer_state.backlashX = epr_get_float(EPR_BACKLASH_X);
   printer_state.backlashY = epr_get_float(EPR_BACKLASH_Y);
   printer_state.backlashZ = epr_get_float(EPR_BACKLASH_Z);
+#endif
+#if DRIVE_SYSTEM==3
+  if(version>2) {
+    for(byte i=0;i<3;i++) {
+      printer_state.deltaRodCorrection[i] = epr_get_int(EPR_DELTA_ROD_CORRECTION+2*i)*0.01;
+      printer_state.deltaRadiusCorrection[i] = epr_get_int(EPR_DELTA_RADIUS_CORRECTION+2*i)*0.01;
+      printer_state.deltaAngleCorrection[i] = epr_get_int(EPR_DELTA_ANGLE_CORRECTION+2*i)*0.01;
+    }
+  }
 #endif
   // now the extruder
   for(byte i=0;i<NUM_EXTRUDER;i++) {
@@ -657,6 +679,17 @@ void epr_output_settings() {
   epr_out_float(EPR_BACKLASH_Y,PSTR("Y backlash [mm]"));
   epr_out_float(EPR_BACKLASH_Z,PSTR("Z backlash [mm]"));
 #endif
+#if DRIVE_SYSTEM==3
+  epr_out_int(EPR_DELTA_ROD_CORRECTION,PSTR("Tower 1 rod length correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_ROD_CORRECTION+2,PSTR("Tower 2 rod length correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_ROD_CORRECTION+4,PSTR("Tower 3 rod length correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_RADIUS_CORRECTION,PSTR("Tower 1 radius correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_RADIUS_CORRECTION+2,PSTR("Tower 2 radius correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_RADIUS_CORRECTION+4,PSTR("Tower 3 radius correction [0.01mm]"));
+  epr_out_int(EPR_DELTA_ANGLE_CORRECTION,PSTR("Tower 1 angle correction [0.01deg]"));
+  epr_out_int(EPR_DELTA_ANGLE_CORRECTION+2,PSTR("Tower 2 angle correction [0.01deg]"));
+  epr_out_int(EPR_DELTA_ANGLE_CORRECTION+4,PSTR("Tower 3 angle correction [0.01deg]"));
+#endif
 
 #ifdef RAMP_ACCELERATION
   //epr_out_float(EPR_X_MAX_START_SPEED,PSTR("X-axis start speed [mm/s]"));
@@ -690,7 +723,6 @@ void epr_output_settings() {
   // now the extruder
   for(byte i=0;i<NUM_EXTRUDER;i++) {
     int o=i*EEPROM_EXTRUDER_LENGTH+EEPROM_EXTRUDER_OFFSET;
-    Extruder *e = &extruder[i];
     epr_out_float(o+EPR_EXTRUDER_STEPS_PER_MM,PSTR("steps per mm"));
     epr_out_float(o+EPR_EXTRUDER_MAX_FEEDRATE,PSTR("max. feedrate [mm/s]"));
     epr_out_float(o+EPR_EXTRUDER_MAX_START_FEEDRATE,PSTR("start feedrate [mm/s]"));
@@ -723,4 +755,4 @@ void epr_output_settings() {
   out.println_P(PSTR("No EEPROM support compiled."));
 #endif
 }
-
+
@@ -22,7 +22,7 @@
 #include <avr/eeprom.h>
 
 // Id to distinguish version changes 
-#define EEPROM_PROTOCOL_VERSION 2
+#define EEPROM_PROTOCOL_VERSION 3
 
 /** Where to start with our datablock in memory. Can be moved if you
 have problems with other modules using the eeprom */
@@ -76,6 +76,10 @@ have problems with other modules using the eeprom */
 #define EPR_BACKLASH_X            157
 #define EPR_BACKLASH_Y            161
 #define EPR_BACKLASH_Z            165
+// Delta tower corrections, 3 ints each in 1/100 mm or degree, one per tower
+#define EPR_DELTA_ROD_CORRECTION    169
+#define EPR_DELTA_RADIUS_CORRECTION 175
+#define EPR_DELTA_ANGLE_CORRECTION  181
 
 #define EEPROM_EXTRUDER_OFFSET 200
 // bytes per extruder needed, leave some space for future development
@@ -113,17 +117,17 @@ extern void epr_eeprom_to_data();
 extern void epr_eeprom_reset();
 
 inline byte epr_get_byte(uint pos) {
-   return eeprom_read_byte ((unsigned char *)(EEPROM_OFFSET+pos));
+   return eeprom_read_byte ((unsigned char *)(size_t)(EEPROM_OFFSET+pos));
 }
 inline int epr_get_int(uint pos) {
-  return eeprom_read_word((unsigned int *)(EEPROM_OFFSET+pos));
+  return (int16_t)eeprom_read_word((unsigned int *)(size_t)(EEPROM_OFFSET+pos)); // sign of negative values where int is wider
 }
 inline long epr_get_long(uint pos) {
-  return eeprom_read_dword((unsigned long*)(EEPROM_OFFSET+pos));
+  return eeprom_read_dword((unsigned long*)(size_t)(EEPROM_OFFSET+pos));
 }
 inline float epr_get_float(uint pos) {
   float v;
-  eeprom_read_block(&v,(void *)(EEPROM_OFFSET+pos),4); // newer gcc have eeprom_read_block but not arduino 22
+  eeprom_read_block(&v,(void *)(size_t)(EEPROM_OFFSET+pos),4); // newer gcc have eeprom_read_block but not arduino 22
   return v;
 }
 #endif
@@ -354,6 +354,7 @@ void initExtruder() {
   	/* ADCW must be read once, otherwise the next result is wrong. */
   uint dummyADCResult;
   dummyADCResult = ADCW;
+  (void)dummyADCResult;
   // Enable interrupt driven conversion loop
   byte channel = pgm_read_byte(&osAnalogInputChannels[osAnalogInputPos]);
 #if defined(ADCSRB) && defined(MUX5)
@@ -396,6 +397,15 @@ void extruder_select(byte ext_num) {
    current_extruder->extrudePosition = printer_state.currentPositionSteps[3];
    long dx = current_extruder->xOffset;
    long dy = current_extruder->yOffset;
+#if SPLIT_STEP_PULSE
+   BEGIN_INTERRUPT_PROTECTED
+   if(step_pulse_pending & 2 || extruder_pulse_pending) { // End a pending pulse, while the old extruder is selected
+     extruder_unstep();
+     step_pulse_pending &= ~2;
+     extruder_pulse_pending = 0;
+   }
+   END_INTERRUPT_PROTECTED
+#endif
    current_extruder = &extruder[ext_num];
    dx -= current_extruder->xOffset;
    dy -= current_extruder->yOffset;
@@ -644,7 +654,7 @@ float conv_raw_temp(byte type,int raw_temp) {
       const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
       short oldraw = pgm_read_word(&temptable[0]);
       short oldtemp = pgm_read_word(&temptable[1]);
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       raw_temp = (1023<<(2-ANALOG_REDUCE_BITS))-raw_temp;
       while(i<num) {
         newraw = pgm_read_word(&temptable[i++]);
@@ -669,7 +679,7 @@ float conv_raw_temp(byte type,int raw_temp) {
       const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word_near(&temptables[type]);
       short oldraw = pgm_read_word(&temptable[0]);
       short oldtemp = pgm_read_word(&temptable[1]);
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       while(i<num) {
         newraw = pgm_read_word(&temptable[i++]);
         newtemp = pgm_read_word(&temptable[i++]);
@@ -710,7 +720,7 @@ float conv_raw_temp(byte type,int raw_temp) {
 #endif
       short oldraw = temptable[0];
       short oldtemp = temptable[1];
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       raw_temp = (1023<<(2-ANALOG_REDUCE_BITS))-raw_temp;
       //OUT_P_I("Raw ",raw_temp);
       while(i<GENERIC_THERM_NUM_ENTRIES*2) {
@@ -729,6 +739,7 @@ float conv_raw_temp(byte type,int raw_temp) {
     }
 #endif
   }
+  return 0; // Unknown sensor type
 }
 
 // ------------------------------------------------------------------------------------------------------------------
@@ -753,7 +764,7 @@ int conv_temp_raw(byte type,float tempf) {
       const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word(&temptables[type]);
       short oldraw = pgm_read_word(&temptable[0]);
       short oldtemp = pgm_read_word(&temptable[1]);
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       while(i<num) {
         newraw = pgm_read_word(&temptable[i++]);
         newtemp = pgm_read_word(&temptable[i++]);
@@ -775,7 +786,7 @@ int conv_temp_raw(byte type,float tempf) {
       const short *temptable = (const short *)pgm_read_word(&temptables[type]); //pgm_read_word(&temptables[type]);
       short oldraw = pgm_read_word(&temptable[0]);
       short oldtemp = pgm_read_word(&temptable[1]);
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       while(i<num) {
         newraw = pgm_read_word(&temptable[i++]);
         newtemp = pgm_read_word(&temptable[i++]);
@@ -815,7 +826,7 @@ int conv_temp_raw(byte type,float tempf) {
 #endif
       short oldraw = temptable[0];
       short oldtemp = temptable[1];
-      short newraw,newtemp;
+      short newraw = oldraw,newtemp = oldtemp;
       while(i<GENERIC_THERM_NUM_ENTRIES*2) {
         newraw = temptable[i++];
         newtemp = temptable[i++];
@@ -829,6 +840,7 @@ int conv_temp_raw(byte type,float tempf) {
     }
 #endif
   }
+  return 0; // Unknown sensor type
 }
 
 // ------------------------------------------------------------------------------------------------------------------
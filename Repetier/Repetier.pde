@@ -99,6 +99,13 @@ Custom M Codes
 - M251 Measure Z steps from homing stop (Delta printers). S0 - Reset, S1 - Print, S2 - Store to Z length (also EEPROM if enabled)
 - M303 P<extruder/bed> S<drucktermeratur> Autodetect pid values. Use P<NUM_EXTRUDER> for heated bed.
 - M350 S<mstepsAll> X<mstepsX> Y<mstepsY> Z<mstepsZ> E<mstepsE0> P<mstespE1> : Set microstepping on RAMBO board
+- M260 S<1=reset> - Report path planner statistics. Needs DEBUG_PLANNER_STATS.
+- M261 S<1=reset> - Report move buffer starvations, moves slowed down to keep the buffer filled and planner stalls.
+- M262 S<1=reset> - Report stepper interrupt cycles per phase and start lateness. Needs DEBUG_ISR_PROFILER.
+- M263 S<1=reset> - Report missed step deadlines, their lateness and the feedrate reduction. Needs STEP_TIMING_MONITOR.
+- M264 S<1=reset> - Report size, use, peak use and waits of the delta segment cache. Delta printer only.
+- M265 S<1=restart> - Write recorded step trace as lines of cycle and pin bits. Needs DEBUG_STEP_TRACE.
+- M266 P<tower 1-3> X<rod length> Y<radius> Z<angle> S<1=store> - Set per tower delta corrections in mm and degree. Home again after changes. Delta printer only.
 - M400 - Wait until move buffers empty.
 - M401 - Store x, y and z position.
 - M402 - Go to stored position. If X, Y or Z is specified, only these coordinates are used. F changes feedrate fo rthat move.
@@ -127,13 +134,34 @@ Custom M Codes
 #if STEP_DOUBLER_FREQUENCY<10000 || STEP_DOUBLER_FREQUENCY>20000
 #error STEP_DOUBLER_FREQUENCY should be in range 10000-16000.
 #endif
+#if MAX_STEPPER_LOOPS!=1 && MAX_STEPPER_LOOPS!=2 && MAX_STEPPER_LOOPS!=4 && MAX_STEPPER_LOOPS!=8
+#error MAX_STEPPER_LOOPS must be 1, 2, 4 or 8
+#endif
+#if MAX_STEPPER_LOOPS==8 && !STEPPER_LOOP_SPREAD
+#error MAX_STEPPER_LOOPS 8 needs STEPPER_LOOP_SPREAD 1
+#endif
 #endif
 #ifdef EXTRUDER_SPEED
 #error EXTRUDER_SPEED is not used any more. Values are now taken from extruder definition.
 #endif
-#if MAX_HALFSTEP_INTERVAL<=1900
+#if DRIVE_SYSTEM==3 && defined(DELTA_SEGMENT_RAM) && DELTA_SEGMENT_RAM>0 && DELTA_SEGMENT_RAM<7*MAX_DELTA_SEGMENTS_PER_LINE
+#error DELTA_SEGMENT_RAM must hold at least MAX_DELTA_SEGMENTS_PER_LINE segments of 7 byte
+#endif
+#if HALFSTEPPING && MAX_HALFSTEP_INTERVAL<=1900
 #error MAX_HALFSTEP_INTERVAL must be greater then 1900
 #endif
+#if defined(S_CURVE_ACCELERATION) && (S_CURVE_JERK_PERCENT<10 || S_CURVE_JERK_PERCENT>50)
+#error S_CURVE_JERK_PERCENT must be in range 10-50
+#endif
+#if STEP_OVERRUN_SLOWDOWN<0 || STEP_OVERRUN_SLOWDOWN>90
+#error STEP_OVERRUN_SLOWDOWN must be in range 0-90
+#endif
+#if RAMP_TABLE_SIZE>0 && defined(S_CURVE_ACCELERATION)
+#error RAMP_TABLE_SIZE can not be used with S_CURVE_ACCELERATION
+#endif
+#if PLANNER_CACHE_SIZE<4 || (MOVE_CACHE_SIZE % PLANNER_CACHE_SIZE)
+#error PLANNER_CACHE_SIZE must be at least 4 and a divisor of MOVE_CACHE_SIZE
+#endif
 #ifdef ENDSTOPPULLUPS
 #error ENDSTOPPULLUPS is now replaced by individual pullup configuration!
 #endif
@@ -208,6 +236,13 @@ byte STEP_PIN[3] = {X_STEP_PIN, Y_STEP_PIN, Z_STEP_PIN};
 DeltaSegment segments[DELTA_CACHE_SIZE];
 unsigned int delta_segment_write_pos = 0; // Position where we write the next cached delta move
 volatile unsigned int  delta_segment_count = 0; // Number of delta moves cached 0 = nothing in cache
+unsigned int delta_segment_peak = 0; // Largest delta_segment_count since the last report reset
+unsigned long delta_segment_waits = 0; // Lines that had to wait for free delta segments
+#if DELTA_JIT_SEGMENTS
+unsigned long delta_segment_stalls = 0; // Line starts delayed because the segments were not ready
+#endif
+#endif
+#ifdef USE_MOVE_ID
 byte lastMoveID = 0; // Last move ID
 #endif
 PrinterState printer_state;
@@ -220,9 +255,29 @@ unsigned long previous_millis_cmd = 0;
 unsigned long max_inactive_time = MAX_INACTIVE_TIME*1000L;
 unsigned long stepper_inactive_time = STEPPER_INACTIVE_TIME*1000L;
 PrintLine lines[MOVE_CACHE_SIZE]; ///< Cache for print moves.
+PlanLine plan_lines[PLANNER_CACHE_SIZE]; ///< Planner data of the cached moves.
 PrintLine *cur = 0;               ///< Current printing line
 byte lines_write_pos=0;           ///< Position where we write the next cached line move.
 volatile byte lines_count=0;      ///< Number of lines cached 0 = nothing to do.
+volatile long lines_ticks=0;      ///< Sum of timeInTicks of all cached lines.
+volatile byte lines_commit_pos=0; ///< First line the path planner may still change.
+volatile byte lines_commit_seq=0; ///< Number of committed lines, wraps at 256.
+volatile byte lines_done_seq=0;   ///< Number of finished lines, wraps at 256.
+volatile byte planner_busy=0;     ///< Set while the path planner changes uncommitted lines.
+volatile unsigned long planner_stalls=0; ///< Stepper interrupts without a committed line while the planner was busy.
+#if SPLIT_STEP_PULSE
+volatile byte step_pulse_pending=0;
+volatile byte extruder_pulse_pending=0;
+#endif
+#if STEPPER_LOOP_SPREAD
+byte stepper_loop_count=0; ///< Stepper interrupt calls since the last speed computation.
+byte stepper_loop_shift=0; ///< log2 of printer_state.stepper_loops
+#endif
+#if USE_OPS==1 || defined(USE_ADVANCE)
+byte extruder_wait_dirchange=0; ///< Wait cycles, if direction changes. Prevents stepper from loosing steps.
+char extruder_last_dir = 0;
+byte extruder_speed = 0;
+#endif
 byte lines_pos=0;                 ///< Position for executing line movement.
 long baudrate = BAUDRATE;         ///< Communication speed rate.
 #ifdef USE_ADVANCE
@@ -285,11 +340,9 @@ void update_extruder_flags() {
 void update_ramps_parameter() {
 #if DRIVE_SYSTEM==3
   printer_state.zMaxSteps = axis_steps_per_unit[0]*(printer_state.zLength - printer_state.zMin);
-  long cart[3], delta[3];
-  cart[0] = cart[1] = 0;
-  cart[2] = printer_state.zMaxSteps;
-  calculate_delta(cart, delta);
-  printer_state.maxDeltaPositionSteps = delta[0];
+  delta_update_geometry();
+  long height = delta_endstop_height();
+  for(byte i=0;i<3;i++) printer_state.maxDeltaPositionSteps[i] = height;
   printer_state.xMaxSteps = (long)(axis_steps_per_unit[0]*(printer_state.xMin+printer_state.xLength));
   printer_state.yMaxSteps = (long)(axis_steps_per_unit[1]*(printer_state.yMin+printer_state.yLength));
   printer_state.xMinSteps = (long)(axis_steps_per_unit[0]*printer_state.xMin);
@@ -436,6 +489,9 @@ SET_OUTPUT(ANALYZER_CH7);
   WRITE(Z_MAX_PIN,HIGH);
 #endif
 #endif
+#if ENDSTOP_INTERRUPTS
+  endstop_interrupt_init();
+#endif
 #if FAN_PIN>-1
   SET_OUTPUT(FAN_PIN);
   WRITE(FAN_PIN,LOW);
@@ -500,6 +556,8 @@ SET_OUTPUT(ANALYZER_CH7);
   for(byte i=0;i<NUM_EXTRUDER+3;i++) pwm_pos[i]=0;
   printer_state.currentPositionSteps[0] = printer_state.currentPositionSteps[1] = printer_state.currentPositionSteps[2] = printer_state.currentPositionSteps[3] = 0;
 #if DRIVE_SYSTEM==3
+  delta_reset_corrections();
+  delta_update_geometry();
   calculate_delta(printer_state.currentPositionSteps, printer_state.currentDeltaPositionSteps);
 #endif
   printer_state.maxJerk = MAX_JERK;
@@ -586,7 +644,18 @@ void defaultLoopActions() {
 void loop()
 {
   gcode_read_serial();
-  GCode *code = gcode_next_command();
+  GCode *code = NULL;
+#if DRIVE_SYSTEM==3
+  if(delta_split_pending) // Queue lines of a split delta move as space gets free
+    delta_split_continue(false);
+  else
+#endif
+#if ARC_SUPPORT
+  if(arc_pending) // Queue arc segments as space gets free, next command waits until the arc is finished
+    mc_arc_continue(false);
+  else
+#endif
+  code = gcode_next_command();
   //UI_SLOW; // do longer timed user interface action
   UI_MEDIUM; // do check encoder
   if(code){
@@ -612,6 +681,9 @@ void loop()
     process_command(code,true);
 #endif
   }
+#if MOVE_COALESCING
+  else coalesce_flush(); // Nothing to merge with, queue held back move
+#endif
   defaultLoopActions();
 }
 
@@ -711,7 +783,8 @@ inline long Div4U2U(unsigned long a,unsigned int b) {
 const uint16_t fast_div_lut[17] PROGMEM = {0,F_CPU/4096,F_CPU/8192,F_CPU/12288,F_CPU/16384,F_CPU/20480,F_CPU/24576,F_CPU/28672,F_CPU/32768,F_CPU/36864
   ,F_CPU/40960,F_CPU/45056,F_CPU/49152,F_CPU/53248,F_CPU/57344,F_CPU/61440,F_CPU/65536};
 
-const uint16_t slow_div_lut[257] PROGMEM = {0,F_CPU/32,F_CPU/64,F_CPU/96,F_CPU/128,F_CPU/160,F_CPU/192,F_CPU/224,F_CPU/256,F_CPU/288,F_CPU/320,F_CPU/352
+// The first entries overflow, they are never read: CPUDivU2 divides directly below 512.
+const uint16_t slow_div_lut[257] PROGMEM = {0,(uint16_t)(F_CPU/32),(uint16_t)(F_CPU/64),(uint16_t)(F_CPU/96),(uint16_t)(F_CPU/128),(uint16_t)(F_CPU/160),(uint16_t)(F_CPU/192),(uint16_t)(F_CPU/224),(uint16_t)(F_CPU/256),(uint16_t)(F_CPU/288),(uint16_t)(F_CPU/320),(uint16_t)(F_CPU/352)
  ,F_CPU/384,F_CPU/416,F_CPU/448,F_CPU/480,F_CPU/512,F_CPU/544,F_CPU/576,F_CPU/608,F_CPU/640,F_CPU/672,F_CPU/704,F_CPU/736,F_CPU/768,F_CPU/800,F_CPU/832
  ,F_CPU/864,F_CPU/896,F_CPU/928,F_CPU/960,F_CPU/992,F_CPU/1024,F_CPU/1056,F_CPU/1088,F_CPU/1120,F_CPU/1152,F_CPU/1184,F_CPU/1216,F_CPU/1248,F_CPU/1280,F_CPU/1312
  ,F_CPU/1344,F_CPU/1376,F_CPU/1408,F_CPU/1440,F_CPU/1472,F_CPU/1504,F_CPU/1536,F_CPU/1568,F_CPU/1600,F_CPU/1632,F_CPU/1664,F_CPU/1696,F_CPU/1728,F_CPU/1760,F_CPU/1792
@@ -842,10 +915,10 @@ long CPUDivU2(unsigned int divisor) {
     unsigned short y0=	pgm_read_word_near(adr0);
     unsigned short gain = y0-pgm_read_word_near(adr0+2);
     return y0-(((long)gain*(divisor & 4095))>>12);*/
+  }
 #else
   return F_CPU/divisor;
 #endif
-  }
 }
 
 /**
@@ -858,8 +931,8 @@ long CPUDivU2(unsigned int divisor) {
 */
 byte get_coordinates(GCode *com)
 {
-  register long p;
-  register byte r=0;
+  long p;
+  byte r=0;
   if(lines_count==0) {
     UI_STATUS(UI_TEXT_PRINTING);
   }
@@ -965,6 +1038,7 @@ inline unsigned int ComputeV(long timer,long accel) {
 }
 // Multiply two 16 bit values and return 32 bit result
 inline unsigned long mulu6xu16to32(unsigned int a,unsigned int b) {
+#if CPU_ARCH==ARCH_AVR
   unsigned long res;
   // 18 Ticks = 1.125 us
   __asm__ __volatile__ ( // 0 = res, 1 = timer, 2 = accel %D2=0 ,%A1 are unused is free  
@@ -986,8 +1060,10 @@ inline unsigned long mulu6xu16to32(unsigned int a,unsigned int b) {
   :"=&r"(res),"=r"(a),"=r"(b)
   :"1"(a),"2"(b)
   :"r18" );
-  // return (long)a*b;
   return res;
+#else
+  return (unsigned long)a*b;
+#endif
 }
 // Multiply two 16 bit values and return 32 bit result
 inline unsigned int mulu6xu16shift16(unsigned int a,unsigned int b) {
@@ -1018,6 +1094,407 @@ inline unsigned int mulu6xu16shift16(unsigned int a,unsigned int b) {
   return ((long)a*b)>>16;
 #endif
 }
+#ifdef S_CURVE_ACCELERATION
+#define S_CURVE_F16 ((unsigned long)S_CURVE_JERK_PERCENT*65536/100)
+#define S_CURVE_K12 (20480000L/(S_CURVE_JERK_PERCENT*(100-S_CURVE_JERK_PERCENT)))
+#define S_CURVE_A12 (409600L/(100-S_CURVE_JERK_PERCENT))
+/** First half of the normalized S-curve. t and result are fractions of the ramp *65536. */
+inline unsigned long sCurveHalf(unsigned long t) {
+  if(t<S_CURVE_F16) // acceleration rising
+    return (((t*t)>>16)*S_CURVE_K12)>>12;
+  return (S_CURVE_A12*(t-(S_CURVE_F16>>1)))>>12; // constant acceleration
+}
+/** \brief Speed change after timer ticks in a S-curve ramp.
+
+ComputeV gives the speed change of the linear ramp with the same duration. Scaled with rampInv
+it is the elapsed fraction of the ramp, which is mapped to the S-curve. The curve is point symmetric,
+so the distance travelled in the ramp is the same as for the linear ramp.
+*/
+inline unsigned int ComputeSCurveV(long timer,long accel,unsigned int dv,unsigned long rampInv) {
+  unsigned long t = ((unsigned long)ComputeV(timer,accel)*rampInv)>>8;
+  if(t>=65536) return dv;
+  if(t>32768)
+    t = 65536-sCurveHalf(65536-t);
+  else
+    t = sCurveHalf(t);
+  return ((unsigned long)dv*t)>>16;
+}
+#endif
+
+/** Commits the line at lines_pos, so the stepper interrupt can take it.
+
+Only called from the stepper interrupt, while the path planner is not running. Otherwise the
+planner commits the lines itself, before it changes the uncommitted ones.
+*/
+inline void commit_line() {
+  lines_commit_pos = lines_pos;
+  NEXT_PLANNER_INDEX(lines_commit_pos);
+  lines_commit_seq++;
+}
+long stepperWait = 0;
+#if STEP_TIMING_MONITOR
+unsigned long step_deadline_misses = 0; ///< Timer deadlines that had passed when setTimer was called
+unsigned long step_late_lines = 0;      ///< Finished lines with at least one missed deadline
+unsigned int step_max_lateness = 0;     ///< Largest lateness in cycles since the last reset
+unsigned int step_line_lateness = 0;    ///< Largest lateness in cycles of the current line
+unsigned int step_line_misses = 0;      ///< Missed deadlines of the current line
+unsigned int step_last_lateness = 0;    ///< Largest lateness of the last line with missed deadlines
+volatile byte step_overrun_slowdown = 0; ///< Feedrate reduction for new moves in percent
+byte step_clean_lines = 0;              ///< Lines without misses since the last slowdown change
+/** \brief Adds the deadline misses of the finished line to the totals.
+
+Called from the stepper interrupt when a line is finished.
+*/
+inline void step_timing_line_end() {
+  if(step_line_misses) {
+    step_deadline_misses += step_line_misses;
+    step_late_lines++;
+    step_last_lateness = step_line_lateness;
+    if(step_line_lateness>step_max_lateness) step_max_lateness = step_line_lateness;
+#if STEP_OVERRUN_SLOWDOWN>0
+    step_overrun_slowdown = (step_overrun_slowdown+5>STEP_OVERRUN_SLOWDOWN ? STEP_OVERRUN_SLOWDOWN : step_overrun_slowdown+5);
+    step_clean_lines = 0;
+  } else if(step_overrun_slowdown && ++step_clean_lines>=16) {
+    step_overrun_slowdown--;
+    step_clean_lines = 0;
+#endif
+  }
+  step_line_misses = 0;
+  step_line_lateness = 0;
+}
+/** Writes the missed step deadline counters and resets them if requested. */
+void step_timing_report(byte reset) {
+  unsigned long misses,lines;
+  unsigned int maxLate,lastLate;
+  BEGIN_INTERRUPT_PROTECTED
+  misses = step_deadline_misses;
+  lines = step_late_lines;
+  maxLate = step_max_lateness;
+  lastLate = step_last_lateness;
+  if(reset) {
+    step_deadline_misses = step_late_lines = 0;
+    step_max_lateness = step_last_lateness = 0;
+  }
+  END_INTERRUPT_PROTECTED
+  OUT_P_L_LN("Missed step deadlines:",misses);
+  OUT_P_L_LN("Lines with misses:",lines);
+  OUT_P_I_LN("Max lateness [cycles]:",maxLate);
+  OUT_P_I_LN("Last line lateness [cycles]:",lastLate);
+  OUT_P_I_LN("Feedrate reduction [%]:",step_overrun_slowdown);
+}
+#define STEP_TIMING_LINE_END step_timing_line_end()
+#else
+#define STEP_TIMING_LINE_END
+#endif
+#if SPLIT_STEP_PULSE
+/** Sets the step pins of the last step of the previous stepper interrupt to low. */
+inline void end_step_pulse() {
+#if STEPPER_PORT_BATCHING
+#if STEP_BATCH_E
+  step_ports_low(step_pulse_pending & 2 ? STEP_MASK(EXT0_STEP_PIN) : 0);
+#else
+  step_ports_low(0);
+  if(step_pulse_pending & 2) extruder_unstep();
+#endif
+#else
+  WRITE(X_STEP_PIN,LOW);
+  WRITE(Y_STEP_PIN,LOW);
+  WRITE(Z_STEP_PIN,LOW);
+  if(step_pulse_pending & 2) extruder_unstep();
+#endif
+  step_pulse_pending = 0;
+}
+#endif
+#if UNIFIED_EXTRUDER_STEPPING
+long extruder_step_budget = 0; ///< Stepper timer ticks not yet used for advance/OPS extruder steps
+/** Decides, if the stepper loop makes an advance/OPS extruder step now. Steps are spaced at least
+maxExtruderSpeed timer 0 ticks apart, like in the extruder interrupt, and the direction only changes
+after the needed steps went back to nearly 0. */
+inline byte extruder_scheduled_step_due() {
+  long minTicks = (long)printer_state.maxExtruderSpeed*TIMER0_PRESCALE;
+  if(extruder_step_budget<minTicks) return 0;
+  int needed = printer_state.extruderStepsNeeded;
+  if(needed<2 && needed>-2) { // Require at least 2 steps in one direction before going to action
+    extruder_last_dir = 0;
+    return 0;
+  }
+  if(extruder_last_dir==0) {
+    extruder_set_direction(needed>0 ? 1 : 0);
+    extruder_last_dir = (needed>0 ? 1 : -1);
+  }
+  printer_state.extruderStepsNeeded-=extruder_last_dir;
+  extruder_step_budget-=minTicks;
+  return 1;
+}
+/** Adds the time until the next stepper interrupt to the extruder step budget. */
+inline void extruder_schedule_time(long interval) {
+  long maxBudget = (long)printer_state.maxExtruderSpeed*(TIMER0_PRESCALE*MAX_STEPPER_LOOPS);
+  extruder_step_budget+=interval;
+  if(extruder_step_budget>maxBudget) extruder_step_budget = maxBudget; // no bursts after slow moves
+}
+#endif
+#if RAMP_TABLE_SIZE>0
+/** Sets interval and stepper_loops from the single step interval of a ramp table entry. */
+inline void setRampInterval(unsigned int stepInterval) {
+  byte shift = 0;
+  long interval = stepInterval;
+  while(interval<F_CPU/STEP_DOUBLER_FREQUENCY && (1<<shift)<MAX_STEPPER_LOOPS) {
+    interval<<=1;
+    shift++;
+  }
+  printer_state.stepper_loops = 1<<shift;
+  printer_state.interval = interval;
+#if STEPPER_LOOP_SPREAD
+  stepper_loop_shift = shift;
+#endif
+}
+#endif
+/** Sets stepper_loops to the smallest power of 2, that keeps the interrupt rate for v steps/s
+below STEP_DOUBLER_FREQUENCY. Returns the shift to convert v and intervals between steps and calls.
+*/
+inline byte set_stepper_loops(unsigned int v) {
+  byte shift = 0;
+  while(v>STEP_DOUBLER_FREQUENCY && (1<<shift)<MAX_STEPPER_LOOPS) {
+    v>>=1;
+    shift++;
+  }
+  printer_state.stepper_loops = 1<<shift;
+#if STEPPER_LOOP_SPREAD
+  stepper_loop_shift = shift;
+#endif
+  return shift;
+}
+
+#if ENDSTOP_INTERRUPTS
+#ifndef digitalPinToPCICR
+#error ENDSTOP_INTERRUPTS needs an Arduino version with pin change interrupt macros (1.0 or newer)
+#endif
+volatile byte endstop_latch = 0;
+byte endstop_polling = 0;   ///< ENDSTOP_*_BIT of endstops without pin change interrupt, they are read every step
+byte endstop_mask = 0;      ///< ENDSTOP_*_BIT of the endstops the current move can run into
+#if ENDSTOP_DEBOUNCE>1
+byte endstop_debounce[6];   ///< Consecutive checks each endstop was triggered, index is the bit number
+#endif
+/** Returns the ENDSTOP_*_BIT of all triggered hardware endstops. */
+inline byte endstop_read() {
+  byte hits = 0;
+#if X_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_X
+  if(READ(X_MIN_PIN) != ENDSTOP_X_MIN_INVERTING) hits |= ENDSTOP_X_MIN_BIT;
+#endif
+#if Y_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Y
+  if(READ(Y_MIN_PIN) != ENDSTOP_Y_MIN_INVERTING) hits |= ENDSTOP_Y_MIN_BIT;
+#endif
+#if Z_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Z
+  if(READ(Z_MIN_PIN) != ENDSTOP_Z_MIN_INVERTING) hits |= ENDSTOP_Z_MIN_BIT;
+#endif
+#if X_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_X
+  if(READ(X_MAX_PIN) != ENDSTOP_X_MAX_INVERTING) hits |= ENDSTOP_X_MAX_BIT;
+#endif
+#if Y_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Y
+  if(READ(Y_MAX_PIN) != ENDSTOP_Y_MAX_INVERTING) hits |= ENDSTOP_Y_MAX_BIT;
+#endif
+#if Z_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Z
+  if(READ(Z_MAX_PIN) != ENDSTOP_Z_MAX_INVERTING) hits |= ENDSTOP_Z_MAX_BIT;
+#endif
+  return hits;
+}
+/** Returns the triggered endstops of endstop_mask for the stepper interrupt. Pins are only read, if the
+pin change interrupt has seen a trigger, so the common case costs one test. Each endstop must be triggered
+in ENDSTOP_DEBOUNCE following checks. */
+inline byte endstop_check() {
+  if(endstop_latch==0 && (endstop_polling & endstop_mask)==0) return 0;
+  byte hits = endstop_read() & endstop_mask;
+  endstop_latch = hits; // forget released endstops and noise
+#if ENDSTOP_DEBOUNCE>1
+  byte stable = 0;
+  for(byte i=0;i<6;i++) {
+    if(hits & (1<<i)) {
+      if(endstop_debounce[i]<ENDSTOP_DEBOUNCE) endstop_debounce[i]++;
+      if(endstop_debounce[i]>=ENDSTOP_DEBOUNCE) stable |= 1<<i;
+    } else endstop_debounce[i] = 0;
+  }
+  return stable;
+#else
+  return hits;
+#endif
+}
+/** Sets the endstops the current move can run into. The others are neither latched nor read, so an
+endstop held by a move going away from it costs nothing. Endstops triggered before caused no pin change,
+so the pins are read once. The debouncing starts again, counts of earlier moves are outdated. */
+inline void endstop_set_mask(byte mask) {
+  if(mask==endstop_mask) return;
+  BEGIN_INTERRUPT_PROTECTED
+  endstop_mask = mask;
+  endstop_latch = endstop_read() & mask;
+#if ENDSTOP_DEBOUNCE>1
+  for(byte i=0;i<6;i++) endstop_debounce[i] = 0;
+#endif
+  END_INTERRUPT_PROTECTED
+}
+#if DRIVE_SYSTEM==3
+/** Max endstops of the towers going up in delta segment dir. */
+inline byte endstop_segment_mask(byte dir,byte check) {
+  if(!check) return 0;
+  byte mask = 0;
+  if((dir & 17)==17) mask |= ENDSTOP_X_MAX_BIT;
+  if((dir & 34)==34) mask |= ENDSTOP_Y_MAX_BIT;
+  if((dir & 68)==68) mask |= ENDSTOP_Z_MAX_BIT;
+  return mask;
+}
+#else
+/** Endstops in the direction of a line, z is always checked. */
+inline byte endstop_line_mask(byte dir,byte check) {
+  byte mask = 0;
+  if(check) {
+    if(dir & 16) mask |= (dir & 1 ? ENDSTOP_X_MAX_BIT : ENDSTOP_X_MIN_BIT);
+    if(dir & 32) mask |= (dir & 2 ? ENDSTOP_Y_MAX_BIT : ENDSTOP_Y_MIN_BIT);
+  }
+  if(dir & 64) mask |= (dir & 4 ? ENDSTOP_Z_MAX_BIT : ENDSTOP_Z_MIN_BIT);
+  return mask;
+}
+#endif
+/** Enables the pin change interrupt for an endstop pin or marks the endstop for polling. */
+void endstop_enable_pcint(byte pin,byte bit) {
+  if(digitalPinToPCICR(pin)==0) {
+    endstop_polling |= bit;
+    return;
+  }
+  *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+  *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+}
+void endstop_interrupt_init() {
+#if X_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_X
+  endstop_enable_pcint(X_MIN_PIN,ENDSTOP_X_MIN_BIT);
+#endif
+#if Y_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Y
+  endstop_enable_pcint(Y_MIN_PIN,ENDSTOP_Y_MIN_BIT);
+#endif
+#if Z_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Z
+  endstop_enable_pcint(Z_MIN_PIN,ENDSTOP_Z_MIN_BIT);
+#endif
+#if X_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_X
+  endstop_enable_pcint(X_MAX_PIN,ENDSTOP_X_MAX_BIT);
+#endif
+#if Y_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Y
+  endstop_enable_pcint(Y_MAX_PIN,ENDSTOP_Y_MAX_BIT);
+#endif
+#if Z_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Z
+  endstop_enable_pcint(Z_MAX_PIN,ENDSTOP_Z_MAX_BIT);
+#endif
+  if(endstop_polling) OUT_P_LN("Endstops without pin change interrupt are polled");
+}
+#endif
+
+#ifdef DEBUG_STEP_TRACE
+StepTraceEntry step_trace[STEP_TRACE_SIZE];
+unsigned int step_trace_count = 0;  ///< Recorded entries, recording stops when the buffer is full
+unsigned long step_trace_clock = 0; ///< Cycles at the last timer 1 compare match
+/** Records the step and direction pins after the step pins of a stepper loop were set. */
+inline void step_trace_record() {
+  if(step_trace_count>=STEP_TRACE_SIZE) return;
+  StepTraceEntry *e = &step_trace[step_trace_count++];
+  e->tick = step_trace_clock+TCNT1;
+  byte pins = 0;
+  if(READ(X_STEP_PIN)) pins |= 1;
+  if(READ(Y_STEP_PIN)) pins |= 2;
+  if(READ(Z_STEP_PIN)) pins |= 4;
+  if(READ(EXT0_STEP_PIN)) pins |= 8;
+  if(READ(X_DIR_PIN)) pins |= 16;
+  if(READ(Y_DIR_PIN)) pins |= 32;
+  if(READ(Z_DIR_PIN)) pins |= 64;
+  if(READ(EXT0_DIR_PIN)) pins |= 128;
+  e->pins = pins;
+}
+/** Writes the recorded trace. With reset, a new trace starts afterwards. */
+void step_trace_report(byte reset) {
+  unsigned int n;
+  BEGIN_INTERRUPT_PROTECTED
+  n = step_trace_count;
+  END_INTERRUPT_PROTECTED
+  OUT_P_I_LN("Step trace entries:",n);
+  for(unsigned int i=0;i<n;i++) {
+    out.print(step_trace[i].tick);
+    out.print(' ');
+    out.println((int)step_trace[i].pins);
+  }
+  if(reset) {
+    BEGIN_INTERRUPT_PROTECTED
+    step_trace_count = 0;
+    step_trace_clock = 0;
+    END_INTERRUPT_PROTECTED
+  }
+}
+#define STEP_TRACE_RECORD step_trace_record()
+#else
+#define STEP_TRACE_RECORD
+#endif
+
+#ifdef DEBUG_ISR_PROFILER
+IsrProfile isr_profile;
+unsigned int isr_profile_mark; ///< TCNT1 at the end of the last measured phase
+/** Adds the cycles since the last mark to phase. Timer 1 runs with F_CPU and the interrupt sets
+OCR1A far ahead on entry, so TCNT1 differences are CPU cycles. Interrupts nested after sei() are
+included in the measured phase. */
+void isr_profile_phase(byte phase) {
+  unsigned int t = TCNT1;
+  unsigned int cycles = t-isr_profile_mark;
+  if(isr_profile.count[phase]==0 || cycles<isr_profile.minCycles[phase]) isr_profile.minCycles[phase] = cycles;
+  if(cycles>isr_profile.maxCycles[phase]) isr_profile.maxCycles[phase] = cycles;
+  isr_profile.sum[phase] += cycles;
+  isr_profile.count[phase]++;
+  if(isr_profile.sum[phase] & 0x80000000) { // keep the mean, but prevent overflow
+    isr_profile.count[phase]>>=1;
+    isr_profile.sum[phase]>>=1;
+  }
+  isr_profile_mark = TCNT1; // don't count the profiler itself
+}
+/** Starts a new profiled interrupt. TCNT1 restarts at 0 on compare match, so it contains the
+cycles the interrupt started late. */
+inline void isr_profile_start() {
+  unsigned int t = TCNT1;
+  isr_profile_mark = t;
+  byte b = 0;
+  unsigned int limit = 64;
+  while(b<ISR_LATENESS_BUCKETS-1 && t>=limit) {
+    b++;
+    limit<<=1;
+  }
+  isr_profile.lateness[b]++;
+}
+void isr_profile_phase_report(PGM_P name,IsrProfile &p,byte phase) {
+  out.print_P(name);
+  out.print_long_P(PSTR(" n:"),p.count[phase]);
+  if(p.count[phase]) {
+    out.print_long_P(PSTR(" min:"),p.minCycles[phase]);
+    out.print_long_P(PSTR(" avg:"),p.sum[phase]/p.count[phase]);
+    out.print_long_P(PSTR(" max:"),p.maxCycles[phase]);
+  }
+  out.println();
+}
+/** Writes the stepper interrupt profile in CPU cycles and resets it if requested. */
+void isr_profile_report(byte reset) {
+  IsrProfile p;
+  BEGIN_INTERRUPT_PROTECTED
+  memcpy(&p,&isr_profile,sizeof(IsrProfile));
+  if(reset) memset(&isr_profile,0,sizeof(IsrProfile));
+  END_INTERRUPT_PROTECTED
+  OUT_P_LN("Stepper interrupt [cycles]:");
+  isr_profile_phase_report(PSTR("New line"),p,ISR_PHASE_NEW_LINE);
+  isr_profile_phase_report(PSTR("Endstops"),p,ISR_PHASE_ENDSTOPS);
+  isr_profile_phase_report(PSTR("Bresenham"),p,ISR_PHASE_BRESENHAM);
+  isr_profile_phase_report(PSTR("Speed update"),p,ISR_PHASE_SPEED);
+  isr_profile_phase_report(PSTR("Line end"),p,ISR_PHASE_LINE_END);
+  OUT_P("Lateness <64<<i:");
+  for(byte i=0;i<ISR_LATENESS_BUCKETS;i++) {
+    out.print(' ');
+    out.print(p.lateness[i]);
+  }
+  out.println();
+}
+#define ISR_PROFILE_START isr_profile_start()
+#else
+#define ISR_PROFILE_START
+#endif
 
 /**
   Moves the stepper motors one step. If the last step is reached, the next movement is started.
@@ -1026,7 +1503,6 @@ inline unsigned int mulu6xu16shift16(unsigned int a,unsigned int b) {
   cartesian axis steps may be less than the changing dominant delta axis.
 */
 #if DRIVE_SYSTEM==3
-int lastblk=-1;
 long cur_errupd;
 //#define DEBUG_DELTA_TIMER
 // Current delta segment
@@ -1036,20 +1512,20 @@ long curd_errupd, stepsPerSegRemaining;
 inline long bresenham_step() {
 	if(cur == 0) {
 		sei();
-		cur = &lines[lines_pos];
-		if(cur->flags & FLAG_BLOCKED) { // This step is in computation - shouldn't happen
-			if(lastblk!=(int)cur) {
-				lastblk = (int)cur;
-				//out.println_int_P(PSTR("BLK "),(unsigned int)lines_count);
+		if(lines_commit_seq==lines_done_seq) { // Line not committed by the path planner
+			if(planner_busy) { // Planner is updating it, try again soon
+				planner_stalls++;
+				return 500;
 			}
-			cur = 0;
-			return 2000;
+			commit_line();
 		}
-		lastblk = -1;
+		cur = &lines[lines_pos];
 	#ifdef INCLUDE_DEBUG_NO_MOVE
 		if(DEBUG_NO_MOVES) { // simulate a move, but do nothing in reality
 			lines_pos++;
 			if(lines_pos>=MOVE_CACHE_SIZE) lines_pos=0;
+			lines_ticks -= cur->timeInTicks;
+			lines_done_seq++;
 			cur = 0;
 			cli();
 			--lines_count;
@@ -1070,7 +1546,7 @@ inline long bresenham_step() {
 					printer_state.filamentRetracted = false;
 					printer_state.extruderStepsNeeded+=printer_state.opsPushbackSteps;
 				}
-				if(printer_state.extruderStepsNeeded) {
+				if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
 					cur = 0;
 					return 2000; // wait, work is done in other interrupt
 				}
@@ -1086,7 +1562,7 @@ inline long bresenham_step() {
 					printer_state.extruderStepsNeeded-=printer_state.opsRetractSteps;
 					cur->joinFlags |= FLAG_JOIN_WAIT_EXTRUDER_UP;
 				}
-				if(printer_state.extruderStepsNeeded) {
+				if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
 					cur = 0;
 					return 2000; // wait, work is done in other interrupt
 				}
@@ -1096,10 +1572,19 @@ inline long bresenham_step() {
 			lines_pos++;
 			if(lines_pos>=MOVE_CACHE_SIZE) lines_pos=0;
 			long wait = cur->accelerationPrim;
+			lines_ticks -= cur->timeInTicks;
+			lines_done_seq++;
 			cur = 0;
 			--lines_count;
 			return(wait); // waste some time for path optimization to fill up
 		} // End if WARMUP
+	#if DELTA_JIT_SEGMENTS
+		if(cur->numDeltaSegments && !cur->deltaSegmentsReady) { // Segment generator is behind
+			delta_segment_stalls++;
+			cur = 0;
+			return 2000;
+		}
+	#endif
 		if(cur->dir & 128) extruder_enable();
 		cur->joinFlags |= FLAG_JOIN_END_FIXED | FLAG_JOIN_START_FIXED; // don't touch this segment any more, just for safety
 	#if USE_OPS==1
@@ -1140,13 +1625,13 @@ inline long bresenham_step() {
 			}
 			if(cur->joinFlags & FLAG_JOIN_WAIT_EXTRUDER_UP) { // Wait for filament pushback
 				cli();
-				if(printer_state.extruderStepsNeeded<printer_state.opsMoveAfterSteps) {
+				if(printer_state.extruderStepsNeeded<printer_state.opsMoveAfterSteps-1) { // the extruder leaves up to 1 step
 					cur=0;
 					return 4000;
 				}
 			} else if(cur->joinFlags & FLAG_JOIN_WAIT_EXTRUDER_DOWN) { // Wait for filament pushback
 				cli();
-				if(printer_state.extruderStepsNeeded) {
+				if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
 					cur=0;
 					return 4000;
 				}
@@ -1166,8 +1651,11 @@ inline long bresenham_step() {
 
 			// Copy across movement into main direction flags so that endstops function correctly
 			cur->dir |= curd->dir;
+	#if ENDSTOP_INTERRUPTS
+			endstop_set_mask(endstop_segment_mask(curd->dir,cur->flags & FLAG_CHECK_ENDSTOPS));
+	#endif
 			// Initialize bresenham for the first segment
-			if (cur->halfstep) {
+			if (LINE_HALFSTEP(cur)) {
 				cur->error[0] = cur->error[1] = cur->error[2] = cur->numPrimaryStepPerSegment;
 				curd_errupd = cur->numPrimaryStepPerSegment = cur->numPrimaryStepPerSegment<<1;
 			} else {
@@ -1180,15 +1668,18 @@ inline long bresenham_step() {
 			out.println_long_P(PSTR("Error: "),curd_errupd);
 	#endif
 		} else curd=0;
-		cur_errupd = (cur->halfstep ? cur->stepsRemaining << 1 : cur->stepsRemaining);
+		cur_errupd = (LINE_HALFSTEP(cur) ? cur->stepsRemaining << 1 : cur->stepsRemaining);
 
 		if(!(cur->joinFlags & FLAG_JOIN_STEPPARAMS_COMPUTED)) {// should never happen, but with bad timings???
 			out.println_int_P(PSTR("LATE "),(unsigned int)lines_count);
-			updateStepsParameter(cur/*,8*/);
+			updateStepsParameter(cur,PLAN_LINE(lines_pos)/*,8*/);
 		}
 		printer_state.vMaxReached = cur->vStart;
 		printer_state.stepNumber=0;
 		printer_state.timer = 0;
+#if STEPPER_LOOP_SPREAD
+		stepper_loop_count = 0;
+#endif
 		cli();
 		//Determine direction of movement
 		if (curd) {
@@ -1211,11 +1702,7 @@ inline long bresenham_step() {
 	#if USE_OPS==1 || defined(USE_ADVANCE)
       if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) // Set direction if no advance/OPS enabled
 	#endif
-		if(cur->dir & 8) {
-			extruder_set_direction(1);
-		} else {
-			extruder_set_direction(0);
-		}
+		extruder_set_direction(cur->dir & 8 ? 1 : 0);
 	#ifdef USE_ADVANCE
 		long h = mulu6xu16to32(cur->vStart,cur->advanceL);
 		int tred = ((
@@ -1226,10 +1713,11 @@ inline long bresenham_step() {
 		printer_state.extruderStepsNeeded+=tred-printer_state.advance_steps_set;
 		printer_state.advance_steps_set = tred;
 	#endif
-    if(printer_state.waslasthalfstepping && cur->halfstep==0) { // Switch halfstepping -> full stepping
+    ISR_PROFILE_PHASE(ISR_PHASE_NEW_LINE);
+    if(printer_state.waslasthalfstepping && LINE_HALFSTEP(cur)==0) { // Switch halfstepping -> full stepping
       printer_state.waslasthalfstepping = 0;
       return printer_state.interval*3; // Wait an other 150% from last half step to make the 100% full
-    } else if(!printer_state.waslasthalfstepping && cur->halfstep) { // Switch full to half stepping
+    } else if(!printer_state.waslasthalfstepping && LINE_HALFSTEP(cur)) { // Switch full to half stepping
       printer_state.waslasthalfstepping = 1;
     } else 
       return printer_state.interval; // Wait an other 50% from last step to make the 100% full
@@ -1238,6 +1726,7 @@ inline long bresenham_step() {
 
   /* For halfstepping, we divide the actions into even and odd actions to split
      time used per loop. */
+#if HALFSTEPPING
 	byte do_even;
 	byte do_odd;
 	if(cur->halfstep) {
@@ -1248,32 +1737,51 @@ inline long bresenham_step() {
 		do_even = 1;
 		do_odd = 1;
 	}
+#else
+	const byte do_even = 1; // Every call steps and updates the speed
+	const byte do_odd = 1;
+#endif
 	cli();
 	if(do_even) {
+	#if ENDSTOP_INTERRUPTS
+		byte endstop_hits = endstop_check();
+		if(endstop_hits)
+	#endif
 		if((cur->flags & FLAG_CHECK_ENDSTOPS) && (curd != 0)) {
 	#if X_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_X
-			if((curd->dir & 17)==17) if(READ(X_MAX_PIN) != ENDSTOP_X_MAX_INVERTING) {
+			if((curd->dir & 17)==17) if(ENDSTOP_HIT(ENDSTOP_X_MAX_BIT,X_MAX_PIN,ENDSTOP_X_MAX_INVERTING)) {
 				curd->dir&=~16;
 				cur->dir&=~16;
 			}
 	#endif
 	#if Y_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Y
-			if((curd->dir & 34)==34) if(READ(Y_MAX_PIN) != ENDSTOP_Y_MAX_INVERTING) {
+			if((curd->dir & 34)==34) if(ENDSTOP_HIT(ENDSTOP_Y_MAX_BIT,Y_MAX_PIN,ENDSTOP_Y_MAX_INVERTING)) {
 				curd->dir&=~32;
 				cur->dir&=~32;
 			}
 	#endif
 	#if Z_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Z
-			if((curd->dir & 68)==68) if(READ(Z_MAX_PIN)!= ENDSTOP_Z_MAX_INVERTING) {
+			if((curd->dir & 68)==68) if(ENDSTOP_HIT(ENDSTOP_Z_MAX_BIT,Z_MAX_PIN,ENDSTOP_Z_MAX_INVERTING)) {
 				curd->dir&=~64;
 				cur->dir&=~64;
 			}
 	#endif
 		}
 	}
+	ISR_PROFILE_PHASE(ISR_PHASE_ENDSTOPS);
+#if STEPPER_LOOP_SPREAD
+	byte max_loops = 1; // Every step gets its own call
+#else
 	byte max_loops = (printer_state.stepper_loops<=cur->stepsRemaining ? printer_state.stepper_loops : cur->stepsRemaining);
+#endif
+#if defined(USE_ADVANCE) && defined(ENABLE_QUADRATIC_ADVANCE)
+	byte speed_loops = (STEPPER_LOOP_SPREAD ? printer_state.stepper_loops : max_loops); // Steps per speed computation for the advance
+#endif
 	if(cur->stepsRemaining>0) {
 		for(byte loop=0;loop<max_loops;loop++) {
+	#if STEPPER_PORT_BATCHING
+			byte stepX = 0,stepY = 0,stepZ = 0;
+	#endif
 			if(loop>0)
 	#if STEPPER_HIGH_DELAY>0
 				delayMicroseconds(STEPPER_HIGH_DELAY+DOUBLE_STEP_DELAY);
@@ -1297,11 +1805,15 @@ inline long bresenham_step() {
 					cur->error[3] += cur_errupd;
 				}
 			}
+	#if UNIFIED_EXTRUDER_STEPPING
+			if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT) && extruder_scheduled_step_due())
+				extruder_step();
+	#endif
 			if (curd) {
 				// Take delta steps
 				if(curd->dir & 16) {
 					if((cur->error[0] -= curd->deltaSteps[0]) < 0) {
-						WRITE(X_STEP_PIN,HIGH);
+						STEP_HIGH(X_STEP_PIN,stepX);
 						cur->error[0] += curd_errupd;
 					#ifdef DEBUG_STEPCOUNT
 						cur->totalStepsRemaining--;
@@ -1311,7 +1823,7 @@ inline long bresenham_step() {
 
 				if(curd->dir & 32) {
 					if((cur->error[1] -= curd->deltaSteps[1]) < 0) {
-						WRITE(Y_STEP_PIN,HIGH);
+						STEP_HIGH(Y_STEP_PIN,stepY);
 						cur->error[1] += curd_errupd;
 					#ifdef DEBUG_STEPCOUNT
 						cur->totalStepsRemaining--;
@@ -1321,7 +1833,7 @@ inline long bresenham_step() {
 
 				if(curd->dir & 64) {
 					if((cur->error[2] -= curd->deltaSteps[2]) < 0) {
-						WRITE(Z_STEP_PIN,HIGH);
+						STEP_HIGH(Z_STEP_PIN,stepZ);
 						printer_state.countZSteps += ( cur->dir & 4 ? 1 : -1 );
 						cur->error[2] += curd_errupd;
 					#ifdef DEBUG_STEPCOUNT
@@ -1330,12 +1842,28 @@ inline long bresenham_step() {
 					}
 				}
 
+			#if STEPPER_PORT_BATCHING
+				step_ports_high(stepX,stepY,stepZ,0);
+			#endif
+				STEP_TRACE_RECORD;
+			#if SPLIT_STEP_PULSE
+				if(loop+1==max_loops)
+					step_pulse_pending |= 1; // next interrupt ends the pulse
+				else {
+			#endif
 			#if STEPPER_HIGH_DELAY>0
 				delayMicroseconds(STEPPER_HIGH_DELAY);
 			#endif
+			#if STEPPER_PORT_BATCHING
+				step_ports_low(0);
+			#else
 				WRITE(X_STEP_PIN,LOW);
 				WRITE(Y_STEP_PIN,LOW);
 				WRITE(Z_STEP_PIN,LOW);
+			#endif
+			#if SPLIT_STEP_PULSE
+				}
+			#endif
 				stepsPerSegRemaining--;
 				if (!stepsPerSegRemaining) {
 					cur->numDeltaSegments--;
@@ -1369,6 +1897,9 @@ inline long bresenham_step() {
 						} else {
 							WRITE(Z_DIR_PIN,INVERT_Z_DIR);
 						}
+	#if ENDSTOP_INTERRUPTS
+						endstop_set_mask(endstop_segment_mask(curd->dir,cur->flags & FLAG_CHECK_ENDSTOPS));
+	#endif
 					} else {
 						// Release the last segment
 						delta_segment_count--;
@@ -1376,42 +1907,54 @@ inline long bresenham_step() {
 					}
 				}
 			}
-	#if USE_OPS==1 || defined(USE_ADVANCE)
+	#if SPLIT_STEP_PULSE
+			if(loop+1==max_loops) {
+		#if (USE_OPS==1 || defined(USE_ADVANCE)) && !UNIFIED_EXTRUDER_STEPPING
+				if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0)
+		#endif
+				step_pulse_pending |= 2;
+			} else
+	#endif
+	#if (USE_OPS==1 || defined(USE_ADVANCE)) && !UNIFIED_EXTRUDER_STEPPING
 			if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) // Use interrupt for movement
 	#endif
 			extruder_unstep();
 		} // for loop
+		ISR_PROFILE_PHASE(ISR_PHASE_BRESENHAM);
+#if STEPPER_LOOP_SPREAD
+		if(do_odd && stepper_loop_count==0) {
+#else
 		if(do_odd) {
+#endif
 			sei(); // Allow interrupts for other types, timer1 is still disabled
 	#ifdef RAMP_ACCELERATION
 		//If acceleration is enabled on this move and we are in the acceleration segment, calculate the current interval
 			if (printer_state.stepNumber <= cur->accelSteps) { // we are accelerating
+#if RAMP_TABLE_SIZE>0
+			  if(cur->flags & FLAG_RAMP_TABLE) {
+				byte idx = printer_state.stepNumber>>cur->accelShift;
+		#ifdef USE_ADVANCE
+				printer_state.vMaxReached = cur->accelSpeed[idx];
+		#endif
+				setRampInterval(cur->accelInterval[idx]);
+			  } else {
+#endif
+#ifdef S_CURVE_ACCELERATION
+				printer_state.vMaxReached = ComputeSCurveV(printer_state.timer,cur->facceleration,cur->accelDV,cur->accelRampInv)+cur->vStart;
+#else
 				printer_state.vMaxReached = ComputeV(printer_state.timer,cur->facceleration)+cur->vStart;
+#endif
 				if(printer_state.vMaxReached>cur->vMax) printer_state.vMaxReached = cur->vMax;
-				unsigned int v;
-				if(printer_state.vMaxReached>STEP_DOUBLER_FREQUENCY) {
-		#if ALLOW_QUADSTEPPING
-					if(printer_state.vMaxReached>STEP_DOUBLER_FREQUENCY*2) {
-						printer_state.stepper_loops = 4;
-						v = printer_state.vMaxReached>>2;
-					} else {
-						printer_state.stepper_loops = 2;
-						v = printer_state.vMaxReached>>1;
-					}
-		#else
-					printer_state.stepper_loops = 2;
-					v = printer_state.vMaxReached>>1;
-		#endif
-				} else {
-					printer_state.stepper_loops = 1;
-					v = printer_state.vMaxReached;
-				}
+				unsigned int v = printer_state.vMaxReached>>set_stepper_loops(printer_state.vMaxReached);
 				printer_state.interval = CPUDivU2(v);
+#if RAMP_TABLE_SIZE>0
+			  }
+#endif
 				printer_state.timer+=printer_state.interval;
 		#ifdef USE_ADVANCE
 			#ifdef ENABLE_QUADRATIC_ADVANCE
 				long advance_target =printer_state.advance_executed+cur->advanceRate;
-				for(byte loop=1;loop<max_loops;loop++) advance_target+=cur->advanceRate;
+				for(byte loop=1;loop<speed_loops;loop++) advance_target+=cur->advanceRate;
 				if(advance_target>cur->advanceFull)
 					advance_target = cur->advanceFull;
 				cli();
@@ -1433,35 +1976,37 @@ inline long bresenham_step() {
 					printer_state.timer = 0;
 					cur->flags |= FLAG_DECELERATING;
 				}
-				unsigned int v = ComputeV(printer_state.timer,cur->facceleration);
+				unsigned int v;
+#if RAMP_TABLE_SIZE>0
+			  if(cur->flags & FLAG_RAMP_TABLE) {
+				byte idx = cur->stepsRemaining>>cur->decelShift;
+		#ifdef USE_ADVANCE
+				v = cur->decelSpeed[idx];
+		#endif
+				setRampInterval(cur->decelInterval[idx]);
+			  } else {
+#endif
+#ifdef S_CURVE_ACCELERATION
+				v = ComputeSCurveV(printer_state.timer,cur->facceleration,cur->decelDV,cur->decelRampInv);
+#else
+				v = ComputeV(printer_state.timer,cur->facceleration);
+#endif
 				if (v > printer_state.vMaxReached)   // if deceleration goes too far it can become too large
 					v = cur->vEnd;
 				else {
 					v=printer_state.vMaxReached-v;
 					if (v<cur->vEnd) v = cur->vEnd; // extra steps at the end of desceleration due to rounding erros
 				}
-				if(v>STEP_DOUBLER_FREQUENCY) {
-		#if ALLOW_QUADSTEPPING
-					if(v>STEP_DOUBLER_FREQUENCY*2) {
-						printer_state.stepper_loops = 4;
-						v = v>>2;
-					} else {
-						printer_state.stepper_loops = 2;
-						v = v>>1;
-					}
-		#else
-					printer_state.stepper_loops = 2;
-					v = v>>1;
-		#endif
-				} else {
-					printer_state.stepper_loops = 1;
-				}
+				v >>= set_stepper_loops(v);
 				printer_state.interval = CPUDivU2(v);
+#if RAMP_TABLE_SIZE>0
+			  }
+#endif
 				printer_state.timer+=printer_state.interval;
 		#ifdef USE_ADVANCE
 			#ifdef ENABLE_QUADRATIC_ADVANCE
 				long advance_target =printer_state.advance_executed-cur->advanceRate;
-				for(byte loop=1;loop<max_loops;loop++) advance_target-=cur->advanceRate;
+				for(byte loop=1;loop<speed_loops;loop++) advance_target-=cur->advanceRate;
 				if(advance_target<cur->advanceEnd)
 					advance_target = cur->advanceEnd;
 				long h=mulu6xu16to32(cur->advanceL,v);
@@ -1505,36 +2050,21 @@ inline long bresenham_step() {
 			#endif
 		#endif
 				if(!cur->accelSteps) {
-					if(cur->vMax>STEP_DOUBLER_FREQUENCY) {
-		#if ALLOW_QUADSTEPPING
-						if(cur->vMax>STEP_DOUBLER_FREQUENCY*2) {
-							printer_state.stepper_loops = 4;
-							printer_state.interval = cur->fullInterval<<2;
-						} else {
-							printer_state.stepper_loops = 2;
-							printer_state.interval = cur->fullInterval<<1;
-						}
-		#else
-						printer_state.stepper_loops = 2;
-						printer_state.interval = cur->fullInterval<<1;
-		#endif
-					} else {
-						printer_state.stepper_loops = 1;
-						printer_state.interval = cur->fullInterval;
-					}
+					printer_state.interval = cur->fullInterval<<set_stepper_loops(cur->vMax);
 				}
 			}
 	#else
 			printer_state.interval = cur->fullInterval; // without RAMPS always use full speed
 	#endif
 		} // do_odd
+		ISR_PROFILE_PHASE(ISR_PHASE_SPEED);
 		if(do_even) {
 			printer_state.stepNumber+=max_loops;
 			cur->stepsRemaining-=max_loops;
 		}
 
 	#if USE_OPS==1
-		if(printer_state.opsMode==2 && (cur->joinFlags & FLAG_JOIN_END_RETRACT) && printer_state.filamentRetracted && cur->stepsRemaining<=cur->opsReverseSteps) {
+		if(printer_state.opsMode==2 && (cur->joinFlags & FLAG_JOIN_END_RETRACT) && printer_state.filamentRetracted && cur->stepsRemaining<=(unsigned long)cur->opsReverseSteps) {
 		#ifdef DEBUG_OPS
 			out.println_long_P(PSTR("DownX"),cur->stepsRemaining);
 		#endif
@@ -1550,10 +2080,19 @@ inline long bresenham_step() {
 	#endif
 	} // stepsRemaining
 	long interval;
-	if(cur->halfstep)
+	if(LINE_HALFSTEP(cur))
 		interval = (printer_state.interval>>1);		// time to come back
 	else
 		interval = printer_state.interval;
+#if STEPPER_LOOP_SPREAD
+	// interval is the time of all steps of the speed computation, the last call gets the rounding rest
+	if(++stepper_loop_count<printer_state.stepper_loops)
+		interval >>= stepper_loop_shift;
+	else {
+		interval -= (interval>>stepper_loop_shift)*(printer_state.stepper_loops-1);
+		stepper_loop_count = 0;
+	}
+#endif
 	if(do_even) {
 		if(cur->stepsRemaining<=0 || (cur->dir & 240)==0) { // line finished
 //			out.println_int_P(PSTR("Line finished: "), (int) cur->numDeltaSegments);
@@ -1583,7 +2122,7 @@ inline long bresenham_step() {
 					printer_state.extruderStepsNeeded+=printer_state.opsPushbackSteps;
 				}
 				cli();
-				if(printer_state.extruderStepsNeeded) {
+				if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
 		#ifdef DEBUG_OPS
     //      sei();
     //      out.println_int_P(PSTR("W"),printer_state.extruderStepsNeeded);
@@ -1598,16 +2137,23 @@ inline long bresenham_step() {
 			cli();
 			lines_pos++;
 			if(lines_pos>=MOVE_CACHE_SIZE) lines_pos=0;
+			lines_ticks -= cur->timeInTicks;
+			lines_done_seq++;
 			cur = 0;
 			--lines_count;
+			STEP_TIMING_LINE_END;
 			if(DISABLE_X) disable_x();
 			if(DISABLE_Y) disable_y();
 			if(DISABLE_Z) disable_z();
 			if(lines_count==0) UI_STATUS(UI_TEXT_IDLE);
 			interval = printer_state.interval = interval>>1; // 50% of time to next call to do cur=0
+			ISR_PROFILE_PHASE(ISR_PHASE_LINE_END);
 		}
 	        DEBUG_MEMORY;
 	} // Do even
+#if UNIFIED_EXTRUDER_STEPPING
+	extruder_schedule_time(interval);
+#endif
 	return interval;
 }
 #else
@@ -1617,25 +2163,24 @@ inline long bresenham_step() {
   
   Normal non delta algorithm
 */
-int lastblk=-1;
 long cur_errupd;
 inline long bresenham_step() {
   if(cur == 0) {
       sei();
       ANALYZER_ON(ANALYZER_CH0);
-      cur = &lines[lines_pos];
-      if(cur->flags & FLAG_BLOCKED) { // This step is in computation - shouldn't happen
-        if(lastblk!=(int)cur) {
-          lastblk = (int)cur;
-          out.println_int_P(PSTR("BLK "),(unsigned int)lines_count);
+      if(lines_commit_seq==lines_done_seq) { // Line not committed by the path planner
+        if(planner_busy) { // Planner is updating it, try again soon
+          planner_stalls++;
+          return 500;
         }
-        cur = 0;
-        return 2000;
+        commit_line();
       }
-      lastblk = -1;
+      cur = &lines[lines_pos];
 #ifdef INCLUDE_DEBUG_NO_MOVE
       if(DEBUG_NO_MOVES) { // simulate a move, but do nothing in reality
         NEXT_PLANNER_INDEX(lines_pos);
+        lines_ticks -= cur->timeInTicks;
+        lines_done_seq++;
         cur = 0;
         cli();
         --lines_count;
@@ -1658,7 +2203,7 @@ inline long bresenham_step() {
               printer_state.extruderStepsNeeded+=printer_state.opsPushbackSteps;
               sei();
             }
-            if(printer_state.extruderStepsNeeded) {
+            if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
               cur = 0;
               return 2000; // wait, work is done in other interrupt
             }
@@ -1673,7 +2218,7 @@ inline long bresenham_step() {
               printer_state.extruderStepsNeeded-=printer_state.opsRetractSteps;
               cur->joinFlags |= FLAG_JOIN_WAIT_EXTRUDER_UP;
             }
-            if(printer_state.extruderStepsNeeded) {
+            if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
               cur = 0;
               return 2000; // wait, work is done in other interrupt
             }
@@ -1685,6 +2230,8 @@ inline long bresenham_step() {
           }
           NEXT_PLANNER_INDEX(lines_pos);
           long wait = cur->accelerationPrim;
+          lines_ticks -= cur->timeInTicks;
+          lines_done_seq++;
           cur = 0;
           cli();
           --lines_count;
@@ -1710,6 +2257,9 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
       }
       if(cur->dir & 128) extruder_enable();
       cur->joinFlags |= FLAG_JOIN_END_FIXED | FLAG_JOIN_START_FIXED; // don't touch this segment any more, just for safety
+#if ENDSTOP_INTERRUPTS
+      endstop_set_mask(endstop_line_mask(cur->dir,cur->flags & FLAG_CHECK_ENDSTOPS));
+#endif
 #if USE_OPS==1
       if(printer_state.opsMode) { // Enabled?
         if(cur->joinFlags & FLAG_JOIN_START_RETRACT) {
@@ -1748,13 +2298,13 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
         }
         if(cur->joinFlags & FLAG_JOIN_WAIT_EXTRUDER_UP) { // Wait for filament pushback
           cli();
-          if(printer_state.extruderStepsNeeded<printer_state.opsMoveAfterSteps) {
+          if(printer_state.extruderStepsNeeded<printer_state.opsMoveAfterSteps-1) { // the extruder leaves up to 1 step
             cur=0;
             return 4000;
           }
         } else if(cur->joinFlags & FLAG_JOIN_WAIT_EXTRUDER_DOWN) { // Wait for filament pushback
           cli();
-          if(printer_state.extruderStepsNeeded) {
+          if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
             cur=0;
             return 4000;
           }
@@ -1762,17 +2312,20 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
       } // End if opsMode
 #endif
       sei(); // Allow interrupts
-      if(cur->halfstep) {
+      if(LINE_HALFSTEP(cur)) {
         cur_errupd = cur->delta[cur->primaryAxis]<<1;
         //printer_state.interval = CPUDivU2(cur->vStart);
       } else
         cur_errupd = cur->delta[cur->primaryAxis];
       if(!(cur->joinFlags & FLAG_JOIN_STEPPARAMS_COMPUTED)) {// should never happen, but with bad timings???
-		updateStepsParameter(cur/*,8*/);
+		updateStepsParameter(cur,PLAN_LINE(lines_pos)/*,8*/);
       }
       printer_state.vMaxReached = cur->vStart;
       printer_state.stepNumber=0;
       printer_state.timer = 0;
+#if STEPPER_LOOP_SPREAD
+      stepper_loop_count = 0;
+#endif
       cli();
       //Determine direction of movement,check if endstop was hit
 #if !defined(XY_GANTRY)
@@ -1826,11 +2379,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 #if USE_OPS==1 || defined(USE_ADVANCE)
       if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) // Set direction if no advance/OPS enabled
 #endif
-        if(cur->dir & 8) {
-          extruder_set_direction(1);
-        } else {
-          extruder_set_direction(0);
-        }
+        extruder_set_direction(cur->dir & 8 ? 1 : 0);
 #ifdef USE_ADVANCE
      long h = mulu6xu16to32(cur->vStart,cur->advanceL);
      int tred = ((
@@ -1841,10 +2390,11 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
      printer_state.extruderStepsNeeded+=tred-printer_state.advance_steps_set;
      printer_state.advance_steps_set = tred;
 #endif
-    if(printer_state.waslasthalfstepping && cur->halfstep==0) { // Switch halfstepping -> full stepping
+    ISR_PROFILE_PHASE(ISR_PHASE_NEW_LINE);
+    if(printer_state.waslasthalfstepping && LINE_HALFSTEP(cur)==0) { // Switch halfstepping -> full stepping
       printer_state.waslasthalfstepping = 0;
       return printer_state.interval*3; // Wait an other 150% from last half step to make the 100% full
-    } else if(!printer_state.waslasthalfstepping && cur->halfstep) { // Switch full to half stepping
+    } else if(!printer_state.waslasthalfstepping && LINE_HALFSTEP(cur)) { // Switch full to half stepping
       printer_state.waslasthalfstepping = 1;
     } else 
       return printer_state.interval; // Wait an other 50% from last step to make the 100% full
@@ -1852,6 +2402,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
   sei();
   /* For halfstepping, we divide the actions into even and odd actions to split
      time used per loop. */
+#if HALFSTEPPING
   byte do_even;
   byte do_odd;
   if(cur->halfstep) {
@@ -1862,11 +2413,19 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
     do_even = 1;
     do_odd = 1;
   }
+#else
+  const byte do_even = 1; // Every call steps and updates the speed
+  const byte do_odd = 1;
+#endif
   cli();
   if(do_even) {
+#if ENDSTOP_INTERRUPTS
+   byte endstop_hits = endstop_check();
+   if(endstop_hits) {
+#endif
 	if(cur->flags & FLAG_CHECK_ENDSTOPS) {
 #if X_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_X
-		if((cur->dir & 17)==16) if(READ(X_MIN_PIN) != ENDSTOP_X_MIN_INVERTING) {
+		if((cur->dir & 17)==16) if(ENDSTOP_HIT(ENDSTOP_X_MIN_BIT,X_MIN_PIN,ENDSTOP_X_MIN_INVERTING)) {
 #if DRIVE_SYSTEM==0
 			cur->dir&=~16;
 #else
@@ -1875,7 +2434,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 		}
 #endif
 #if Y_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Y
-		if((cur->dir & 34)==32) if(READ(Y_MIN_PIN) != ENDSTOP_Y_MIN_INVERTING) {
+		if((cur->dir & 34)==32) if(ENDSTOP_HIT(ENDSTOP_Y_MIN_BIT,Y_MIN_PIN,ENDSTOP_Y_MIN_INVERTING)) {
 #if DRIVE_SYSTEM==0
 			cur->dir&=~32;
 #else
@@ -1884,7 +2443,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 		}
 #endif
 #if X_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_X
-		if((cur->dir & 17)==17) if(READ(X_MAX_PIN) != ENDSTOP_X_MAX_INVERTING) {
+		if((cur->dir & 17)==17) if(ENDSTOP_HIT(ENDSTOP_X_MAX_BIT,X_MAX_PIN,ENDSTOP_X_MAX_INVERTING)) {
 #if DRIVE_SYSTEM==0
 			cur->dir&=~16;
 #else
@@ -1893,7 +2452,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 		}
 #endif
 #if Y_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Y
-		if((cur->dir & 34)==34) if(READ(Y_MAX_PIN) != ENDSTOP_Y_MAX_INVERTING) {
+		if((cur->dir & 34)==34) if(ENDSTOP_HIT(ENDSTOP_Y_MAX_BIT,Y_MAX_PIN,ENDSTOP_Y_MAX_INVERTING)) {
 #if DRIVE_SYSTEM==0
 			cur->dir&=~32;
 #else
@@ -1904,15 +2463,29 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
    }
    // Test Z-Axis every step if necessary, otherwise it could easyly ruin your printer!
 #if Z_MIN_PIN>-1 && MIN_HARDWARE_ENDSTOP_Z
-   if((cur->dir & 68)==64) if(READ(Z_MIN_PIN) != ENDSTOP_Z_MIN_INVERTING) {cur->dir&=~64;}
+   if((cur->dir & 68)==64) if(ENDSTOP_HIT(ENDSTOP_Z_MIN_BIT,Z_MIN_PIN,ENDSTOP_Z_MIN_INVERTING)) {cur->dir&=~64;}
 #endif
 #if Z_MAX_PIN>-1 && MAX_HARDWARE_ENDSTOP_Z
-   if((cur->dir & 68)==68) if(READ(Z_MAX_PIN)!= ENDSTOP_Z_MAX_INVERTING) {cur->dir&=~64;}
+   if((cur->dir & 68)==68) if(ENDSTOP_HIT(ENDSTOP_Z_MAX_BIT,Z_MAX_PIN,ENDSTOP_Z_MAX_INVERTING)) {cur->dir&=~64;}
+#endif
+#if ENDSTOP_INTERRUPTS
+   }
 #endif
   }
+  ISR_PROFILE_PHASE(ISR_PHASE_ENDSTOPS);
+#if STEPPER_LOOP_SPREAD
+  byte max_loops = 1; // Every step gets its own call
+#else
   byte max_loops = (printer_state.stepper_loops<=cur->stepsRemaining ? printer_state.stepper_loops : cur->stepsRemaining);
+#endif
+#if defined(USE_ADVANCE) && defined(ENABLE_QUADRATIC_ADVANCE)
+  byte speed_loops = (STEPPER_LOOP_SPREAD ? printer_state.stepper_loops : max_loops); // Steps per speed computation for the advance
+#endif
   if(cur->stepsRemaining>0) {
    for(byte loop=0;loop<max_loops;loop++) {
+#if STEPPER_PORT_BATCHING
+    byte stepX = 0,stepY = 0,stepZ = 0,stepE = 0;
+#endif
     ANALYZER_ON(ANALYZER_CH1);
     if(loop>0)
 #if STEPPER_HIGH_DELAY>0
@@ -1930,13 +2503,26 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
             printer_state.extruderStepsNeeded--;
         } else {
 #endif
+#if STEPPER_PORT_BATCHING && STEP_BATCH_E
+          STEP_HIGH(EXT0_STEP_PIN,stepE);
+#else
           extruder_step();
+#endif
 #if USE_OPS==1 || defined(USE_ADVANCE)
         }
 #endif
         cur->error[3] += cur_errupd;
       }
     }
+#if UNIFIED_EXTRUDER_STEPPING
+    if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT) && extruder_scheduled_step_due()) {
+#if STEPPER_PORT_BATCHING && STEP_BATCH_E
+      STEP_HIGH(EXT0_STEP_PIN,stepE);
+#else
+      extruder_step();
+#endif
+    }
+#endif
 #if defined(XY_GANTRY)
 #endif
     if(cur->dir & 16) {
@@ -1944,7 +2530,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
         ANALYZER_ON(ANALYZER_CH6);
 #if DRIVE_SYSTEM==0 || !defined(XY_GANTRY)
         ANALYZER_ON(ANALYZER_CH2);
-        WRITE(X_STEP_PIN,HIGH);
+        STEP_HIGH(X_STEP_PIN,stepX);
 #else
 #if DRIVE_SYSTEM==1
         if(cur->dir & 1) {
@@ -1976,7 +2562,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
         ANALYZER_ON(ANALYZER_CH7);
 #if DRIVE_SYSTEM==0 || !defined(XY_GANTRY)
         ANALYZER_ON(ANALYZER_CH3);
-        WRITE(Y_STEP_PIN,HIGH);
+        STEP_HIGH(Y_STEP_PIN,stepY);
 #else
 #if DRIVE_SYSTEM==1
         if(cur->dir & 2) {
@@ -2006,20 +2592,20 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 #if defined(XY_GANTRY)
     if(printer_state.motorX <= -2) {
       ANALYZER_ON(ANALYZER_CH2);
-      WRITE(X_STEP_PIN,HIGH);
+      STEP_HIGH(X_STEP_PIN,stepX);
       printer_state.motorX += 2;
     } else if(printer_state.motorX >= 2) {
       ANALYZER_ON(ANALYZER_CH2);
-      WRITE(X_STEP_PIN,HIGH);
+      STEP_HIGH(X_STEP_PIN,stepX);
       printer_state.motorX -= 2;
     }
     if(printer_state.motorY <= -2) {
       ANALYZER_ON(ANALYZER_CH3);
-      WRITE(Y_STEP_PIN,HIGH);
+      STEP_HIGH(Y_STEP_PIN,stepY);
       printer_state.motorY += 2;
     } else if(printer_state.motorY >= 2) {
       ANALYZER_ON(ANALYZER_CH3);
-      WRITE(Y_STEP_PIN,HIGH);
+      STEP_HIGH(Y_STEP_PIN,stepY);
       printer_state.motorY -= 2;
     }
 
@@ -2027,60 +2613,92 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 
     if(cur->dir & 64) {
       if((cur->error[2] -= cur->delta[2]) < 0) {
-        WRITE(Z_STEP_PIN,HIGH);
+        STEP_HIGH(Z_STEP_PIN,stepZ);
         cur->error[2] += cur_errupd;
 #ifdef DEBUG_STEPCOUNT
         cur->totalStepsRemaining--;
 #endif
       }
     }
+#if STEPPER_PORT_BATCHING
+    step_ports_high(stepX,stepY,stepZ,stepE);
+#endif
+    STEP_TRACE_RECORD;
+#if SPLIT_STEP_PULSE
+    if(loop+1==max_loops) { // next interrupt ends the pulse
+#if STEPPER_PORT_BATCHING && STEP_BATCH_E
+      step_pulse_pending = (stepE ? 3 : 1);
+#elif (USE_OPS==1 || defined(USE_ADVANCE)) && !UNIFIED_EXTRUDER_STEPPING
+      step_pulse_pending = ((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT) ? 1 : 3);
+#else
+      step_pulse_pending = 3;
+#endif
+    } else {
+#endif
 #if STEPPER_HIGH_DELAY>0
     delayMicroseconds(STEPPER_HIGH_DELAY);
 #endif
-#if USE_OPS==1 || defined(USE_ADVANCE)
+#if STEPPER_PORT_BATCHING
+#if !STEP_BATCH_E
+#if (USE_OPS==1 || defined(USE_ADVANCE)) && !UNIFIED_EXTRUDER_STEPPING
+    if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) // Use interrupt for movement
+#endif
+      extruder_unstep();
+#endif
+    step_ports_low(stepE);
+#else
+#if (USE_OPS==1 || defined(USE_ADVANCE)) && !UNIFIED_EXTRUDER_STEPPING
     if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) // Use interrupt for movement
 #endif
       extruder_unstep();
     WRITE(X_STEP_PIN,LOW);
     WRITE(Y_STEP_PIN,LOW);
     WRITE(Z_STEP_PIN,LOW);
+#endif
+#if SPLIT_STEP_PULSE
+    }
+#endif
     ANALYZER_OFF(ANALYZER_CH1);
     ANALYZER_OFF(ANALYZER_CH2);
     ANALYZER_OFF(ANALYZER_CH3);
     ANALYZER_OFF(ANALYZER_CH6);
     ANALYZER_OFF(ANALYZER_CH7);
   } // for loop
+  ISR_PROFILE_PHASE(ISR_PHASE_BRESENHAM);
+#if STEPPER_LOOP_SPREAD
+  if(do_odd && stepper_loop_count==0) {
+#else
   if(do_odd) {
+#endif
       sei(); // Allow interrupts for other types, timer1 is still disabled
 #ifdef RAMP_ACCELERATION
       //If acceleration is enabled on this move and we are in the acceleration segment, calculate the current interval
       if (printer_state.stepNumber <= cur->accelSteps) { // we are accelerating
+#if RAMP_TABLE_SIZE>0
+       if(cur->flags & FLAG_RAMP_TABLE) {
+        byte idx = printer_state.stepNumber>>cur->accelShift;
+#ifdef USE_ADVANCE
+        printer_state.vMaxReached = cur->accelSpeed[idx];
+#endif
+        setRampInterval(cur->accelInterval[idx]);
+       } else {
+#endif
+#ifdef S_CURVE_ACCELERATION
+        printer_state.vMaxReached = ComputeSCurveV(printer_state.timer,cur->facceleration,cur->accelDV,cur->accelRampInv)+cur->vStart;
+#else
         printer_state.vMaxReached = ComputeV(printer_state.timer,cur->facceleration)+cur->vStart;
+#endif
         if(printer_state.vMaxReached>cur->vMax) printer_state.vMaxReached = cur->vMax;
-        unsigned int v;
-        if(printer_state.vMaxReached>STEP_DOUBLER_FREQUENCY) {
- #if ALLOW_QUADSTEPPING
-          if(printer_state.vMaxReached>STEP_DOUBLER_FREQUENCY*2) {
-            printer_state.stepper_loops = 4;
-            v = printer_state.vMaxReached>>2;
-          } else {
-            printer_state.stepper_loops = 2;
-            v = printer_state.vMaxReached>>1;
-          }
- #else
-          printer_state.stepper_loops = 2;
-          v = printer_state.vMaxReached>>1;
- #endif
-        } else {
-          printer_state.stepper_loops = 1;
-          v = printer_state.vMaxReached;
-        }
+        unsigned int v = printer_state.vMaxReached>>set_stepper_loops(printer_state.vMaxReached);
         printer_state.interval = CPUDivU2(v);
+#if RAMP_TABLE_SIZE>0
+       }
+#endif
         printer_state.timer+=printer_state.interval;
 #ifdef USE_ADVANCE
 #ifdef ENABLE_QUADRATIC_ADVANCE
         long advance_target =printer_state.advance_executed+cur->advanceRate;
-        for(byte loop=1;loop<max_loops;loop++) advance_target+=cur->advanceRate;
+        for(byte loop=1;loop<speed_loops;loop++) advance_target+=cur->advanceRate;
         if(advance_target>cur->advanceFull)
           advance_target = cur->advanceFull;
         cli();
@@ -2103,7 +2721,23 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
            printer_state.timer = 0;
            cur->flags |= FLAG_DECELERATING;
         }
+#ifdef USE_ADVANCE
+        unsigned int v0;
+#endif
+#if RAMP_TABLE_SIZE>0
+       if(cur->flags & FLAG_RAMP_TABLE) {
+        byte idx = cur->stepsRemaining>>cur->decelShift;
+#ifdef USE_ADVANCE
+        v0 = cur->decelSpeed[idx];
+#endif
+        setRampInterval(cur->decelInterval[idx]);
+       } else {
+#endif
+#ifdef S_CURVE_ACCELERATION
+        unsigned int v = ComputeSCurveV(printer_state.timer,cur->facceleration,cur->decelDV,cur->decelRampInv);
+#else
         unsigned int v = ComputeV(printer_state.timer,cur->facceleration);
+#endif
         if (v > printer_state.vMaxReached)   // if deceleration goes too far it can become too large
           v = cur->vEnd;
         else{
@@ -2111,30 +2745,18 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
           if (v<cur->vEnd) v = cur->vEnd; // extra steps at the end of desceleration due to rounding erros
         }
 #ifdef USE_ADVANCE
-        unsigned int v0 = v;
-#endif
-        if(v>STEP_DOUBLER_FREQUENCY) {
-#if ALLOW_QUADSTEPPING
-          if(v>STEP_DOUBLER_FREQUENCY*2) {
-            printer_state.stepper_loops = 4;
-            v = v>>2;
-          } else {
-            printer_state.stepper_loops = 2;
-            v = v>>1;
-          }
-#else
-          printer_state.stepper_loops = 2;
-          v = v>>1;
+        v0 = v;
 #endif
-        } else {
-          printer_state.stepper_loops = 1;
-        }
+        v >>= set_stepper_loops(v);
         printer_state.interval = CPUDivU2(v);
+#if RAMP_TABLE_SIZE>0
+       }
+#endif
         printer_state.timer+=printer_state.interval;
 #ifdef USE_ADVANCE
 #ifdef ENABLE_QUADRATIC_ADVANCE
         long advance_target =printer_state.advance_executed-cur->advanceRate;
-        for(byte loop=1;loop<max_loops;loop++) advance_target-=cur->advanceRate;
+        for(byte loop=1;loop<speed_loops;loop++) advance_target-=cur->advanceRate;
         if(advance_target<cur->advanceEnd)
           advance_target = cur->advanceEnd;
         long h=mulu6xu16to32(cur->advanceL,v0);
@@ -2178,36 +2800,21 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 #endif
 #endif
         if(!cur->accelSteps) {
-          if(cur->vMax>STEP_DOUBLER_FREQUENCY) {
-#if ALLOW_QUADSTEPPING
-            if(cur->vMax>STEP_DOUBLER_FREQUENCY*2) {
-              printer_state.stepper_loops = 4;
-              printer_state.interval = cur->fullInterval<<2;
-            } else {
-              printer_state.stepper_loops = 2;
-              printer_state.interval = cur->fullInterval<<1;
-            }
-#else
-            printer_state.stepper_loops = 2;
-            printer_state.interval = cur->fullInterval<<1;
-#endif
-          } else {
-            printer_state.stepper_loops = 1;
-            printer_state.interval = cur->fullInterval;
-         }
+          printer_state.interval = cur->fullInterval<<set_stepper_loops(cur->vMax);
        }
       }
 #else
       printer_state.interval = cur->fullInterval; // without RAMPS always use full speed
 #endif
     } // do_odd
+    ISR_PROFILE_PHASE(ISR_PHASE_SPEED);
     if(do_even) {
      printer_state.stepNumber+=max_loops;
      cur->stepsRemaining-=max_loops;
     }
 
 #if USE_OPS==1
-    if(printer_state.opsMode==2 && (cur->joinFlags & FLAG_JOIN_END_RETRACT) && printer_state.filamentRetracted && cur->stepsRemaining<=cur->opsReverseSteps) {
+    if(printer_state.opsMode==2 && (cur->joinFlags & FLAG_JOIN_END_RETRACT) && printer_state.filamentRetracted && cur->stepsRemaining<=(unsigned long)cur->opsReverseSteps) {
 #ifdef DEBUG_OPS
       OUT_P_L_LN("DownX",cur->stepsRemaining);
 #endif
@@ -2223,8 +2830,17 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 #endif
   } // stepsRemaining
   long interval;
-  if(cur->halfstep) interval = (printer_state.interval>>1); // time to come back
+  if(LINE_HALFSTEP(cur)) interval = (printer_state.interval>>1); // time to come back
   else interval = printer_state.interval;
+#if STEPPER_LOOP_SPREAD
+  // interval is the time of all steps of the speed computation, the last call gets the rounding rest
+  if(++stepper_loop_count<printer_state.stepper_loops)
+    interval >>= stepper_loop_shift;
+  else {
+    interval -= (interval>>stepper_loop_shift)*(printer_state.stepper_loops-1);
+    stepper_loop_count = 0;
+  }
+#endif
   if(do_even) {
     if(cur->stepsRemaining<=0 || (cur->dir & 240)==0) { // line finished
 #ifdef DEBUG_STEPCOUNT
@@ -2244,7 +2860,7 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
           printer_state.extruderStepsNeeded+=printer_state.opsPushbackSteps;
         }
         cli();
-        if(printer_state.extruderStepsNeeded) {
+        if(printer_state.extruderStepsNeeded>1 || printer_state.extruderStepsNeeded<-1) {
 #ifdef DEBUG_OPS
     //      sei();
     //      out.println_int_P(PSTR("W"),printer_state.extruderStepsNeeded);
@@ -2258,8 +2874,11 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
 #endif
      cli();
      NEXT_PLANNER_INDEX(lines_pos);
+     lines_ticks -= cur->timeInTicks;
+     lines_done_seq++;
      cur = 0;
      --lines_count;
+     STEP_TIMING_LINE_END;
 #ifdef XY_GANTRY
        if(DISABLE_X && DISABLE_Y) {
          disable_x();
@@ -2272,9 +2891,13 @@ OUT_P_L_LN("MSteps:",cur->stepsRemaining);
        if(DISABLE_Z) disable_z();
      if(lines_count==0) UI_STATUS(UI_TEXT_IDLE);
      interval = printer_state.interval = interval>>1; // 50% of time to next call to do cur=0
+     ISR_PROFILE_PHASE(ISR_PHASE_LINE_END);
    }
    DEBUG_MEMORY;
   } // Do even
+#if UNIFIED_EXTRUDER_STEPPING
+  extruder_schedule_time(interval);
+#endif
   return interval;
 }
 #endif
@@ -2302,7 +2925,6 @@ void kill(byte only_steppers)
 #endif
   } else UI_STATUS_UPD(UI_TEXT_STEPPER_DISABLED);
 }
-long stepperWait = 0;
 /** \brief Sets the timer 1 compare value to delay ticks.
 
 This function sets the OCR1A compare counter  to get the next interrupt
@@ -2310,6 +2932,25 @@ at delay ticks measured from the last interrupt. delay must be << 2^24
 */
 inline void setTimer(unsigned long delay)
 {
+#if STEP_TIMING_MONITOR || CPU_ARCH!=ARCH_AVR
+  cli();
+  if(delay<65280) {
+    stepperWait = 0;
+    unsigned int count = TCNT1+100;
+    if((unsigned int)delay<count) {
+#if STEP_TIMING_MONITOR
+      unsigned int late = count-(unsigned int)delay;
+      step_line_misses++;
+      if(late>step_line_lateness) step_line_lateness = late;
+#endif
+      OCR1A = count;
+    } else
+      OCR1A = delay;
+  } else {
+    stepperWait = delay-32768;
+    OCR1A = 32768;
+  }
+#else
   __asm__ __volatile__ (
   "cli \n\t"
   "tst %C[delay] \n\t" //if(delay<65536) {
@@ -2358,13 +2999,34 @@ inline void setTimer(unsigned long delay)
     stepperWait = delay-32768;
     OCR1A = 32768;
   }*/
+#endif
 }
 volatile byte insideTimer1=0;
+#if ENDSTOP_INTERRUPTS
+/** \brief Latches triggered endstops for the stepper interrupt. All pin change vectors share this routine. */
+ISR(PCINT0_vect)
+{
+  endstop_latch |= endstop_read() & endstop_mask;
+}
+#ifdef PCINT1_vect
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#ifdef PCINT2_vect
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#ifdef PCINT3_vect
+ISR(PCINT3_vect, ISR_ALIASOF(PCINT0_vect));
+#endif
+#endif
 /** \brief Timer interrupt routine to drive the stepper motors.
 */
 ISR(TIMER1_COMPA_vect)
 {
+#ifdef DEBUG_STEP_TRACE
+  step_trace_clock += OCR1A+1; // CTC mode, so the last period was OCR1A+1 cycles
+#endif
   if(insideTimer1) return;
+#if CPU_ARCH==ARCH_AVR
   byte doExit;
   __asm__ __volatile__ (
   "ldi %[ex],0 \n\t"
@@ -2391,9 +3053,23 @@ ISR(TIMER1_COMPA_vect)
   "end%=: \n\t"
   :[ex]"=&d"(doExit):[ocr]"i" (_SFR_MEM_ADDR(OCR1A)):"r22","r23" );
   if(doExit) return;
+#else
+  if(stepperWait>=65536) {
+    stepperWait-=32768; // OCR1A stays 32768
+    return;
+  } else if(stepperWait) {
+    OCR1A = stepperWait;
+    stepperWait = 0;
+    return;
+  }
+#endif
   insideTimer1=1;
   OCR1A=61000;
+#if SPLIT_STEP_PULSE
+  if(step_pulse_pending) end_step_pulse();
+#endif
   if(lines_count) {
+    ISR_PROFILE_START;
     setTimer(bresenham_step());
   } else {
     if(waitRelax==0) {
@@ -2430,12 +3106,6 @@ ISR(TIMER1_COMPA_vect)
   insideTimer1=0;
 }
 
-#if USE_OPS==1 || defined(USE_ADVANCE)
-byte extruder_wait_dirchange=0; ///< Wait cycles, if direction changes. Prevents stepper from loosing steps.
-char extruder_last_dir = 0;
-byte extruder_speed = 0;
-#endif
-
 
 /** \brief Timer routine for extruder stepper.
 
@@ -2449,7 +3119,18 @@ allowable speed for the extruder.
 ISR(EXTRUDER_TIMER_VECTOR)
 {
 #if USE_OPS==1 || defined(USE_ADVANCE)
+#if SPLIT_STEP_PULSE
+  if(extruder_pulse_pending) { // End the pulse of the last call
+    extruder_unstep();
+    extruder_pulse_pending = 0;
+  }
+#endif
   if((printer_state.flag0 & PRINTER_FLAG0_SEPERATE_EXTRUDER_INT)==0) return; // currently no need
+#if UNIFIED_EXTRUDER_STEPPING
+  // The stepper interrupt schedules the extruder steps while it steps a line. While OPS waits for the
+  // filament before or after a line, the stepper interrupt makes no steps and they are made here.
+  if(cur && cur->stepsRemaining>0) return;
+#endif
   byte timer = EXTRUDER_OCR;
   bool increasing = printer_state.extruderStepsNeeded>0;
     
@@ -2475,10 +3156,14 @@ ISR(EXTRUDER_TIMER_VECTOR)
     }
     extruder_step();
     printer_state.extruderStepsNeeded-=extruder_last_dir;
+#if SPLIT_STEP_PULSE
+    extruder_pulse_pending = 1;
+#else
 #if STEPPER_HIGH_DELAY>0
     delayMicroseconds(STEPPER_HIGH_DELAY);
 #endif    
     extruder_unstep();
+#endif
   }
   EXTRUDER_OCR = timer+printer_state.maxExtruderSpeed;
   
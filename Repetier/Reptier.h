@@ -49,6 +49,17 @@ usage or for seraching for memory induced errors. Switch it off for production,
 //#define DEBUG_GENERIC
 /** If enabled, steps to move and moved steps are compared. */
 //#define DEBUG_STEPCOUNT
+/** Collects path planner statistics, reported with M260. The planning time covers the whole path from
+queue_move/split_delta_move to the queued line, without the time waiting for a free cache entry. Combine
+with dry run (M111 S14) and INCLUDE_DEBUG_NO_MOVE to measure planner throughput for a gcode file, or use
+host/planbench. */
+//#define DEBUG_PLANNER_STATS
+/** Measures the cycles spent in each phase of the stepper interrupt and how late the interrupt
+starts, reported with M262. Costs a few cycles per interrupt, so switch it off for production. */
+//#define DEBUG_ISR_PROFILER
+/** Records time and step/direction pins of every stepper loop in RAM, written with M265. Allows checking
+step timing against the planned moves without a logic analyzer. STEP_TRACE_SIZE sets the entries (5 byte each). */
+//#define DEBUG_STEP_TRACE
 // Uncomment the following line to enable debugging. You can better control debugging below the following line
 //#define DEBUG
 
@@ -93,20 +104,94 @@ usage or for seraching for memory induced errors. Switch it off for production,
 #define NEW_XY_GANTRY
 
 #include "Configuration.h"
+#ifdef HOST_CONFIG
+// Host build variants override single settings here, see host/Makefile
+#include HOST_CONFIG
+#endif
 #if DRIVE_SYSTEM==1 || DRIVE_SYSTEM==2
 #define XY_GANTRY
 #endif
 
-//Step to split a cirrcle in small Lines 
-#ifndef MM_PER_ARC_SEGMENT
-#define MM_PER_ARC_SEGMENT 1
-#define MM_PER_ARC_SEGMENT_BIG 3
+// Number of PlanLine entries, a divisor of MOVE_CACHE_SIZE
+#ifndef PLANNER_CACHE_SIZE
+#define PLANNER_CACHE_SIZE MOVE_CACHE_SIZE
+#endif
+#ifndef MAX_STEPPER_LOOPS
+#if ALLOW_QUADSTEPPING
+#define MAX_STEPPER_LOOPS 4
 #else
-#define MM_PER_ARC_SEGMENT_BIG MM_PER_ARC_SEGMENT
+#define MAX_STEPPER_LOOPS 2
+#endif
+#endif
+#ifndef STEPPER_LOOP_SPREAD
+#define STEPPER_LOOP_SPREAD 0
+#endif
+#if !defined(UNIFIED_EXTRUDER_STEPPING) || !(USE_OPS==1 || defined(USE_ADVANCE))
+#undef UNIFIED_EXTRUDER_STEPPING
+#define UNIFIED_EXTRUDER_STEPPING 0
+#endif
+#ifndef ENDSTOP_INTERRUPTS
+#define ENDSTOP_INTERRUPTS 0
+#endif
+#ifndef ENDSTOP_DEBOUNCE
+#define ENDSTOP_DEBOUNCE 1
+#endif
+#ifndef RAMP_TABLE_SIZE
+#define RAMP_TABLE_SIZE 0
+#endif
+#ifndef STEPPER_PORT_BATCHING
+#define STEPPER_PORT_BATCHING 0
+#endif
+#ifndef SPLIT_STEP_PULSE
+#define SPLIT_STEP_PULSE 0
+#endif
+#ifndef HALFSTEPPING
+#define HALFSTEPPING 1
+#endif
+#ifndef DELTA_INCREMENTAL_IK
+#define DELTA_INCREMENTAL_IK 0
+#endif
+#ifndef DELTA_JIT_SEGMENTS
+#define DELTA_JIT_SEGMENTS 0
+#endif
+#ifndef DELTA_ROD_CORRECTION
+#define DELTA_ROD_CORRECTION {0,0,0}
+#endif
+#ifndef DELTA_RADIUS_CORRECTION
+#define DELTA_RADIUS_CORRECTION {0,0,0}
+#endif
+#ifndef DELTA_ANGLE_CORRECTION
+#define DELTA_ANGLE_CORRECTION {0,0,0}
+#endif
+#ifndef DELTA_ADAPTIVE_SEGMENTS
+#define DELTA_ADAPTIVE_SEGMENTS 0
+#endif
+#ifndef DELTA_SEGMENT_MAX_ERROR
+#define DELTA_SEGMENT_MAX_ERROR 0.01
+#endif
+#ifndef STEP_TIMING_MONITOR
+#define STEP_TIMING_MONITOR 0
+#endif
+#if !defined(STEP_OVERRUN_SLOWDOWN) || !STEP_TIMING_MONITOR
+#undef STEP_OVERRUN_SLOWDOWN
+#define STEP_OVERRUN_SLOWDOWN 0
+#endif
+// Buffered move time in ms below which short moves are slowed down
+#ifndef MOVE_BUFFER_HORIZON
+#define MOVE_BUFFER_HORIZON 100
+#endif
+#define BUFFER_HORIZON_TICKS ((long)MOVE_BUFFER_HORIZON*(long)(F_CPU/1000))
+// Maximum distance in mm between arc and the lines replacing it
+#ifndef ARC_MAX_CHORD_ERROR
+#define ARC_MAX_CHORD_ERROR 0.01
+#endif
+// Maximum number of arc segments per second of move time
+#ifndef ARC_SEGMENTS_PER_SECOND
+#define ARC_SEGMENTS_PER_SECOND 100
 #endif
 //After this count of steps a new SIN / COS caluclation is startet to correct the circle interpolation
 #define N_ARC_CORRECTION 25
-#if CPU_ARCH==ARCH_AVR
+#if CPU_ARCH==ARCH_AVR || CPU_ARCH==ARCH_HOST
 #include <avr/io.h>
 #else
 #define PROGMEM
@@ -232,7 +317,7 @@ usage or for seraching for memory induced errors. Switch it off for production,
 #define COMPAT_PRE1
 #endif
 #include "gcode.h"
-#if CPU_ARCH==ARCH_AVR
+#if CPU_ARCH==ARCH_AVR || CPU_ARCH==ARCH_HOST
 #include "fastio.h"
 #else
 #define	READ(IO)  digitalRead(IO)
@@ -480,6 +565,79 @@ inline void extruder_unstep() {
   }
 #endif
 }
+#if STEPPER_PORT_BATCHING
+#define STEP_PORT(IO) _STEP_PORT(IO)
+#define _STEP_PORT(IO) DIO ## IO ## _WPORT
+#define STEP_MASK(IO) _STEP_MASK(IO)
+#define _STEP_MASK(IO) MASK(DIO ## IO ## _PIN)
+/** True if both pins are on the same port. The port addresses are constants, so the compiler
+removes all code for port combinations that don't exist on the board. */
+#define STEP_SAME_PORT(a,b) (&STEP_PORT(a)==&STEP_PORT(b))
+/** Delta printers step the extruder outside the delta segment code, so only cartesian printers
+with a single extruder can include it. */
+#define STEP_BATCH_E (NUM_EXTRUDER==1 && DRIVE_SYSTEM!=3)
+/** Remembers a step for a pin in its mask. step_ports_high writes the collected masks. */
+#define STEP_HIGH(pin,mask) mask = STEP_MASK(pin)
+/** \brief Sets the collected step pins with one write per port.
+
+mx, my, mz and me are the step masks of the axes that step in this loop or 0.
+Call this function only, if interrupts are disabled.
+*/
+inline void step_ports_high(byte mx,byte my,byte mz,byte me) {
+  STEP_PORT(X_STEP_PIN) |= mx | (STEP_SAME_PORT(Y_STEP_PIN,X_STEP_PIN) ? my : 0) | (STEP_SAME_PORT(Z_STEP_PIN,X_STEP_PIN) ? mz : 0)
+#if STEP_BATCH_E
+    | (STEP_SAME_PORT(EXT0_STEP_PIN,X_STEP_PIN) ? me : 0)
+#endif
+    ;
+  if(!STEP_SAME_PORT(Y_STEP_PIN,X_STEP_PIN))
+    STEP_PORT(Y_STEP_PIN) |= my | (STEP_SAME_PORT(Z_STEP_PIN,Y_STEP_PIN) ? mz : 0)
+#if STEP_BATCH_E
+      | (STEP_SAME_PORT(EXT0_STEP_PIN,Y_STEP_PIN) ? me : 0)
+#endif
+      ;
+  if(!STEP_SAME_PORT(Z_STEP_PIN,X_STEP_PIN) && !STEP_SAME_PORT(Z_STEP_PIN,Y_STEP_PIN))
+    STEP_PORT(Z_STEP_PIN) |= mz
+#if STEP_BATCH_E
+      | (STEP_SAME_PORT(EXT0_STEP_PIN,Z_STEP_PIN) ? me : 0)
+#endif
+      ;
+#if STEP_BATCH_E
+  if(!STEP_SAME_PORT(EXT0_STEP_PIN,X_STEP_PIN) && !STEP_SAME_PORT(EXT0_STEP_PIN,Y_STEP_PIN) && !STEP_SAME_PORT(EXT0_STEP_PIN,Z_STEP_PIN))
+    STEP_PORT(EXT0_STEP_PIN) |= me;
+#endif
+}
+/** \brief Sets the x, y and z step pins to low with one write per port.
+
+me is the step mask of the extruder, if it was set by step_ports_high, or 0.
+Call this function only, if interrupts are disabled.
+*/
+inline void step_ports_low(byte me) {
+  STEP_PORT(X_STEP_PIN) &= ~(STEP_MASK(X_STEP_PIN) | (STEP_SAME_PORT(Y_STEP_PIN,X_STEP_PIN) ? STEP_MASK(Y_STEP_PIN) : 0)
+    | (STEP_SAME_PORT(Z_STEP_PIN,X_STEP_PIN) ? STEP_MASK(Z_STEP_PIN) : 0)
+#if STEP_BATCH_E
+    | (STEP_SAME_PORT(EXT0_STEP_PIN,X_STEP_PIN) ? me : 0)
+#endif
+    );
+  if(!STEP_SAME_PORT(Y_STEP_PIN,X_STEP_PIN))
+    STEP_PORT(Y_STEP_PIN) &= ~(STEP_MASK(Y_STEP_PIN) | (STEP_SAME_PORT(Z_STEP_PIN,Y_STEP_PIN) ? STEP_MASK(Z_STEP_PIN) : 0)
+#if STEP_BATCH_E
+      | (STEP_SAME_PORT(EXT0_STEP_PIN,Y_STEP_PIN) ? me : 0)
+#endif
+      );
+  if(!STEP_SAME_PORT(Z_STEP_PIN,X_STEP_PIN) && !STEP_SAME_PORT(Z_STEP_PIN,Y_STEP_PIN))
+    STEP_PORT(Z_STEP_PIN) &= ~(STEP_MASK(Z_STEP_PIN)
+#if STEP_BATCH_E
+      | (STEP_SAME_PORT(EXT0_STEP_PIN,Z_STEP_PIN) ? me : 0)
+#endif
+      );
+#if STEP_BATCH_E
+  if(!STEP_SAME_PORT(EXT0_STEP_PIN,X_STEP_PIN) && !STEP_SAME_PORT(EXT0_STEP_PIN,Y_STEP_PIN) && !STEP_SAME_PORT(EXT0_STEP_PIN,Z_STEP_PIN))
+    STEP_PORT(EXT0_STEP_PIN) &= ~me;
+#endif
+}
+#else
+#define STEP_HIGH(pin,mask) WRITE(pin,HIGH)
+#endif
 /** \brief Activates the extruder stepper and sets the direction. */
 inline void extruder_set_direction(byte dir) {  
 #if NUM_EXTRUDER==1
@@ -584,9 +742,18 @@ extern void move_steps(long x,long y,long z,long e,float feedrate,bool waitEnd,b
 extern void queue_move(byte check_endstops,byte pathOptimize);
 #if DRIVE_SYSTEM==3
 extern byte calculate_delta(long cartesianPosSteps[], long deltaPosSteps[]);
+extern byte calculate_cartesian(long deltaPosSteps[], long cartesianPosSteps[]);
+extern long delta_endstop_height();
+#if DELTA_INCREMENTAL_IK
+extern long delta_sqrt(long val,long *root);
+#endif
+extern void delta_update_geometry();
+extern void delta_reset_corrections();
 extern void set_delta_position(long xaxis, long yaxis, long zaxis);
 extern float rodMaxLength;
-extern void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop);
+extern void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop, byte wait);
+extern void delta_split_continue(byte wait);
+extern byte delta_split_pending;
 #ifdef SOFTWARE_LEVELING
 extern void calculate_plane(long factors[], long p1[], long p2[], long p3[]);
 extern float calc_zoffset(long factors[], long pointX, long pointY);
@@ -627,8 +794,88 @@ extern void current_control_init();
 extern void microstep_init();
 extern void print_temperatures();
 extern void check_mem();
+#ifdef DEBUG_PLANNER_STATS
+#if CPU_ARCH==ARCH_HOST
+#define PLANNER_STATS_CLOCK() host_main_ns()
+#define PLANNER_STATS_UNIT "ns"
+#else
+#define PLANNER_STATS_CLOCK() micros()
+#define PLANNER_STATS_UNIT "us"
+#endif
+typedef struct {
+  unsigned long moves;            ///< Lines planned since reset
+  unsigned long planTime;         ///< Sum of planning times in PLANNER_STATS_UNIT
+  long maxPlanTime;               ///< Longest planning time of a line in PLANNER_STATS_UNIT
+  unsigned long slowdowns;        ///< Lines slowed down because the buffered time was low
+  unsigned long occupancy[MOVE_CACHE_SIZE+1]; ///< Histogram of lines_count when a line is added
+} PlannerStats;
+extern PlannerStats planner_stats;
+extern unsigned long planner_stats_mark;
+extern long planner_stats_line;
+extern void planner_stats_charge(byte lineEnd);
+extern void planner_stats_report(byte reset);
+/** Starts timing a call of queue_move or split_delta_move. */
+#define PLANNER_STATS_BEGIN {planner_stats_mark = PLANNER_STATS_CLOCK();planner_stats_line = 0;}
+/** Adds the time since the last mark to the planning time, before waiting or after extra work. */
+#define PLANNER_STATS_CHARGE planner_stats_charge(0)
+/** Continues timing after a wait. */
+#define PLANNER_STATS_RESUME planner_stats_mark = PLANNER_STATS_CLOCK()
+/** Adds the time since the last mark and ends the line. */
+#define PLANNER_STATS_LINE_END planner_stats_charge(1)
+#else
+#define PLANNER_STATS_BEGIN {}
+#define PLANNER_STATS_CHARGE {}
+#define PLANNER_STATS_RESUME {}
+#define PLANNER_STATS_LINE_END {}
+#endif
+#ifdef DEBUG_STEP_TRACE
+#ifndef STEP_TRACE_SIZE
+#define STEP_TRACE_SIZE 128
+#endif
+typedef struct {
+  unsigned long tick;             ///< CPU cycles since the trace was started
+  byte pins;                      ///< Bit 0-3 step pins x,y,z,e, bit 4-7 direction pins x,y,z,e
+} StepTraceEntry;
+extern void step_trace_report(byte reset);
+#endif
+#ifdef DEBUG_ISR_PROFILER
+#define ISR_PHASE_NEW_LINE 0
+#define ISR_PHASE_ENDSTOPS 1
+#define ISR_PHASE_BRESENHAM 2
+#define ISR_PHASE_SPEED 3
+#define ISR_PHASE_LINE_END 4
+#define ISR_PHASES 5
+#define ISR_LATENESS_BUCKETS 8
+typedef struct {
+  unsigned long count[ISR_PHASES];   ///< Samples per phase, halved together with sum to avoid overflows
+  unsigned long sum[ISR_PHASES];     ///< Sum of cycles per phase
+  unsigned int minCycles[ISR_PHASES];
+  unsigned int maxCycles[ISR_PHASES];
+  unsigned long lateness[ISR_LATENESS_BUCKETS]; ///< Cycles from compare match to work start, bucket i < 64<<i
+} IsrProfile;
+extern IsrProfile isr_profile;
+extern unsigned int isr_profile_mark;
+extern void isr_profile_phase(byte phase);
+extern void isr_profile_report(byte reset);
+#define ISR_PROFILE_PHASE(phase) isr_profile_phase(phase)
+#else
+#define ISR_PROFILE_PHASE(phase)
+#endif
+extern unsigned long buffer_starvations;
+extern unsigned long buffer_slowdowns;
+extern void buffer_stats_report(byte reset);
+#if STEP_TIMING_MONITOR
+extern volatile byte step_overrun_slowdown;
+extern void step_timing_report(byte reset);
+#endif
 #if ARC_SUPPORT
 extern void mc_arc(float *position, float *target, float *offset, float radius, uint8_t isclockwise);
+extern void mc_arc_continue(byte wait);
+extern byte arc_pending;
+#endif
+#if MOVE_COALESCING
+extern void coalesce_move();
+extern void coalesce_flush();
 #endif
 
 #define PRINTER_FLAG0_STEPPER_DISABLED      1
@@ -665,7 +912,10 @@ typedef struct {
   long countZSteps;					///< Count of steps from last position reset
 #endif
   long currentDeltaPositionSteps[4];
-  long maxDeltaPositionSteps;
+  long maxDeltaPositionSteps[3];    ///< Tower positions at the top, used as soft endstop
+  float deltaRodCorrection[3];      ///< Rod length correction per tower in mm
+  float deltaRadiusCorrection[3];   ///< Radius correction per tower in mm
+  float deltaAngleCorrection[3];    ///< Angle correction per tower in degree
 #endif
 #ifdef SOFTWARE_LEVELING
   long levelingP1[3];
@@ -737,7 +987,8 @@ extern PrinterState printer_state;
 #define FLAG_CHECK_ENDSTOPS 16
 #define FLAG_SKIP_ACCELERATING 32
 #define FLAG_SKIP_DEACCELERATING 64
-#define FLAG_BLOCKED 128
+/** Ramp intervals are taken from accelInterval/decelInterval */
+#define FLAG_RAMP_TABLE 128
 
 /** Are the step parameter computed */
 #define FLAG_JOIN_STEPPARAMS_COMPUTED 1
@@ -757,19 +1008,98 @@ extern PrinterState printer_state;
 #define FLAG_JOIN_WAIT_EXTRUDER_DOWN 128
 // Printing related data
 #if DRIVE_SYSTEM==3
-// Allow the delta cache to store segments for every line in line cache. Beware this gets big ... fast.
-// MAX_DELTA_SEGMENTS_PER_LINE * 
-#define DELTA_CACHE_SIZE (MAX_DELTA_SEGMENTS_PER_LINE * MOVE_CACHE_SIZE)
+#if DELTA_JIT_SEGMENTS
+// Only two lines have segments, so they can hold the steps of any move
+typedef unsigned long delta_steps_t;
+#define DELTA_MAX_SEGMENT_STEPS 0x7fffffffL
+#else
+typedef unsigned int delta_steps_t;
+#define DELTA_MAX_SEGMENT_STEPS 65535
+#endif
 typedef struct { 
 	byte dir; 									///< Direction of delta movement.
-	unsigned int deltaSteps[3]; 				///< Number of steps in move.
+	delta_steps_t deltaSteps[3]; 				///< Number of steps in move.
 } DeltaSegment;
+#if (!defined(DELTA_SEGMENT_RAM) || DELTA_SEGMENT_RAM==0) && DELTA_JIT_SEGMENTS
+// Segments are generated one line ahead of the stepper interrupt
+#define DELTA_CACHE_SIZE (2 * MAX_DELTA_SEGMENTS_PER_LINE)
+#elif !defined(DELTA_SEGMENT_RAM) || DELTA_SEGMENT_RAM==0
+// Allow the delta cache to store segments for every line in line cache. Beware this gets big ... fast.
+// MAX_DELTA_SEGMENTS_PER_LINE * 
+#define DELTA_CACHE_SIZE (MAX_DELTA_SEGMENTS_PER_LINE * MOVE_CACHE_SIZE)
+#else
+#define DELTA_CACHE_SIZE ((int)(DELTA_SEGMENT_RAM/sizeof(DeltaSegment)))
+#endif
 extern DeltaSegment segments[];					// Delta segment cache
 extern unsigned int delta_segment_write_pos; 	// Position where we write the next cached delta move
 extern volatile unsigned int delta_segment_count; // Number of delta moves cached 0 = nothing in cache
+extern unsigned int delta_segment_peak;			// Largest delta_segment_count since the last report reset
+extern unsigned long delta_segment_waits;		// Lines that had to wait for free delta segments
+extern void delta_segment_report(byte reset);
+#if DELTA_JIT_SEGMENTS
+extern byte delta_gen_lines;
+extern unsigned long delta_segment_stalls;
+extern void delta_generate_segments();
+#define DELTA_GENERATE_SEGMENTS delta_generate_segments()
+#endif
+#endif
+#ifndef DELTA_GENERATE_SEGMENTS
+#define DELTA_GENERATE_SEGMENTS
+#endif
+#if DRIVE_SYSTEM==3 || ARC_SUPPORT
+/** Lines with equal moveID are parts of one move (split delta line or arc) and need no junction speed computation. */
+#define USE_MOVE_ID
 extern byte lastMoveID;
 #endif
-typedef struct { // RAM usage: 24*4+15 = 113 Byte
+#ifdef FIXED_POINT_PLANNER
+/** Planner speeds in mm/s*16, squared speeds in mm^2/s^2*256 */
+#define PLANNER_SPEED_SHIFT 4
+typedef unsigned int planspeed_t;
+typedef unsigned long planspeed2_t;
+inline planspeed_t PLANNER_SPEED(float x) {return x<4095.0 ? (planspeed_t)(x*16.0+0.5) : 65520;}
+inline planspeed2_t PLANNER_SPEED2(float x) {return x<16777215.0 ? (planspeed2_t)(x*256.0) : 0xffffffff;}
+#define PLANNER_TO_FLOAT(x) ((float)(x)*0.0625)
+#define PLANNER2_TO_FLOAT(x) ((float)(x)*0.00390625)
+#define PLANNER_FULL_SPEED(p) ((p)->fullSpeedFixed)
+#else
+typedef float planspeed_t;
+typedef float planspeed2_t;
+#define PLANNER_SPEED(x) (x)
+#define PLANNER_SPEED2(x) (x)
+#define PLANNER_TO_FLOAT(x) (x)
+#define PLANNER2_TO_FLOAT(x) (x)
+#define PLANNER_FULL_SPEED(p) ((p)->fullSpeed)
+#endif
+/** Planner part of a line.
+
+Only the path planner and updateStepsParameter need this data. Once a line has a fixed end speed and
+its step parameter are computed, the stepper interrupt only uses the PrintLine part. The planner data
+of lines[i] is stored in PLAN_LINE(i). With PLANNER_CACHE_SIZE<MOVE_CACHE_SIZE an entry is shared by
+several lines and gets released, before it is reused for a new line.
+*/
+typedef struct { // RAM usage: 11*4 = 44 Byte, with FIXED_POINT_PLANNER 8*4+4*2 = 40 Byte
+  float speedX;                   ///< Speed in x direction at fullInterval in mm/s
+  float speedY;                   ///< Speed in y direction at fullInterval in mm/s
+  float speedZ;                   ///< Speed in z direction at fullInterval in mm/s
+  float speedE;                   ///< Speed in E direction at fullInterval in mm/s
+#if JUNCTION_MODEL==1
+  float unitX;                    ///< Normalized x direction of move
+  float unitY;                    ///< Normalized y direction of move
+  float unitZ;                    ///< Normalized z direction of move
+#endif
+  float fullSpeed;                ///< Desired speed mm/s
+  float invFullSpeed;             ///< 1.0/fullSpeed for fatser computation
+#ifdef FIXED_POINT_PLANNER
+  planspeed_t fullSpeedFixed;     ///< fullSpeed in planner units
+#endif
+  planspeed2_t acceleration;      ///< Real 2.0*distanceÜacceleration mm²/s²
+  planspeed_t maxJunctionSpeed;   ///< Max. junction speed between this and next segment
+  planspeed_t startSpeed;         ///< Staring speed in mm/s
+  planspeed_t endSpeed;           ///< Exit speed in mm/s
+  float distance;
+} PlanLine;
+
+typedef struct { // RAM usage for delta with OPS and advance: 15*4+7*2+7 = 81 Byte + ramp tables
   byte primaryAxis;
   volatile byte flags;
   long timeInTicks;
@@ -778,22 +1108,20 @@ typedef struct { // RAM usage: 24*4+15 = 113 Byte
   byte dir;                       ///< Direction of movement. 1 = X+, 2 = Y+, 4= Z+, values can be combined.
   long delta[4];                  ///< Steps we want to move.
   long error[4];                  ///< Error calculation for Bresenham algorithm
-  float speedX;                   ///< Speed in x direction at fullInterval in mm/s
-  float speedY;                   ///< Speed in y direction at fullInterval in mm/s
-  float speedZ;                   ///< Speed in z direction at fullInterval in mm/s
-  float speedE;                   ///< Speed in E direction at fullInterval in mm/s
-  float fullSpeed;                ///< Desired speed mm/s
-  float invFullSpeed;             ///< 1.0/fullSpeed for fatser computation
-  float acceleration;             ///< Real 2.0*distanceÜacceleration mm²/s²
-  float maxJunctionSpeed;         ///< Max. junction speed between this and next segment
-  float startSpeed;               ///< Staring speed in mm/s
-  float endSpeed;                 ///< Exit speed in mm/s
-  float distance;
+#ifdef USE_MOVE_ID
+  byte moveID;							///< ID used to identify moves which are all part of the same line
+#endif
 #if DRIVE_SYSTEM==3
   byte numDeltaSegments;		  		///< Number of delta segments left in line. Decremented by stepper timer.
-  byte moveID;							///< ID used to identify moves which are all part of the same line
   int deltaSegmentReadPos; 	 			///< Pointer to next DeltaSegment
   long numPrimaryStepPerSegment;		///< Number of primary bresenham axis steps in each delta segment
+#if DELTA_JIT_SEGMENTS
+  long deltaCartStart[3];				///< Cartesian start position in steps for the segment generator
+  long deltaCartEnd[3];					///< Cartesian end position in steps
+  long deltaTowerStart[3];				///< Tower positions in steps at the start of the line
+  long deltaMaxSteps[3];				///< Top of the towers when the line was planned, the segments are clipped to it
+  volatile byte deltaSegmentsReady;		///< Set when all segments of the line are in the segment cache
+#endif
 #endif
   unsigned long fullInterval;     ///< interval at full speed in ticks/step.
   unsigned long stepsRemaining;   ///< Remaining steps, until move is finished
@@ -804,6 +1132,22 @@ typedef struct { // RAM usage: 24*4+15 = 113 Byte
   unsigned int vMax;              ///< Maximum reached speed in steps/s.
   unsigned int vStart;            ///< Starting speed in steps/s.
   unsigned int vEnd;              ///< End speed in steps/s
+#ifdef S_CURVE_ACCELERATION
+  unsigned int accelDV;           ///< Speed gained during acceleration in steps/s
+  unsigned int decelDV;           ///< Speed lost during deceleration in steps/s
+  unsigned long accelRampInv;     ///< 2^24/accelDV, maps linear ramp speed to ramp fraction
+  unsigned long decelRampInv;     ///< 2^24/decelDV
+#endif
+#if RAMP_TABLE_SIZE>0
+  byte accelShift;                ///< Each accelInterval entry covers 1<<accelShift steps
+  byte decelShift;                ///< Each decelInterval entry covers 1<<decelShift steps
+  unsigned int accelInterval[RAMP_TABLE_SIZE]; ///< Ticks per step while accelerating, index stepNumber>>accelShift
+  unsigned int decelInterval[RAMP_TABLE_SIZE]; ///< Ticks per step while decelerating, index stepsRemaining>>decelShift
+#ifdef USE_ADVANCE
+  unsigned int accelSpeed[RAMP_TABLE_SIZE]; ///< Speed in steps/s for accelInterval entries
+  unsigned int decelSpeed[RAMP_TABLE_SIZE]; ///< Speed in steps/s for decelInterval entries
+#endif
+#endif
 #ifdef USE_ADVANCE
 #ifdef ENABLE_QUADRATIC_ADVANCE
   long advanceRate;               ///< Advance steps at full speed
@@ -820,23 +1164,81 @@ typedef struct { // RAM usage: 24*4+15 = 113 Byte
   long totalStepsRemaining;
 #endif
 } PrintLine;
+// Halfstep state of a line, constant 0 without HALFSTEPPING so the switching code is optimized away
+#if HALFSTEPPING
+#define LINE_HALFSTEP(p) ((p)->halfstep)
+#else
+#define LINE_HALFSTEP(p) 0
+#endif
 
 extern PrintLine lines[];
+extern PlanLine plan_lines[];
+#define PLAN_LINE(idx) (&plan_lines[(byte)(idx)%PLANNER_CACHE_SIZE])
 extern byte lines_write_pos; // Position where we write the next cached line move
 extern byte lines_pos; // Position for executing line movement
 extern volatile byte lines_count; // Number of lines cached 0 = nothing to do
+extern volatile long lines_ticks; // Sum of timeInTicks of all cached lines
+/* Handoff between path planner and stepper interrupt. Lines from lines_pos up to lines_commit_pos are
+committed and never changed again by the planner. lines_commit_seq-lines_done_seq is the number of
+committed lines not finished yet. The planner only advances lines_commit_pos while planner_busy is set,
+the stepper interrupt only when it is not set. Before planning, the planner commits lines for at least 4500 ticks
+per cache entry. If the interrupt still runs out of committed lines, it retries every 500 ticks and counts this
+in planner_stalls. */
+extern volatile byte lines_commit_pos;
+extern volatile byte lines_commit_seq;
+extern volatile byte lines_done_seq;
+extern volatile byte planner_busy;
+extern volatile unsigned long planner_stalls;
+#if CPU_ARCH==ARCH_HOST
+/** Lets host tests keep the planner busy, see preemptstress.cpp. */
+#define PLANNER_BUSY_HOOK() {if(host_planner_hook) host_planner_hook();}
+#else
+#define PLANNER_BUSY_HOOK() {}
+#endif
+#define ENDSTOP_X_MIN_BIT 1
+#define ENDSTOP_Y_MIN_BIT 2
+#define ENDSTOP_Z_MIN_BIT 4
+#define ENDSTOP_X_MAX_BIT 8
+#define ENDSTOP_Y_MAX_BIT 16
+#define ENDSTOP_Z_MAX_BIT 32
+#if ENDSTOP_INTERRUPTS
+/** Endstops seen triggered by the pin change interrupt. The stepper interrupt clears released ones. */
+extern volatile byte endstop_latch;
+extern void endstop_interrupt_init();
+/** Test of an endstop in the stepper interrupt, endstop_hits is the result of endstop_check(). */
+#define ENDSTOP_HIT(bit,pin,inverting) (endstop_hits & (bit))
+#else
+#define ENDSTOP_HIT(bit,pin,inverting) (READ(pin) != (inverting))
+#endif
+#if SPLIT_STEP_PULSE
+/** Step pins left high by the last stepper interrupt. 1 = x, y and z, 2 = extruder */
+extern volatile byte step_pulse_pending;
+/** Set while the extruder interrupt left its step pin high */
+extern volatile byte extruder_pulse_pending;
+#endif
+#if STEPPER_LOOP_SPREAD
+/** Stepper interrupt calls since the last speed computation, 0 if the next call computes the speed */
+extern byte stepper_loop_count;
+#endif
 extern byte printmoveSeen;
 extern long baudrate;
 #if OS_ANALOG_INPUTS>0
 // Get last result for pin x
 extern volatile uint osAnalogInputValues[OS_ANALOG_INPUTS];
 #endif
+#if CPU_ARCH==ARCH_HOST
+#define BEGIN_INTERRUPT_PROTECTED {byte sreg=SREG;cli();
+#else
 #define BEGIN_INTERRUPT_PROTECTED {byte sreg=SREG;__asm volatile( "cli" ::: "memory" );
+#endif
 #define END_INTERRUPT_PROTECTED SREG=sreg;}
 #define ESCAPE_INTERRUPT_PROTECTED SREG=sreg;
+/** Keeps the compiler from moving memory accesses across this point */
+#define MEMORY_BARRIER() __asm volatile( "" ::: "memory" )
 
 #define SECONDS_TO_TICKS(s) (unsigned long)(s*(float)F_CPU)
 extern long CPUDivU2(unsigned int divisor);
+extern unsigned int isqrt32(unsigned long val);
 
 extern unsigned int counter_periodical;
 extern volatile byte execute_periodical;
@@ -918,7 +1320,7 @@ extern int waitRelax; // Delay filament relax at the end of print, could be a si
 #ifdef USE_OPS
 extern byte printmoveSeen;
 #endif
-extern void updateStepsParameter(PrintLine *p/*,byte caller*/);
+extern void updateStepsParameter(PrintLine *p,PlanLine *pl/*,byte caller*/);
 
 /** \brief Disable stepper motor for x direction. */
 inline void disable_x() {
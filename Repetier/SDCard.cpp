@@ -159,7 +159,6 @@ bool SDCard::showFilename(const uint8_t *name) {
 void  SDCard::lsRecursive(SdBaseFile *parent,byte level)
 {
   dir_t *p;
-  uint8_t cnt=0;
   char *oldpathend = pathend;
   char filename[13];
   parent->rewind();
@@ -2066,8 +2066,8 @@ bool SdBaseFile::rmRfStar() {
       }
     }
     // position to next entry if required
-    if (curPosition_ != (32*(index + 1))) {
-      if (!seekSet(32*(index + 1))) {
+    if (curPosition_ != (32UL*(index + 1))) {
+      if (!seekSet(32UL*(index + 1))) {
         DBG_FAIL_MACRO;
         goto fail;
       }
@@ -2659,6 +2659,7 @@ static void spiSendBlock(uint8_t token, const uint8_t* buf) {
 //==============================================================================
 // CRC functions
 //------------------------------------------------------------------------------
+#if USE_SD_CRC
 static uint8_t CRC7(const uint8_t* data, uint8_t n) {
   uint8_t crc = 0;
   for (uint8_t i = 0; i < n; i++) {
@@ -2732,6 +2733,7 @@ static uint16_t CRC_CCITT(const uint8_t* data, uint16_t n) {
   return crc;
 }
 #endif  //  CRC_CCITT
+#endif  // USE_SD_CRC
 //==============================================================================
 // Sd2Card member functions
 //------------------------------------------------------------------------------
@@ -3016,6 +3018,8 @@ bool Sd2Card::readData(uint8_t* dst, uint16_t count) {
     error(SD_CARD_ERROR_READ_CRC);
     goto fail;
   }
+#else  // USE_SD_CRC
+  (void)crc; // The two crc bytes must be read anyway
 #endif  // USE_SD_CRC
 
   chipSelectHigh();
@@ -3711,14 +3715,14 @@ int SdFatUtil::FreeRam() {
   extern int  __bss_end;
   extern int* __brkval;
   int free_memory;
-  if (reinterpret_cast<int>(__brkval) == 0) {
+  if (reinterpret_cast<intptr_t>(__brkval) == 0) {
     // if no heap use from end of bss section
-    free_memory = reinterpret_cast<int>(&free_memory)
-                  - reinterpret_cast<int>(&__bss_end);
+    free_memory = reinterpret_cast<intptr_t>(&free_memory)
+                  - reinterpret_cast<intptr_t>(&__bss_end);
   } else {
     // use from top of stack to heap
-    free_memory = reinterpret_cast<int>(&free_memory)
-                  - reinterpret_cast<int>(__brkval);
+    free_memory = reinterpret_cast<intptr_t>(&free_memory)
+                  - reinterpret_cast<intptr_t>(__brkval);
   }
   return free_memory;
 }
@@ -807,7 +807,6 @@ bool gcode_parse_binary(GCode *code,byte *buffer) {
    unsigned int sum1=0,sum2=0; // for fletcher-16 checksum
    // first do fletcher-16 checksum tests see
    // http://en.wikipedia.org/wiki/Fletcher's_checksum
-   byte i=0;
    byte *p = buffer;
    byte len = gcode_binary_size-2;
    while (len) {
@@ -870,7 +869,6 @@ inline long gcode_value_long(char *s) { return (strtol(s, NULL, 10)); }
   Converts a ascii GCode line into a GCode structure.
 */
 bool gcode_parse_ascii(GCode *code,char *line,bool fromSerial) {
-  bool has_checksum = false;
   char *pos;
   code->params = 0;
   code->params2 = 0;
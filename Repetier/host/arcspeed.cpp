@@ -0,0 +1,86 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Speed of arc segments. mc_arc limits the feedrate of an arc to sqrt(acceleration*radius). Full circles
+  are queued faster than the printer can follow, so arc segments are queued from loop() while the move
+  cache is full. The arcs variant has a small delta segment ring, so the lines of a segment are queued
+  from loop() while they wait for free segments. The full speed of every queued line is
+  recorded and must not exceed the limit of the arc by more than 1%. ARC_SEGMENTS_PER_SECOND must only
+  lengthen the segments at the limited speed, so each arc needs at least as many lines as the chord error
+  or that limit demand.
+
+  Usage: arcspeed [radius_mm [feedrate_mm_per_min]]
+
+  Returns 1 if a line is faster than the limit of the arc, the arcs have too few lines or the moves time out.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+static byte seen_pos;
+static unsigned long seen_lines;
+static float fastest;
+
+/** Records the full speed of the lines queued since the last call. */
+static void check_new_lines() {
+  while(seen_pos!=lines_write_pos) {
+    float speed = PLANNER_TO_FLOAT(PLANNER_FULL_SPEED(PLAN_LINE(seen_pos)));
+    if(speed>fastest) fastest = speed;
+    seen_lines++;
+    if(++seen_pos>=MOVE_CACHE_SIZE) seen_pos = 0;
+  }
+}
+
+int main(int argc,char **argv) {
+  double radius = (argc>1 ? atof(argv[1]) : 10);
+  double feedrate = (argc>2 ? atof(argv[2]) : 12000);
+  host_set_gcode("G28\nG90\nG1 Z5 F6000");
+  host_start(false);
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  char gcode[2000],*pos = gcode;
+  pos += sprintf(pos,"G1 X%.3f Y0 F3000\n",radius);
+  for(int i=0;i<5;i++)
+    pos += sprintf(pos,"G2 X%.3f Y0 I%.3f J0 F%.0f\n",radius,-radius,feedrate);
+  host_set_gcode(gcode);
+  seen_pos = lines_write_pos;
+  host_timer1_prehook = check_new_lines;
+  bool finished = host_run(F_CPU*600ULL);
+  host_timer1_prehook = 0;
+  check_new_lines();
+  double limit = sqrt(min(max_acceleration_units_per_sq_second[0],max_acceleration_units_per_sq_second[1])*radius);
+  if(limit>feedrate/60) limit = feedrate/60;
+  double travel = 2*M_PI*radius;
+  double segments = ceil(travel/(2*sqrt(ARC_MAX_CHORD_ERROR*(2*radius-ARC_MAX_CHORD_ERROR))));
+  double rateSegments = ceil(travel*ARC_SEGMENTS_PER_SECOND/limit);
+  if(segments>rateSegments) segments = rateSegments;
+  printf("Lines: %lu, fastest line %.2f mm/s, arc limit %.2f mm/s, %.0f lines per arc\n",seen_lines,fastest,limit,segments);
+  if(!finished) {
+    fprintf(stderr,"Timeout, moves not finished\n");
+    return 1;
+  }
+  if(fastest>limit*1.01) { // Distances of the lines are rounded to steps
+    fprintf(stderr,"Line faster than the arc limit\n");
+    return 1;
+  }
+  if(seen_lines<5*segments) {
+    fprintf(stderr,"Arcs split into less than %.0f lines\n",segments);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Move coalescing test. Sends short travel segments of an arc with large radius through coalesce_move,
+  as G1 does, and records the corners of the queued moves. Every point of the arc must be at most
+  MOVE_COALESCE_MAX_DEVIATION away from the queued moves and the moves must end at the last point.
+
+  Usage: coalescetest [radius_mm [length_mm [segment_mm]]]
+
+  Defaults are 2000 mm radius, 100 mm length and 3 mm segments. Shorter segments have more direction
+  noise from the rounding to steps, so MOVE_COALESCE_MAX_ANGLE stops merging before the deviation does.
+
+  Returns 1 if a point is too far away or less than half of the segments were merged.
+*/
+#include <vector>
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+extern long coalesce_start[4];
+extern byte coalesce_pending;
+
+struct Point {
+  double x,y;
+};
+
+/** Distance in steps of p from the segment a-b. */
+static double distance(const Point &p,const Point &a,const Point &b) {
+  double dx = b.x-a.x,dy = b.y-a.y;
+  double l = dx*dx+dy*dy;
+  double t = l>0 ? ((p.x-a.x)*dx+(p.y-a.y)*dy)/l : 0;
+  if(t<0) t = 0;
+  if(t>1) t = 1;
+  double ex = a.x+t*dx-p.x,ey = a.y+t*dy-p.y;
+  return sqrt(ex*ex+ey*ey);
+}
+
+int main(int argc,char **argv) {
+  double radius = argc>1 ? atof(argv[1]) : 2000;
+  double length = argc>2 ? atof(argv[2]) : 100;
+  double segment = argc>3 ? atof(argv[3]) : 3;
+  host_set_gcode("G28\nG90\nG92 E0\nG1 X0 Y0 Z5 F6000\n");
+  host_start(false);
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  printer_state.feedrate = 40;
+  std::vector<Point> points,corners;
+  Point p;
+  p.x = printer_state.currentPositionSteps[0];
+  p.y = printer_state.currentPositionSteps[1];
+  points.push_back(p);
+  long lastStart[2] = {(long)p.x,(long)p.y};
+  corners.push_back(p);
+  for(int i=1;i*segment<=length;i++) {
+    double a = i*segment/radius;
+    printer_state.destinationSteps[0] = lround(radius*sin(a)*axis_steps_per_unit[0]);
+    printer_state.destinationSteps[1] = lround(radius*(1-cos(a))*axis_steps_per_unit[1]);
+    printer_state.destinationSteps[2] = printer_state.currentPositionSteps[2];
+    printer_state.destinationSteps[3] = printer_state.currentPositionSteps[3];
+    p.x = printer_state.destinationSteps[0];
+    p.y = printer_state.destinationSteps[1];
+    points.push_back(p);
+    coalesce_move();
+    // A new held back move starts at the end of the queued one
+    if(coalesce_pending && (coalesce_start[0]!=lastStart[0] || coalesce_start[1]!=lastStart[1])) {
+      lastStart[0] = coalesce_start[0];
+      lastStart[1] = coalesce_start[1];
+      Point c = {(double)lastStart[0],(double)lastStart[1]};
+      corners.push_back(c);
+    }
+  }
+  coalesce_flush();
+  wait_until_end_of_move();
+  corners.push_back(points.back());
+  // Points and corners are in order, each point belongs to the first move not ending before it
+  double maxDeviation = 0;
+  size_t c = 0;
+  for(size_t i=0;i<points.size();i++) {
+    while(c+2<corners.size() && (points[i].x-corners[c+1].x)*(corners[c+1].x-corners[c].x)+
+          (points[i].y-corners[c+1].y)*(corners[c+1].y-corners[c].y)>0) c++;
+    double d = distance(points[i],corners[c],corners[c+1])*inv_axis_steps_per_unit[0];
+    if(d>maxDeviation) maxDeviation = d;
+  }
+  printf("Segments: %u, queued moves: %u\n",(unsigned)points.size()-1,(unsigned)corners.size()-1);
+  printf("Max. deviation [mm]: %.4f (limit %.4f)\n",maxDeviation,(double)MOVE_COALESCE_MAX_DEVIATION);
+  bool ok = maxDeviation<=MOVE_COALESCE_MAX_DEVIATION+1e-4 && corners.size()<points.size()/2;
+  if(!ok) fprintf(stderr,"Coalescing test failed\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+// Host build variant: delta segment ring for 60 segments only, so arc segments wait for free
+// segments and their lines are queued from the main loop.
+#undef DELTA_SEGMENT_RAM
+#define DELTA_SEGMENT_RAM 420
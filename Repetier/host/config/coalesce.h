@@ -0,0 +1,3 @@
+// Host build variant: move coalescing enabled
+#undef MOVE_COALESCING
+#define MOVE_COALESCING true
@@ -0,0 +1,5 @@
+// Host build variant: endstops watched by pin change interrupt with debouncing
+#undef ENDSTOP_INTERRUPTS
+#define ENDSTOP_INTERRUPTS 1
+#undef ENDSTOP_DEBOUNCE
+#define ENDSTOP_DEBOUNCE 3
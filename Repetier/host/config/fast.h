@@ -0,0 +1,3 @@
+// Host build variant: 1/32 microstepping, so fast moves need several steps per stepper interrupt
+#undef MICRO_STEPS
+#define MICRO_STEPS 32
@@ -0,0 +1,2 @@
+// Host build variant: integer path planner, compared with the float planner of the default variant
+#define FIXED_POINT_PLANNER
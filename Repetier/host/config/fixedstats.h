@@ -0,0 +1,3 @@
+// Host build variant: integer path planner with path planner statistics for planbench
+#include "stats.h"
+#include "fixed.h"
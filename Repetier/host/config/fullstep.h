@@ -0,0 +1,3 @@
+// Host build variant: no halfstepping, every stepper interrupt steps and updates the speed
+#undef HALFSTEPPING
+#define HALFSTEPPING 0
@@ -0,0 +1,5 @@
+// Host build variant: integer inverse kinematics and error bounded delta segments
+#undef DELTA_INCREMENTAL_IK
+#define DELTA_INCREMENTAL_IK 1
+#undef DELTA_ADAPTIVE_SEGMENTS
+#define DELTA_ADAPTIVE_SEGMENTS 1
@@ -0,0 +1,6 @@
+// Host build variant: delta segments generated one line ahead of the stepper interrupt.
+// 1/64 microstepping, so a tall z move has more than 65535 steps in one segment.
+#undef DELTA_JIT_SEGMENTS
+#define DELTA_JIT_SEGMENTS 1
+#undef MICRO_STEPS
+#define MICRO_STEPS 64
@@ -0,0 +1,4 @@
+// Host build variant: junction deviation cornering model, with path planner statistics for planbench
+#define DEBUG_PLANNER_STATS
+#undef JUNCTION_MODEL
+#define JUNCTION_MODEL 1
@@ -0,0 +1,3 @@
+// Host build variant: missed step deadline monitor enabled
+#undef STEP_TIMING_MONITOR
+#define STEP_TIMING_MONITOR 1
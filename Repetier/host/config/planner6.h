@@ -0,0 +1,5 @@
+// Host build variant: planner cache smaller than the move cache and no power of 2
+#undef MOVE_CACHE_SIZE
+#define MOVE_CACHE_SIZE 18
+#undef PLANNER_CACHE_SIZE
+#define PLANNER_CACHE_SIZE 6
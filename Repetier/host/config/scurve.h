@@ -0,0 +1,2 @@
+// Host build variant: jerk limited S-curve acceleration
+#define S_CURVE_ACCELERATION
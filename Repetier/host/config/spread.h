@@ -0,0 +1,6 @@
+// Host build variant: like fast, but the steps of a speed computation are spread over its interval
+#include "fast.h"
+#undef MAX_STEPPER_LOOPS
+#define MAX_STEPPER_LOOPS 8
+#undef STEPPER_LOOP_SPREAD
+#define STEPPER_LOOP_SPREAD 1
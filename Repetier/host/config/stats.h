@@ -0,0 +1,2 @@
+// Host build variant: path planner statistics for planbench
+#define DEBUG_PLANNER_STATS
@@ -0,0 +1,3 @@
+// Host build variant: advance/OPS extruder steps made by the stepper interrupt while a line is stepped.
+#undef UNIFIED_EXTRUDER_STEPPING
+#define UNIFIED_EXTRUDER_STEPPING 1
@@ -0,0 +1,163 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Round trip test of the per tower delta corrections. The corrections are set with M266 P1-3, stored in
+  EEPROM and read back. calculate_delta is then compared with a double precision model of the corrected
+  geometry at random positions: the tower heights must be the rounded down heights of the model, and the
+  position computed back from them with the model must be the start position. The float math truncates
+  the radicand and is within 0.01 steps, the integer math may be one step off with rounded tower positions.
+  After homing, all towers must be at the common endstop height and the position must be the one of the
+  model for these tower heights, which is off x=y=0 with the corrections.
+
+  Usage: deltageometry [points]
+
+  Defaults to 20000 points. Returns 1 if a check fails.
+*/
+#include "Reptier.h"
+#include "Eeprom.h"
+#include "harness.h"
+#include <stdio.h>
+
+/** Allowed distance in steps of the tower heights from [model height-1,model height]. */
+#if DELTA_INCREMENTAL_IK
+#define MAX_HEIGHT_ERROR 1.0 // Tower positions are rounded to whole steps
+#else
+#define MAX_HEIGHT_ERROR 0.01
+#endif
+/** Allowed distance in mm of the position computed back from the tower heights. */
+#define MAX_POSITION_ERROR 0.05
+
+static const double rod_correction[3] = {0.35,0,-0.2};
+static const double radius_correction[3] = {-0.42,0,0.15};
+static const double angle_correction[3] = {0.3,0,-0.25};
+static double tower_x[3],tower_y[3],rod2[3];
+
+/** Tower positions and squared rod lengths in steps of the double precision model. */
+static void model_geometry() {
+  const double angle[3] = {210,330,90};
+  for(int i=0;i<3;i++) {
+    double a = (angle[i]+angle_correction[i])*M_PI/180.0;
+    double radius = (DELTA_RADIUS+radius_correction[i])*(double)AXIS_STEPS_PER_MM;
+    double rod = (DELTA_DIAGONAL_ROD+rod_correction[i])*(double)AXIS_STEPS_PER_MM;
+    tower_x[i] = radius*cos(a);
+    tower_y[i] = radius*sin(a);
+    rod2[i] = rod*rod;
+  }
+}
+/** Tower heights in steps for a position in steps. */
+static void model_towers(const double pos[3],double h[3]) {
+  for(int i=0;i<3;i++) {
+    double dx = tower_x[i]-pos[0],dy = tower_y[i]-pos[1];
+    h[i] = sqrt(rod2[i]-dx*dx-dy*dy)+pos[2];
+  }
+}
+/** Position in steps for tower heights, Newton iterations started at pos. */
+static void model_position(const long h[3],double pos[3]) {
+  for(int iter=0;iter<20;iter++) {
+    double f[3],j[3][3];
+    for(int i=0;i<3;i++) {
+      double dx = pos[0]-tower_x[i],dy = pos[1]-tower_y[i],dz = pos[2]-h[i];
+      f[i] = dx*dx+dy*dy+dz*dz-rod2[i];
+      j[i][0] = 2*dx;j[i][1] = 2*dy;j[i][2] = 2*dz;
+    }
+    double det = j[0][0]*(j[1][1]*j[2][2]-j[1][2]*j[2][1])-j[0][1]*(j[1][0]*j[2][2]-j[1][2]*j[2][0])
+                +j[0][2]*(j[1][0]*j[2][1]-j[1][1]*j[2][0]);
+    double step[3];
+    for(int c=0;c<3;c++) { // Cramer's rule
+      double m[3][3];
+      for(int r=0;r<3;r++)
+        for(int k=0;k<3;k++) m[r][k] = (k==c ? f[r] : j[r][k]);
+      step[c] = (m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])-m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+                +m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]))/det;
+    }
+    for(int c=0;c<3;c++) pos[c] -= step[c];
+  }
+}
+
+int main(int argc,char **argv) {
+  int points = (argc>1 ? atoi(argv[1]) : 20000);
+  bool ok = true;
+  host_set_gcode("M266 P1 X0.35 Y-0.42 Z0.3\nM266 P3 X-0.2 Y0.15 Z-0.25 S1");
+  host_start(false);
+  host_run(F_CPU*10ULL);
+  // Read back what M266 stored
+  for(byte i=0;i<3;i++)
+    printer_state.deltaRodCorrection[i] = printer_state.deltaRadiusCorrection[i] = printer_state.deltaAngleCorrection[i] = 0;
+  epr_eeprom_to_data();
+  for(int i=0;i<3;i++) {
+    printf("Tower %d rod:%.2f radius:%.2f angle:%.2f\n",i+1,printer_state.deltaRodCorrection[i],
+      printer_state.deltaRadiusCorrection[i],printer_state.deltaAngleCorrection[i]);
+    if(fabs(printer_state.deltaRodCorrection[i]-rod_correction[i])>1e-4 ||
+       fabs(printer_state.deltaRadiusCorrection[i]-radius_correction[i])>1e-4 ||
+       fabs(printer_state.deltaAngleCorrection[i]-angle_correction[i])>1e-4) {
+      fprintf(stderr,"Tower %d corrections not stored\n",i+1);
+      ok = false;
+    }
+  }
+  model_geometry();
+  double min_height = 0,max_height = 0,max_position = 0;
+  int invalid = 0;
+  srand(1);
+  for(int n=0;n<points;n++) {
+    double r = 100*sqrt(rand()/(double)RAND_MAX),a = 2*M_PI*rand()/(double)RAND_MAX;
+    long cart[3] = {(long)(r*cos(a)*AXIS_STEPS_PER_MM),(long)(r*sin(a)*AXIS_STEPS_PER_MM),
+                    (long)(300.0*rand()/RAND_MAX*AXIS_STEPS_PER_MM)};
+    long towers[3];
+    if(!calculate_delta(cart,towers)) {
+      invalid++;
+      continue;
+    }
+    double pos[3] = {(double)cart[0],(double)cart[1],(double)cart[2]},h[3];
+    model_towers(pos,h);
+    for(int i=0;i<3;i++) { // Rounded down, so 0 <= h-towers < 1 without rounding errors
+      double e = h[i]-towers[i];
+      if(e<min_height) min_height = e;
+      if(e>max_height) max_height = e;
+    }
+    double back[3] = {0,0,(double)cart[2]};
+    model_position(towers,back);
+    double d = sqrt((back[0]-pos[0])*(back[0]-pos[0])+(back[1]-pos[1])*(back[1]-pos[1])+(back[2]-pos[2])*(back[2]-pos[2]))/AXIS_STEPS_PER_MM;
+    if(d>max_position) max_position = d;
+  }
+  printf("Points: %d, invalid: %d, model-tower height: %.3f to %.3f steps, max. round trip error: %.4f mm\n",
+    points,invalid,min_height,max_height,max_position);
+  if(invalid || min_height<-MAX_HEIGHT_ERROR || max_height>1+MAX_HEIGHT_ERROR || max_position>MAX_POSITION_ERROR) ok = false;
+  // Homing with the corrections
+  host_set_gcode("G28");
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  long height = delta_endstop_height();
+  double home[3] = {0,0,(double)printer_state.zMaxSteps};
+  model_position(printer_state.currentDeltaPositionSteps,home);
+  double d = 0;
+  for(int i=0;i<3;i++) {
+    if(printer_state.currentDeltaPositionSteps[i]!=height || printer_state.maxDeltaPositionSteps[i]!=height) {
+      fprintf(stderr,"Tower %d not at the endstop height %ld after homing\n",i+1,height);
+      ok = false;
+    }
+    d += (home[i]-printer_state.currentPositionSteps[i])*(home[i]-printer_state.currentPositionSteps[i]);
+  }
+  d = sqrt(d)/AXIS_STEPS_PER_MM;
+  printf("Homed at X%.3f Y%.3f Z%.3f, model X%.3f Y%.3f Z%.3f, error: %.4f mm\n",
+    printer_state.currentPositionSteps[0]/AXIS_STEPS_PER_MM,printer_state.currentPositionSteps[1]/AXIS_STEPS_PER_MM,
+    printer_state.currentPositionSteps[2]/AXIS_STEPS_PER_MM,home[0]/AXIS_STEPS_PER_MM,home[1]/AXIS_STEPS_PER_MM,
+    home[2]/AXIS_STEPS_PER_MM,d);
+  if(d>MAX_POSITION_ERROR) ok = false;
+  if(!ok) fprintf(stderr,"Delta geometry test failed\n");
+  return ok ? 0 : 1;
+}
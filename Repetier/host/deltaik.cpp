@@ -0,0 +1,157 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Compares calculate_delta with DELTA_INCREMENTAL_IK 0 and 1 over the build volume. The sweep goes in
+  rows of SWEEP_STEP through the circle of SWEEP_RADIUS at several heights, like consecutive segments,
+  once with the nominal geometry and once with per tower corrections.
+  Built without DELTA_INCREMENTAL_IK it writes the tower heights to the reference file. Built with it,
+  it compares its tower heights with the reference: they must be equal or one step off, because the
+  tower positions are rounded to whole steps.
+  Both report the CPU cycles per calculate_delta call. These are cycles of this computer, they compare
+  the two versions, not the time on the AVR.
+
+  Usage: deltaik reference.bin
+
+  Returns 1 if a tower height differs by more than one step or the validity differs.
+*/
+#include <x86intrin.h>
+#include <vector>
+#include "Reptier.h"
+#include <stdio.h>
+
+#define SWEEP_RADIUS 100.0 // mm
+#define SWEEP_STEP 0.5 // mm
+#define SWEEP_HEIGHTS 4
+#define INVALID_HEIGHT -2147483647L
+
+static const float rod_correction[3] = {0.35,0,-0.2};
+static const float radius_correction[3] = {-0.42,0,0.15};
+static const float angle_correction[3] = {0.3,0,-0.25};
+
+typedef struct {
+  uint32_t points;
+  double cycles; ///< Cycles per calculate_delta call
+} ReferenceHeader;
+
+static long calls = 0;
+static volatile long sink = 0; ///< Keeps the benchmarked results alive
+static uint64_t cycles = 0;
+static std::vector<int32_t> heights;
+
+/** Calls f for the positions of the sweep in steps. */
+static void sweep(void (*f)(long pos[])) {
+  const long radius = (long)(SWEEP_RADIUS*AXIS_STEPS_PER_MM),step = (long)(SWEEP_STEP*AXIS_STEPS_PER_MM);
+  long pos[3];
+  for(int h=0;h<SWEEP_HEIGHTS;h++) {
+    pos[Z_AXIS] = (long)(h*Z_MAX_LENGTH/SWEEP_HEIGHTS*AXIS_STEPS_PER_MM);
+    int row = 0;
+    for(pos[Y_AXIS]=-radius;pos[Y_AXIS]<=radius;pos[Y_AXIS]+=step,row++) {
+      long w = (long)sqrt((double)radius*radius-(double)pos[Y_AXIS]*pos[Y_AXIS]);
+      w -= w%step;
+      for(long x=-w;x<=w;x+=step) {
+        pos[X_AXIS] = (row&1 ? -x : x); // rows alternate direction like a print
+        f(pos);
+      }
+    }
+  }
+}
+static void time_position(long pos[]) {
+  long towers[3];
+  uint64_t start = __rdtsc();
+  calculate_delta(pos,towers);
+  cycles += __rdtsc()-start;
+  sink += towers[0];
+  calls++;
+}
+static void store_position(long pos[]) {
+  long towers[3];
+  byte ok = calculate_delta(pos,towers);
+  for(int i=0;i<3;i++) heights.push_back(ok ? (int32_t)towers[i] : INVALID_HEIGHT);
+}
+/** Sets the corrections and computes the geometry. */
+static void set_geometry(bool corrected) {
+  delta_reset_corrections();
+  if(corrected)
+    for(int i=0;i<3;i++) {
+      printer_state.deltaRodCorrection[i] = rod_correction[i];
+      printer_state.deltaRadiusCorrection[i] = radius_correction[i];
+      printer_state.deltaAngleCorrection[i] = angle_correction[i];
+    }
+  delta_update_geometry();
+}
+
+int main(int argc,char **argv) {
+  if(argc<2) {
+    fprintf(stderr,"Usage: %s reference.bin\n",argv[0]);
+    return 2;
+  }
+  for(int g=0;g<2;g++) { // Benchmark
+    set_geometry(g==1);
+    sweep(time_position);
+  }
+  double perCall = (double)cycles/calls;
+  for(int g=0;g<2;g++) { // Tower heights of the sweep
+    set_geometry(g==1);
+    sweep(store_position);
+  }
+  ReferenceHeader h;
+#if !DELTA_INCREMENTAL_IK
+  FILE *f = fopen(argv[1],"wb");
+  if(!f) {
+    fprintf(stderr,"Can't write %s\n",argv[1]);
+    return 2;
+  }
+  h.points = heights.size()/3;
+  h.cycles = perCall;
+  fwrite(&h,sizeof(h),1,f);
+  fwrite(&heights[0],sizeof(int32_t),heights.size(),f);
+  fclose(f);
+  printf("Points: %u, float math: %.1f cycles per calculate_delta\n",h.points,perCall);
+  return 0;
+#else
+  FILE *f = fopen(argv[1],"rb");
+  if(!f || fread(&h,sizeof(h),1,f)!=1 || h.points*3!=heights.size()) {
+    fprintf(stderr,"%s is no reference of this sweep\n",argv[1]);
+    return 2;
+  }
+  std::vector<int32_t> reference(heights.size());
+  if(fread(&reference[0],sizeof(int32_t),reference.size(),f)!=reference.size()) {
+    fprintf(stderr,"%s is too short\n",argv[1]);
+    return 2;
+  }
+  fclose(f);
+  long exact = 0,oneOff = 0,wrong = 0,invalid = 0;
+  for(size_t i=0;i<heights.size();i++) {
+    if(heights[i]==INVALID_HEIGHT || reference[i]==INVALID_HEIGHT) {
+      if(heights[i]!=reference[i]) wrong++;
+      else invalid++;
+      continue;
+    }
+    long d = labs((long)heights[i]-reference[i]);
+    if(d==0) exact++;
+    else if(d==1) oneOff++;
+    else wrong++;
+  }
+  printf("Points: %u, tower heights equal: %ld, one step off: %ld, more: %ld, unreachable: %ld\n",
+    h.points,exact,oneOff,wrong,invalid);
+  printf("Cycles per calculate_delta: float math %.1f, integer math %.1f\n",h.cycles,perCall);
+  if(wrong) {
+    fprintf(stderr,"Integer tower heights differ by more than one step\n");
+    return 1;
+  }
+  return 0;
+#endif
+}
@@ -0,0 +1,218 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Checks the segment counts of DELTA_ADAPTIVE_SEGMENTS. Moves are split into the number of segments
+  delta_error_segments returns, with the rounding of split_delta_move. Inside a segment the towers move
+  linearly between the heights at its ends. The effector position for these heights is computed with a
+  double precision model, its largest distance from the straight line must stay below
+  DELTA_SEGMENT_MAX_ERROR.
+
+  Usage: deltasegments [moves [radius_mm]]
+         deltasegments file.gcode ...
+
+  Defaults are 2000 random moves inside 100 mm radius. With G-code files the xy moves of each file are
+  checked, and the segment counts and the deviation are compared with the time based segments of
+  DELTA_SEGMENTS_PER_SECOND_PRINT/MOVE. Returns 1 if the deviation is too large.
+*/
+#include "Reptier.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !DELTA_ADAPTIVE_SEGMENTS
+#error deltasegments needs DELTA_ADAPTIVE_SEGMENTS
+#endif
+
+extern int delta_error_segments(long difference[]);
+
+#define SAMPLES 32
+
+static const double tower_x[3] = {DELTA_TOWER1_X_STEPS,DELTA_TOWER2_X_STEPS,DELTA_TOWER3_X_STEPS};
+static const double tower_y[3] = {DELTA_TOWER1_Y_STEPS,DELTA_TOWER2_Y_STEPS,DELTA_TOWER3_Y_STEPS};
+
+/** Height of tower i above the effector in steps at x,y in steps. */
+static double tower_height(int i,double x,double y) {
+  double dx = tower_x[i]-x,dy = tower_y[i]-y;
+  return sqrt((double)DELTA_DIAGONAL_ROD_STEPS_SQUARED-dx*dx-dy*dy);
+}
+/** Effector position in steps for tower heights h, Newton iterations started at p. */
+static void effector_position(const double h[3],double p[3]) {
+  for(int iter=0;iter<4;iter++) {
+    double f[3],j[3][3];
+    for(int i=0;i<3;i++) {
+      double dx = p[0]-tower_x[i],dy = p[1]-tower_y[i],dz = p[2]-h[i];
+      f[i] = dx*dx+dy*dy+dz*dz-(double)DELTA_DIAGONAL_ROD_STEPS_SQUARED;
+      j[i][0] = 2*dx;j[i][1] = 2*dy;j[i][2] = 2*dz;
+    }
+    double det = j[0][0]*(j[1][1]*j[2][2]-j[1][2]*j[2][1])-j[0][1]*(j[1][0]*j[2][2]-j[1][2]*j[2][0])
+                +j[0][2]*(j[1][0]*j[2][1]-j[1][1]*j[2][0]);
+    for(int c=0;c<3;c++) { // Cramer's rule
+      double m[3][3];
+      for(int r=0;r<3;r++)
+        for(int k=0;k<3;k++) m[r][k] = (k==c ? f[r] : j[r][k]);
+      p[c] -= (m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])-m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+              +m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]))/det;
+    }
+  }
+}
+/** Largest distance in mm of the effector from the straight xy line from start to end, moved in n segments. */
+static double move_deviation(const double start[2],const double end[2],int n) {
+  double dx = end[0]-start[0],dy = end[1]-start[1],len = sqrt(dx*dx+dy*dy),worst = 0;
+  if(len==0) return 0;
+  for(int s=0;s<n;s++) {
+    double x0 = start[0]+dx*s/n,y0 = start[1]+dy*s/n;
+    double x1 = start[0]+dx*(s+1)/n,y1 = start[1]+dy*(s+1)/n;
+    double h0[3],h1[3];
+    for(int i=0;i<3;i++) {
+      h0[i] = tower_height(i,x0,y0);
+      h1[i] = tower_height(i,x1,y1);
+    }
+    for(int k=1;k<SAMPLES;k++) {
+      double t = k/(double)SAMPLES,h[3];
+      for(int i=0;i<3;i++) h[i] = h0[i]+(h1[i]-h0[i])*t;
+      double p[3] = {x0+(x1-x0)*t,y0+(y1-y0)*t,0};
+      effector_position(h,p);
+      double side = ((p[0]-start[0])*dy-(p[1]-start[1])*dx)/len; // distance in xy from the line
+      double e = sqrt(side*side+p[2]*p[2])/AXIS_STEPS_PER_MM;
+      if(e>worst) worst = e;
+    }
+  }
+  return worst;
+}
+/** Segments of a move after the split into lines of split_delta_move. */
+static int split_segments(int segment_count,bool roundUp) {
+  int num_lines = (segment_count+MAX_DELTA_SEGMENTS_PER_LINE-1)/MAX_DELTA_SEGMENTS_PER_LINE;
+  return num_lines*(roundUp ? (segment_count+num_lines-1)/num_lines : segment_count/num_lines);
+}
+/** Adaptive segments of the xy move from start to end in steps. */
+static int adaptive_segments(const double start[3],const double end[3]) {
+  long difference[4] = {lround(end[0]-start[0]),lround(end[1]-start[1]),lround(end[2]-start[2]),0};
+  for(int i=0;i<3;i++) printer_state.currentPositionSteps[i] = lround(start[i]);
+  return split_segments(delta_error_segments(difference),true);
+}
+/** Random point in the circle with radius r steps. */
+static void random_point(double r,double p[3]) {
+  double d = r*sqrt(rand()/(double)RAND_MAX),a = 2*M_PI*rand()/(double)RAND_MAX;
+  p[0] = (long)(d*cos(a));
+  p[1] = (long)(d*sin(a));
+  p[2] = 0;
+}
+
+/** Reads the value of letter in a G-code line, returns false if it isn't there. */
+static bool gcode_value(const char *line,char letter,double &value) {
+  for(const char *c=line;*c && *c!=';';c++)
+    if(*c==letter) {
+      value = atof(c+1);
+      return true;
+    }
+  return false;
+}
+
+/** Checks the xy moves of a G-code file. Returns false if the adaptive segments deviate too much. */
+static bool check_file(const char *name) {
+  FILE *f = fopen(name,"r");
+  if(!f) {
+    fprintf(stderr,"Can't read %s\n",name);
+    return false;
+  }
+  double pos[4] = {0,0,0,0},feedrate = 50; // mm/s until the first F
+  bool relative = false,relativeE = false;
+  long moves = 0,adaptive = 0,timed = 0;
+  double adaptiveWorst = 0,timedWorst = 0;
+  char line[256];
+  while(fgets(line,sizeof(line),f)) {
+    double g,m,v;
+    if(gcode_value(line,'M',m)) {
+      if(m==82) relativeE = false;
+      if(m==83) relativeE = true;
+      continue;
+    }
+    if(!gcode_value(line,'G',g)) continue;
+    if(g==90) relative = relativeE = false;
+    else if(g==91) relative = relativeE = true;
+    else if(g==28) {
+      pos[0] = pos[1] = 0;
+      pos[2] = Z_MAX_LENGTH;
+    } else if(g==92) {
+      const char axes[4] = {'X','Y','Z','E'};
+      for(int i=0;i<4;i++)
+        if(gcode_value(line,axes[i],v)) pos[i] = v;
+    } else if(g==0 || g==1) {
+      const char axes[4] = {'X','Y','Z','E'};
+      double next[4];
+      for(int i=0;i<4;i++) {
+        next[i] = pos[i];
+        if(gcode_value(line,axes[i],v)) next[i] = ((i<3 ? relative : relativeE) ? pos[i]+v : v);
+      }
+      if(gcode_value(line,'F',v)) feedrate = v/60.0;
+      double dx = next[0]-pos[0],dy = next[1]-pos[1],dz = next[2]-pos[2];
+      if(dx!=0 || dy!=0) { // xy moves are segmented, see split_delta_move
+        double start[3],end[3];
+        for(int i=0;i<3;i++) {
+          start[i] = pos[i]*AXIS_STEPS_PER_MM;
+          end[i] = next[i]*AXIS_STEPS_PER_MM;
+        }
+        int n = adaptive_segments(start,end);
+        double seconds = sqrt(dx*dx+dy*dy+dz*dz)/feedrate;
+        int t = split_segments(max(1,int((next[3]>pos[3] ? DELTA_SEGMENTS_PER_SECOND_PRINT : DELTA_SEGMENTS_PER_SECOND_MOVE)*seconds)),false);
+        adaptive += n;
+        timed += t;
+        adaptiveWorst = max(adaptiveWorst,move_deviation(start,end,n));
+        timedWorst = max(timedWorst,move_deviation(start,end,t));
+        moves++;
+      }
+      memcpy(pos,next,sizeof(pos));
+    }
+  }
+  fclose(f);
+  printf("%s: %ld xy moves, adaptive: %ld segments, worst deviation %.4f mm; %d segments/s: %ld segments, worst deviation %.4f mm\n",
+    name,moves,adaptive,adaptiveWorst,DELTA_SEGMENTS_PER_SECOND_PRINT,timed,timedWorst);
+  return adaptiveWorst<=DELTA_SEGMENT_MAX_ERROR;
+}
+
+int main(int argc,char **argv) {
+  if(argc>1 && strtol(argv[1],NULL,10)==0) { // G-code files
+    bool ok = true;
+    for(int i=1;i<argc;i++)
+      if(!check_file(argv[i])) ok = false;
+    if(!ok) fprintf(stderr,"Delta segments deviate more than DELTA_SEGMENT_MAX_ERROR\n");
+    return ok ? 0 : 1;
+  }
+  int moves = (argc>1 ? atoi(argv[1]) : 2000);
+  double radius = (argc>2 ? atof(argv[2]) : 100)*AXIS_STEPS_PER_MM;
+  double worst = 0,worst_length = 0;
+  long segments = 0,max_segments = 0;
+  srand(1);
+  for(int m=0;m<moves;m++) {
+    double start[3],end[3];
+    random_point(radius,start);
+    random_point(radius,end);
+    int n = adaptive_segments(start,end);
+    segments += n;
+    if(n>max_segments) max_segments = n;
+    double e = move_deviation(start,end,n);
+    if(e>worst) {
+      worst = e;
+      worst_length = sqrt((end[0]-start[0])*(end[0]-start[0])+(end[1]-start[1])*(end[1]-start[1]))/AXIS_STEPS_PER_MM;
+    }
+  }
+  printf("Moves: %d, segments: %ld, max. per move: %ld, worst effector deviation: %.4f mm (move of %.1f mm), limit %.4f mm\n",
+    moves,segments,max_segments,worst,worst_length,(double)DELTA_SEGMENT_MAX_ERROR);
+  if(worst>DELTA_SEGMENT_MAX_ERROR) {
+    fprintf(stderr,"Delta segments deviate more than DELTA_SEGMENT_MAX_ERROR\n");
+    return 1;
+  }
+  return 0;
+}
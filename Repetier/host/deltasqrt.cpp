@@ -0,0 +1,95 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Checks delta_sqrt (DELTA_INCREMENTAL_IK) against the exact square root rounded down. Tested are
+  - random radicands up to the 31 bit limit with start roots near the result, far off and 0,
+  - squares and their neighbours with start roots one off,
+  - sequences of close radicands like consecutive delta segments, each started at the last root.
+
+  Usage: deltasqrt [checks]
+
+  Defaults to 1000000 random checks. Returns 1 if a result differs.
+*/
+#include "Reptier.h"
+#include <stdio.h>
+
+#if !DELTA_INCREMENTAL_IK
+#error deltasqrt needs DELTA_INCREMENTAL_IK
+#endif
+
+#define MAX_RADICAND 0x7fffffffL
+
+static unsigned long checks = 0,wrong = 0;
+
+/** 31 random bits. */
+static long random31() {
+  return (((long)rand()<<16) ^ rand()) & MAX_RADICAND;
+}
+static long exact_sqrt(long val) {
+  long r = (long)sqrt((double)val);
+  while(r*r>val) r--;
+  while((r+1)*(r+1)<=val) r++;
+  return r;
+}
+static void check(long val,long start) {
+  long root = start;
+  long r = delta_sqrt(val,&root);
+  long e = exact_sqrt(val);
+  checks++;
+  if(r!=e || root!=e) {
+    if(wrong<10) fprintf(stderr,"delta_sqrt(%ld) started at %ld is %ld, expected %ld\n",val,start,r,e);
+    wrong++;
+  }
+}
+
+int main(int argc,char **argv) {
+  long n = (argc>1 ? atol(argv[1]) : 1000000);
+  srand(1);
+  for(long i=0;i<n;i++) {
+    long val = random31() >> (rand() % 31); // all magnitudes
+    long e = exact_sqrt(val);
+    check(val,0);
+    check(val,e);
+    check(val,e+rand()%(e/4+1)-e/8);
+    check(val,rand() % 46341);
+  }
+  for(long k=1;k<=46340;k+=(k<100 ? 1 : 1+rand()%7)) {
+    for(long v=k*k-1;v<=k*k+1 && v<=MAX_RADICAND;v++) {
+      check(v,k-1);
+      check(v,k);
+      check(v,k+1);
+    }
+  }
+  check(MAX_RADICAND,46340);
+  check(MAX_RADICAND,0);
+  for(long s=0;s<1000;s++) {
+    long val = random31(),root = 0;
+    for(int j=0;j<100;j++) { // Like the segments of one tower
+      long next = val+(rand()%2000001-1000000);
+      if(next<0 || next>MAX_RADICAND) break;
+      long start = root;
+      long r = delta_sqrt(next,&root);
+      checks++;
+      if(r!=exact_sqrt(next)) {
+        if(wrong<10) fprintf(stderr,"delta_sqrt(%ld) started at %ld is %ld, expected %ld\n",next,start,r,exact_sqrt(next));
+        wrong++;
+      }
+      val = next;
+    }
+  }
+  printf("delta_sqrt checks: %lu, wrong: %lu\n",checks,wrong);
+  return wrong ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Delta step total simulation. After homing, moves just below the top run towards the towers, so the
+  tower positions get clipped by the soft endstop. While these moves are queued, the clip positions
+  (printer_state.maxDeltaPositionSteps) are lowered, as homing or a geometry change does, and a tall
+  z move follows, which needs one segment only with DELTA_JIT_SEGMENTS. The step pulses of the towers are counted. With DELTA_JIT_SEGMENTS every line must
+  start exactly at the tower position it was planned with, and at the end the counted steps must match
+  the tower position of the firmware.
+
+  Usage: deltasteps
+
+  Returns 1 if a step count differs.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+extern PrintLine *cur;
+extern void loop();
+
+static long start[3];
+
+#if DELTA_JIT_SEGMENTS
+static long lines_checked = 0,lines_wrong = 0;
+static unsigned long largest_segment = 0;
+
+/** Before a line starts, all earlier lines are done, so the counted steps must be its start position. */
+static void check_line_start() {
+  if(cur || lines_count==0) return;
+  PrintLine *p = &lines[lines_pos];
+  if((p->flags & FLAG_WARMUP) || p->numDeltaSegments==0 || !p->deltaSegmentsReady) return;
+  lines_checked++;
+  int s = p->deltaSegmentReadPos;
+  for(byte n=0;n<p->numDeltaSegments;n++) {
+    for(byte i=0;i<3;i++)
+      if(segments[s].deltaSteps[i]>largest_segment) largest_segment = segments[s].deltaSteps[i];
+    if(++s>=DELTA_CACHE_SIZE) s = 0;
+  }
+  for(byte i=0;i<3;i++)
+    if(host_counted_steps[i]!=p->deltaTowerStart[i]-start[i]) {
+      if(lines_wrong==0)
+        fprintf(stderr,"Line %ld starts at tower %d step %ld, planned %ld\n",lines_checked,i,
+          host_counted_steps[i],p->deltaTowerStart[i]-start[i]);
+      lines_wrong++;
+      return;
+    }
+}
+#endif
+
+/** Adds moves at height z mm to points on a circle with radius r mm around the center. */
+static char *add_circle(char *pos,double z,double r,int points) {
+  for(int i=0;i<=points;i++) {
+    double a = i*2*M_PI/points;
+    pos += sprintf(pos,"G1 X%.2f Y%.2f Z%.2f F3000\n",r*cos(a),r*sin(a),z);
+  }
+  return pos;
+}
+
+int main(int argc,char **argv) {
+  host_set_gcode("G28\nG90\n");
+  host_start(false);
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  double top = printer_state.zMaxSteps*inv_axis_steps_per_unit[2];
+  for(int i=0;i<3;i++) start[i] = printer_state.currentDeltaPositionSteps[i];
+  host_count_steps();
+#if DELTA_JIT_SEGMENTS
+  host_timer1_prehook = check_line_start;
+#endif
+  char gcode[4000],*pos = gcode;
+  pos = add_circle(pos,top-0.5,40,12);
+  host_set_gcode(gcode);
+  while(host_serial_in_pos<host_serial_in_len || lines_count<MOVE_CACHE_SIZE/2)
+    loop();
+  // Lines planned with the old clip positions are still queued
+  for(int i=0;i<3;i++) printer_state.maxDeltaPositionSteps[i] -= axis_steps_per_unit[2];
+  pos = add_circle(gcode,top-0.5,40,12);
+  pos += sprintf(pos,"G1 X0 Y0 Z1 F6000\nG1 Z%.2f\n",top-1);
+  host_set_gcode(gcode);
+  bool ok = host_run(F_CPU*600ULL);
+  if(!ok) fprintf(stderr,"Timeout, moves not finished\n");
+  const char *names[3] = {"X","Y","Z"};
+  for(int i=0;i<3;i++) {
+    long expected = printer_state.currentDeltaPositionSteps[i]-start[i];
+    printf("%s tower steps: %ld, expected %ld\n",names[i],(long)host_counted_steps[i],expected);
+    if(host_counted_steps[i]!=expected) ok = false;
+  }
+#if DELTA_JIT_SEGMENTS
+  printf("Lines checked: %ld, wrong start: %ld, largest segment: %lu steps\n",lines_checked,lines_wrong,largest_segment);
+  if(lines_wrong || lines_checked==0) ok = false;
+#endif
+  if(!ok) fprintf(stderr,"Delta step total test failed\n");
+  return ok ? 0 : 1;
+}
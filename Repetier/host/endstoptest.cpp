@@ -0,0 +1,141 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Endstop test for delta printers with ENDSTOP_INTERRUPTS. The max endstops of the towers are simulated
+  from the counted step pulses, each one at a different height. The test checks, that
+  - homing stops every tower within the debounce distance after its endstop,
+  - noise switching between two endstops stops no move, as long as no single endstop is triggered
+    ENDSTOP_DEBOUNCE checks in a row,
+  - an endstop held while the towers move down is neither latched nor read,
+  - an endstop already held when a move up starts stops its tower.
+
+  Usage: endstoptest
+
+  Returns 1 if a check fails.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+#if !ENDSTOP_INTERRUPTS || DRIVE_SYSTEM!=3
+#error endstoptest needs a delta printer with ENDSTOP_INTERRUPTS
+#endif
+
+extern volatile byte endstop_latch;
+extern byte endstop_mask;
+extern void loop();
+
+static const int max_pins[3] = {X_MAX_PIN,Y_MAX_PIN,Z_MAX_PIN};
+static const bool max_inverting[3] = {ENDSTOP_X_MAX_INVERTING,ENDSTOP_Y_MAX_INVERTING,ENDSTOP_Z_MAX_INVERTING};
+static long endstop_steps[3];     ///< Counted steps at which the endstop triggers
+static long highest[3];           ///< Highest counted steps seen
+static bool held[3] = {false,false,false}; ///< Endstop triggered independent of the position
+static bool noise = false;        ///< Triggers the x and y endstop in turn
+static unsigned long noise_phase = 0;
+static unsigned long latched_down = 0; ///< Interrupts with a latched endstop while all towers move down
+static bool down = false;
+
+static void simulate_endstops() {
+  for(int i=0;i<3;i++) {
+    if(host_counted_steps[i]>highest[i]) highest[i] = host_counted_steps[i];
+    bool hit = held[i] || host_counted_steps[i]>=endstop_steps[i];
+    if(noise && i<2) {
+      // x,y,y,x: a check every call or every second call sees each endstop at most twice in a row
+      byte phase = noise_phase & 3;
+      hit |= (i==0 ? phase==0 || phase==3 : phase==1 || phase==2);
+    }
+    host_set_endstop(max_pins[i],max_inverting[i],hit);
+  }
+  noise_phase++;
+  if(down && (endstop_latch || endstop_mask)) latched_down++;
+}
+
+/** Runs the G-code and returns the counted steps of the towers for it in moved. */
+static bool run(const char *gcode,long moved[3]) {
+  long before[3];
+  for(int i=0;i<3;i++) before[i] = host_counted_steps[i];
+  host_set_gcode(gcode);
+  bool ok = host_run(F_CPU*600ULL);
+  if(!ok) fprintf(stderr,"Timeout for %s\n",gcode);
+  for(int i=0;i<3;i++) moved[i] = host_counted_steps[i]-before[i];
+  return ok;
+}
+
+int main(int argc,char **argv) {
+  const char *names[3] = {"X","Y","Z"};
+  long tolerance = MAX_STEPPER_LOOPS*(ENDSTOP_DEBOUNCE+1);
+  long moved[3],expected[3],start[3];
+  bool ok = true;
+  host_set_gcode("");
+  host_start(false);
+  host_count_steps();
+  for(int i=0;i<3;i++) {
+    endstop_steps[i] = (long)((100+10*i)*axis_steps_per_unit[i]);
+    highest[i] = 0;
+  }
+  host_timer1_hook = simulate_endstops;
+  ok &= run("G28",moved);
+  for(int i=0;i<3;i++) {
+    printf("%s tower endstop at %ld steps, highest %ld\n",names[i],endstop_steps[i],highest[i]);
+    if(highest[i]<endstop_steps[i] || highest[i]>endstop_steps[i]+tolerance) ok = false;
+  }
+  if(!ok) fprintf(stderr,"Homing didn't stop at the endstops\n");
+
+  // Noise on x and y while all towers move up
+  double top = printer_state.zMaxSteps*inv_axis_steps_per_unit[2];
+  char gcode[200];
+  sprintf(gcode,"G90\nG1 X0 Y0 Z%.2f F6000",top-50);
+  ok &= run(gcode,moved);
+  for(int i=0;i<3;i++) start[i] = printer_state.currentDeltaPositionSteps[i];
+  noise = true;
+  sprintf(gcode,"G1 Z%.2f",top-10);
+  ok &= run(gcode,moved);
+  noise = false;
+  bool noise_ok = true;
+  for(int i=0;i<3;i++) {
+    expected[i] = printer_state.currentDeltaPositionSteps[i]-start[i];
+    if(moved[i]!=expected[i] || expected[i]<=0) noise_ok = false;
+  }
+  printf("Move up with noise: %ld %ld %ld steps, expected %ld %ld %ld\n",moved[0],moved[1],moved[2],
+    expected[0],expected[1],expected[2]);
+  if(!noise_ok) fprintf(stderr,"Noise on two endstops stopped a move\n");
+  ok &= noise_ok;
+
+  // Held x endstop while all towers move down
+  held[0] = true;
+  down = true;
+  sprintf(gcode,"G1 Z%.2f",top-50);
+  ok &= run(gcode,moved);
+  down = false;
+  printf("Move down with held X endstop: %ld %ld %ld steps, interrupts with endstops watched %lu\n",
+    moved[0],moved[1],moved[2],latched_down);
+  if(latched_down || moved[0]>=0) {
+    fprintf(stderr,"Held endstop watched while moving away from it\n");
+    ok = false;
+  }
+
+  // The held x endstop stops the x tower at once
+  sprintf(gcode,"G1 Z%.2f",top-40);
+  ok &= run(gcode,moved);
+  held[0] = false;
+  printf("Move up with held X endstop: %ld %ld %ld steps\n",moved[0],moved[1],moved[2]);
+  if(moved[0]>tolerance || moved[1]<=0 || moved[2]<=0) {
+    fprintf(stderr,"Held endstop didn't stop its tower\n");
+    ok = false;
+  }
+  if(!ok) fprintf(stderr,"Endstop test failed\n");
+  return ok ? 0 : 1;
+}
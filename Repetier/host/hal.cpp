@@ -0,0 +1,415 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Stub hardware layer for the host build.
+
+  Time is counted in virtual CPU cycles. The main program advances it at its polling points
+  (serial input, millis(), micros()) and with delays. Interrupts run at their exact virtual time
+  while the clock is advanced, so the main program is interrupted only at polling points, but the
+  stepper timing is the one of the real timer.
+
+  With host_preempt set, timer 1 interrupts are raised by signals from another thread instead and
+  interrupt the main program at any point, unless it disabled interrupts.
+*/
+#include <Arduino.h>
+#include <pins_arduino.h>
+#include <SPI.h>
+#include <stdio.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include "../fastio.h"
+
+extern "C" void TIMER1_COMPA_vect(void);
+extern "C" void TIMER0_COMPA_vect(void) __attribute__((weak));
+extern "C" void TIMER0_COMPB_vect(void) __attribute__((weak));
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+
+volatile uint64_t host_ticks = 0;
+uint32_t host_poll_ticks = 160;
+uint32_t host_cpu_scale = 0;
+uint32_t host_isr_ticks = 0;
+void (*host_timer1_prehook)() = 0;
+void (*host_timer1_hook)() = 0;
+void (*host_planner_hook)() = 0;
+
+volatile uint8_t TCCR0A,TCCR0B,TIMSK0,TIFR0,OCR0A,OCR0B;
+volatile uint8_t TCCR1A,TCCR1B,TCCR1C,TIMSK1,TIFR1;
+volatile uint16_t OCR1A = 65535,OCR1B,ICR1;
+volatile uint8_t TCCR2A,TCCR2B,TIMSK2,TIFR2,OCR2A,OCR2B;
+volatile uint8_t ADMUX,ADCSRB,DIDR0,DIDR2;
+volatile uint8_t SPCR,SPDR;
+volatile uint8_t TWBR,TWDR,TWSR;
+volatile uint8_t PCICR,PCMSK0,PCMSK1,PCMSK2,PCIFR;
+volatile uint8_t MCUSR = 1;
+HostSREG SREG;
+HostTCNT1 TCNT1;
+HostADCSRA ADCSRA;
+HostReadyReg SPSR = {0,1<<SPIF};
+HostReadyReg TWCR = {0,1<<TWINT};
+volatile uint16_t host_adc_value = 512;
+uint8_t host_eeprom[HOST_EEPROM_SIZE];
+HardwareSerial Serial;
+SPIClass SPI;
+
+const char *host_serial_in = 0;
+size_t host_serial_in_len = 0;
+size_t host_serial_in_pos = 0;
+void (*host_serial_out)(uint8_t c) = 0;
+
+// ##########################################################################
+// ###                           Interrupts                               ###
+// ##########################################################################
+
+volatile byte host_irq_enabled = 1;
+volatile byte host_in_isr = 0;
+volatile byte host_preempt = 0;
+static volatile byte timer1_pending = 0;
+static volatile byte pcint_pending = 0;
+static uint64_t timer1_start = 0;    ///< Tick of the last counter reset of timer 1
+static uint64_t timer0_last[2] = {0,0}; ///< Timer 0 count of the last compare interrupt A/B
+static pthread_t main_thread;
+
+byte host_time_isr = 0;
+volatile uint64_t host_isr_ns = 0;
+
+static void run_isr(void (*isr)(void)) {
+  host_in_isr = 1;
+  host_irq_enabled = 0;
+  if(host_time_isr) {
+    uint64_t start = host_real_ns();
+    isr();
+    host_isr_ns += host_real_ns()-start;
+  } else
+    isr();
+  host_in_isr = 0;
+  host_irq_enabled = 1; // reti
+}
+static void run_timer1() {
+  if(host_preempt) { // no virtual clock, every signal is one timer period
+    timer1_start += (uint32_t)OCR1A+1;
+    if(host_ticks<timer1_start) host_ticks = timer1_start;
+  }
+  host_ticks += host_isr_ticks;
+  if(host_timer1_prehook) host_timer1_prehook();
+  run_isr(TIMER1_COMPA_vect);
+  if(host_timer1_hook) host_timer1_hook();
+}
+void host_cli() {
+  host_irq_enabled = 0;
+}
+void host_sei() {
+  host_irq_enabled = 1;
+  if(host_in_isr) return; // nested interrupts are not emulated
+  while(host_preempt && timer1_pending && !host_in_isr) {
+    timer1_pending = 0;
+    run_timer1();
+  }
+}
+void host_raise_timer1() {
+  if(!host_irq_enabled || host_in_isr)
+    timer1_pending = 1;
+  else
+    run_timer1();
+}
+static void timer1_signal(int) {
+  host_raise_timer1();
+}
+void host_preempt_init() {
+  main_thread = pthread_self();
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler = timer1_signal;
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1,&sa,0);
+  host_preempt = 1;
+}
+void host_signal_timer1() {
+  pthread_kill(main_thread,SIGUSR1);
+}
+
+// ##########################################################################
+// ###                          Virtual time                              ###
+// ##########################################################################
+
+/** Tick of the next compare interrupt of timer 0 channel c, which counts with clk/64. */
+static uint64_t timer0_due(int c) {
+  uint64_t now = host_ticks>>6;
+  if(now<=timer0_last[c]) now = timer0_last[c]+1;
+  uint8_t ocr = (c==0 ? OCR0A : OCR0B);
+  return (now+(uint8_t)(ocr-(uint8_t)now))<<6;
+}
+void host_advance(uint32_t ticks) {
+  uint64_t target = host_ticks+ticks;
+  if(host_in_isr || host_preempt) {
+    host_ticks = target;
+    return;
+  }
+  while(1) {
+    if(!host_irq_enabled) break;
+    if(pcint_pending) {
+      pcint_pending = 0;
+      if(PCINT0_vect) run_isr(PCINT0_vect);
+      continue;
+    }
+    // Find the next interrupt
+    int next = -1;
+    uint64_t due = target;
+    if((TIMSK1 & (1<<OCIE1A)) && (TCCR1B & 7) && timer1_start+OCR1A<=due) {
+      due = timer1_start+OCR1A;
+      next = 0;
+    }
+    if(TIMER0_COMPA_vect && (TIMSK0 & (1<<OCIE0A)) && timer0_due(0)<due) {
+      due = timer0_due(0);
+      next = 1;
+    }
+    if(TIMER0_COMPB_vect && (TIMSK0 & (1<<OCIE0B)) && timer0_due(1)<due) {
+      due = timer0_due(1);
+      next = 2;
+    }
+    if(next<0) break;
+    if(host_ticks<due) host_ticks = due;
+    if(next==0) {
+      timer1_start = due+1; // CTC mode restarts the counter after the match
+      if(host_ticks<timer1_start) host_ticks = timer1_start;
+      run_timer1();
+    } else {
+      timer0_last[next-1] = due>>6;
+      run_isr(next==1 ? TIMER0_COMPA_vect : TIMER0_COMPB_vect);
+    }
+  }
+  if(host_ticks<target) host_ticks = target;
+}
+uint64_t host_real_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (uint64_t)ts.tv_sec*1000000000ULL+ts.tv_nsec;
+}
+uint64_t host_main_ns() {
+  return host_real_ns()-host_isr_ns;
+}
+void host_poll() {
+  static uint64_t last = 0;
+  if(host_in_isr || host_preempt) return;
+  uint32_t ticks = host_poll_ticks;
+  if(host_cpu_scale) {
+    uint64_t now = host_real_ns();
+    if(last) ticks += (now-last)*host_cpu_scale/1000;
+  }
+  host_advance(ticks);
+  if(host_cpu_scale) last = host_real_ns(); // interrupt time is already counted by the clock
+}
+HostTCNT1::operator uint16_t() const {
+  return (uint16_t)(host_ticks-timer1_start);
+}
+HostTCNT1 &HostTCNT1::operator=(uint16_t v) {
+  timer1_start = host_ticks-v;
+  return *this;
+}
+
+// ##########################################################################
+// ###                           I/O ports                                ###
+// ##########################################################################
+
+HostPort host_port[HOST_PORTS] = {{0,0},{0,1},{0,2},{0,3},{0,4},{0,5},{0,6},{0,7},{0,8},{0,9},{0,10}};
+HostPin host_pin[HOST_PORTS] = {{0},{1},{2},{3},{4},{5},{6},{7},{8},{9},{10}};
+volatile uint8_t host_ddr[HOST_PORTS];
+volatile uint8_t host_input[HOST_PORTS] = {255,255,255,255,255,255,255,255,255,255,255}; // open inputs read high like with pull ups
+uint8_t host_trace_mask[HOST_PORTS];
+void (*host_pin_hook)(uint8_t port,uint8_t bit,uint8_t level) = 0;
+
+HostPort &HostPort::operator=(uint8_t v) {
+  uint8_t changed = (value^v) & host_trace_mask[index];
+  value = v;
+  if(changed && host_pin_hook)
+    for(uint8_t b=0;b<8;b++)
+      if(changed & (1<<b)) host_pin_hook(index,b,(v>>b) & 1);
+  return *this;
+}
+HostPin::operator uint8_t() const {
+  return (host_port[index].value & host_ddr[index]) | (host_input[index] & ~host_ddr[index]);
+}
+HostPin &HostPin::operator=(uint8_t v) {
+  host_port[index] ^= v;
+  return *this;
+}
+
+#define HOST_PIN(n) {(int)(&DIO##n##_WPORT-host_port),DIO##n##_PIN}
+static const struct {int port,bit;} host_pins[] = {
+  HOST_PIN(0),HOST_PIN(1),HOST_PIN(2),HOST_PIN(3),HOST_PIN(4),HOST_PIN(5),HOST_PIN(6),HOST_PIN(7),
+  HOST_PIN(8),HOST_PIN(9),HOST_PIN(10),HOST_PIN(11),HOST_PIN(12),HOST_PIN(13),HOST_PIN(14),HOST_PIN(15),
+  HOST_PIN(16),HOST_PIN(17),HOST_PIN(18),HOST_PIN(19),HOST_PIN(20),HOST_PIN(21),HOST_PIN(22),HOST_PIN(23),
+  HOST_PIN(24),HOST_PIN(25),HOST_PIN(26),HOST_PIN(27),HOST_PIN(28),HOST_PIN(29),HOST_PIN(30),HOST_PIN(31),
+  HOST_PIN(32),HOST_PIN(33),HOST_PIN(34),HOST_PIN(35),HOST_PIN(36),HOST_PIN(37),HOST_PIN(38),HOST_PIN(39),
+  HOST_PIN(40),HOST_PIN(41),HOST_PIN(42),HOST_PIN(43),HOST_PIN(44),HOST_PIN(45),HOST_PIN(46),HOST_PIN(47),
+  HOST_PIN(48),HOST_PIN(49),HOST_PIN(50),HOST_PIN(51),HOST_PIN(52),HOST_PIN(53),HOST_PIN(54),HOST_PIN(55),
+  HOST_PIN(56),HOST_PIN(57),HOST_PIN(58),HOST_PIN(59),HOST_PIN(60),HOST_PIN(61),HOST_PIN(62),HOST_PIN(63),
+  HOST_PIN(64),HOST_PIN(65),HOST_PIN(66),HOST_PIN(67),HOST_PIN(68),HOST_PIN(69),
+#if MOTHERBOARD != 12
+  HOST_PIN(70),HOST_PIN(71),HOST_PIN(72),HOST_PIN(73),HOST_PIN(74),HOST_PIN(75),HOST_PIN(76),HOST_PIN(77),
+  HOST_PIN(78),HOST_PIN(79),HOST_PIN(80),HOST_PIN(81)
+#endif
+};
+#define HOST_NUM_PINS (int)(sizeof(host_pins)/sizeof(host_pins[0]))
+
+int host_pin_port(int pin) {
+  return (pin<0 || pin>=HOST_NUM_PINS ? -1 : host_pins[pin].port);
+}
+int host_pin_bit(int pin) {
+  return (pin<0 || pin>=HOST_NUM_PINS ? -1 : host_pins[pin].bit);
+}
+int host_pcint_group(uint8_t pin) {
+  int port = host_pin_port(pin);
+  if(port==1) return 0; // PB0-7 = PCINT0-7
+  if(port==4 && host_pin_bit(pin)==0) return 1; // PE0 = PCINT8
+  if(port==8 && host_pin_bit(pin)<7) return 1; // PJ0-6 = PCINT9-15
+  if(port==9) return 2; // PK0-7 = PCINT16-23
+  return -1;
+}
+int host_pcint_bit(uint8_t pin) {
+  int port = host_pin_port(pin);
+  return (port==8 ? host_pin_bit(pin)+1 : host_pin_bit(pin));
+}
+volatile uint8_t *host_pcmsk(int group) {
+  return (group==0 ? &PCMSK0 : (group==1 ? &PCMSK1 : &PCMSK2));
+}
+void host_set_input(int pin,uint8_t level) {
+  int port = host_pin_port(pin);
+  if(port<0) return;
+  uint8_t mask = 1<<host_pin_bit(pin);
+  uint8_t old = host_input[port];
+  if(level) host_input[port] |= mask; else host_input[port] &= ~mask;
+  int group = host_pcint_group(pin);
+  if(old!=host_input[port] && group>=0 && (PCICR & (1<<group)) && (*host_pcmsk(group) & (1<<host_pcint_bit(pin))))
+    pcint_pending = 1;
+}
+uint8_t host_get_output(int pin) {
+  int port = host_pin_port(pin);
+  if(port<0) return 0;
+  return (host_port[port].value>>host_pin_bit(pin)) & 1;
+}
+
+// ##########################################################################
+// ###                         Arduino core                               ###
+// ##########################################################################
+
+unsigned long millis(void) {
+  host_poll();
+  return host_ticks/(F_CPU/1000);
+}
+unsigned long micros(void) {
+  host_poll();
+  return host_ticks/(F_CPU/1000000);
+}
+void delay(unsigned long ms) {
+  host_advance(ms*(F_CPU/1000));
+}
+void delayMicroseconds(unsigned int us) {
+  host_advance(us*(F_CPU/1000000));
+}
+void pinMode(uint8_t pin,uint8_t mode) {
+  int port = host_pin_port(pin);
+  if(port<0) return;
+  if(mode==OUTPUT) host_ddr[port] |= 1<<host_pin_bit(pin); else host_ddr[port] &= ~(1<<host_pin_bit(pin));
+}
+void digitalWrite(uint8_t pin,uint8_t val) {
+  int port = host_pin_port(pin);
+  if(port<0) return;
+  if(val) host_port[port] |= 1<<host_pin_bit(pin); else host_port[port] &= ~(1<<host_pin_bit(pin));
+}
+int digitalRead(uint8_t pin) {
+  int port = host_pin_port(pin);
+  if(port<0) return 0;
+  return (host_pin[port]>>host_pin_bit(pin)) & 1;
+}
+int analogRead(uint8_t pin) {
+  return host_adc_value;
+}
+void analogWrite(uint8_t pin,int val) {
+  digitalWrite(pin,val>127);
+}
+
+void HardwareSerial::begin(unsigned long baud) {}
+void HardwareSerial::end() {}
+int HardwareSerial::available(void) {
+  host_poll();
+  return host_serial_in_len-host_serial_in_pos;
+}
+int HardwareSerial::peek(void) {
+  return (host_serial_in_pos<host_serial_in_len ? (uint8_t)host_serial_in[host_serial_in_pos] : -1);
+}
+int HardwareSerial::read(void) {
+  return (host_serial_in_pos<host_serial_in_len ? (uint8_t)host_serial_in[host_serial_in_pos++] : -1);
+}
+void HardwareSerial::flush(void) {}
+size_t HardwareSerial::write(uint8_t c) {
+  if(host_serial_out) host_serial_out(c);
+  return 1;
+}
+
+size_t Print::write(const char *str) {
+  return write((const uint8_t *)str,strlen(str));
+}
+size_t Print::write(const uint8_t *buffer,size_t size) {
+  size_t n = 0;
+  while(size--) n += write(*buffer++);
+  return n;
+}
+size_t Print::print(const char str[]) {return write(str);}
+size_t Print::print(char c) {return write((uint8_t)c);}
+size_t Print::print(unsigned char b,int base) {return print((unsigned long)b,base);}
+size_t Print::print(int n,int base) {return print((long)n,base);}
+size_t Print::print(unsigned int n,int base) {return print((unsigned long)n,base);}
+size_t Print::print(long n,int base) {
+  if(n<0 && base==DEC)
+    return print('-')+printNumber(-n,base);
+  return printNumber(n,base);
+}
+size_t Print::print(unsigned long n,int base) {return printNumber(n,base);}
+size_t Print::print(double n,int digits) {return printFloat(n,digits);}
+size_t Print::println(void) {return print('\r')+print('\n');}
+size_t Print::println(const char c[]) {return print(c)+println();}
+size_t Print::println(char c) {return print(c)+println();}
+size_t Print::println(unsigned char b,int base) {return print(b,base)+println();}
+size_t Print::println(int n,int base) {return print(n,base)+println();}
+size_t Print::println(unsigned int n,int base) {return print(n,base)+println();}
+size_t Print::println(long n,int base) {return print(n,base)+println();}
+size_t Print::println(unsigned long n,int base) {return print(n,base)+println();}
+size_t Print::println(double n,int digits) {return print(n,digits)+println();}
+size_t Print::printNumber(unsigned long n,uint8_t base) {
+  char buf[8*sizeof(long)+1];
+  char *str = &buf[sizeof(buf)-1];
+  *str = 0;
+  if(base<2) base = 10;
+  do {
+    unsigned long m = n;
+    n /= base;
+    char c = m-base*n;
+    *--str = c<10 ? c+'0' : c+'A'-10;
+  } while(n);
+  return write(str);
+}
+size_t Print::printFloat(double number,uint8_t digits) {
+  char buf[40];
+  snprintf(buf,sizeof(buf),"%.*f",digits,number);
+  return write(buf);
+}
+
+// Heap symbols of avr-libc, used by SdFatUtil::FreeRam
+namespace SdFatUtil {
+int __bss_end;
+int *__brkval = 0;
+}
@@ -0,0 +1,184 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Stub hardware layer for the host build. The registers of the ATmega2560 used by the firmware
+  are emulated, time is a virtual cycle counter at F_CPU. See Makefile for the programs using it.
+*/
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+
+// SdFat has its own fpos_t
+#define fpos_t sd_fpos_t
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// ##########################################################################
+// ###                          Virtual time                              ###
+// ##########################################################################
+
+/** Virtual CPU cycles since start. */
+extern volatile uint64_t host_ticks;
+/** Cycles charged to the main program for every serial poll, millis() or micros() call. */
+extern uint32_t host_poll_ticks;
+/** If nonzero, real main program time in ns is scaled with host_cpu_scale/1000 and charged as cycles. */
+extern uint32_t host_cpu_scale;
+/** Cycles charged for every timer 1 interrupt, models the interrupt cost. */
+extern uint32_t host_isr_ticks;
+/** Advance the clock by ticks cycles and run the interrupts due in that time. */
+extern void host_advance(uint32_t ticks);
+/** Called from the polling points of the main program. */
+extern void host_poll();
+/** Nanoseconds of real time, used for benchmarks. */
+extern uint64_t host_real_ns();
+/** If set, the real time spent in interrupt routines is summed up in host_isr_ns. */
+extern byte host_time_isr;
+extern volatile uint64_t host_isr_ns;
+/** Nanoseconds of real time spent outside of interrupt routines, needs host_time_isr. */
+extern uint64_t host_main_ns();
+/** Called before and after every timer 1 interrupt, if set. */
+extern void (*host_timer1_prehook)();
+extern void (*host_timer1_hook)();
+/** Called by the path planner with planner_busy set, after it committed lines, if set. */
+extern void (*host_planner_hook)();
+
+// ##########################################################################
+// ###                           Interrupts                               ###
+// ##########################################################################
+
+extern volatile byte host_irq_enabled;
+extern volatile byte host_in_isr;
+/** With host_preempt set, interrupts are raised from another thread by signals instead of the virtual clock. */
+extern volatile byte host_preempt;
+extern void host_cli();
+extern void host_sei();
+/** Runs timer 1 interrupt now or as soon as interrupts get enabled. Used by the signal handler. */
+extern void host_raise_timer1();
+/** Install a signal handler, so host_signal_timer1 from another thread preempts the main thread. */
+extern void host_preempt_init();
+extern void host_signal_timer1();
+
+/** Status register, only the interrupt flag is emulated. */
+struct HostSREG {
+  operator uint8_t() const {return host_irq_enabled ? 0x80 : 0;}
+  HostSREG &operator=(uint8_t v) {if(v & 0x80) host_sei(); else host_cli();return *this;}
+};
+extern HostSREG SREG;
+
+// ##########################################################################
+// ###                           I/O ports                                ###
+// ##########################################################################
+
+#define HOST_PORTS 11
+/** Output register of a port. Writes are recorded for traced pins. */
+struct HostPort {
+  uint8_t value;
+  uint8_t index;
+  operator uint8_t() const {return value;}
+  HostPort &operator=(uint8_t v);
+  // int like the register operands on the AVR, ~MASK(pin) is negative
+  HostPort &operator|=(int v) {return *this = (uint8_t)(value | v);}
+  HostPort &operator&=(int v) {return *this = (uint8_t)(value & v);}
+  HostPort &operator^=(int v) {return *this = (uint8_t)(value ^ v);}
+};
+/** Input register of a port. Outputs read back their level, inputs host_input. Writing 1 toggles the output. */
+struct HostPin {
+  uint8_t index;
+  operator uint8_t() const;
+  HostPin &operator=(uint8_t v);
+};
+extern HostPort host_port[HOST_PORTS];
+extern HostPin host_pin[HOST_PORTS];
+extern volatile uint8_t host_ddr[HOST_PORTS];
+/** Levels of the input pins. */
+extern volatile uint8_t host_input[HOST_PORTS];
+/** Bits of the ports, whose changes get passed to host_pin_hook. */
+extern uint8_t host_trace_mask[HOST_PORTS];
+/** Called for changes of traced pins with the port, the bit and the new level. */
+extern void (*host_pin_hook)(uint8_t port,uint8_t bit,uint8_t level);
+
+/** Port index and bit of an arduino pin number, -1 if the pin doesn't exist. */
+extern int host_pin_port(int pin);
+extern int host_pin_bit(int pin);
+/** Set the level of an input pin. */
+extern void host_set_input(int pin,uint8_t level);
+/** Level of an output pin. */
+extern uint8_t host_get_output(int pin);
+
+// ##########################################################################
+// ###                       Registers with function                      ###
+// ##########################################################################
+
+/** Timer 1 counter, counts from the last compare match in CTC mode. */
+struct HostTCNT1 {
+  operator uint16_t() const;
+  HostTCNT1 &operator=(uint16_t v);
+};
+extern HostTCNT1 TCNT1;
+/** 8 bit register, which always reads the bits in ones set. Used for ready flags of SPI and TWI. */
+struct HostReadyReg {
+  uint8_t value;
+  uint8_t ones;
+  operator uint8_t() const {return value | ones;}
+  HostReadyReg &operator=(uint8_t v) {value = v;return *this;}
+  HostReadyReg &operator|=(uint8_t v) {value |= v;return *this;}
+  HostReadyReg &operator&=(uint8_t v) {value &= v;return *this;}
+};
+/** ADC control register A, a started conversion is finished at once. */
+struct HostADCSRA {
+  uint8_t value;
+  operator uint8_t() const {return value & ~(1<<6);}
+  HostADCSRA &operator=(uint8_t v) {value = v;return *this;}
+  HostADCSRA &operator|=(uint8_t v) {value |= v;return *this;}
+  HostADCSRA &operator&=(uint8_t v) {value &= v;return *this;}
+};
+extern HostADCSRA ADCSRA;
+extern HostReadyReg SPSR;
+extern HostReadyReg TWCR;
+/** Value all ADC conversions return. */
+extern volatile uint16_t host_adc_value;
+#define ADC host_adc_value
+#define ADCW host_adc_value
+
+// ##########################################################################
+// ###                          EEPROM                                    ###
+// ##########################################################################
+
+#define HOST_EEPROM_SIZE 4096
+extern uint8_t host_eeprom[HOST_EEPROM_SIZE];
+
+// ##########################################################################
+// ###                       Serial connection                            ###
+// ##########################################################################
+
+/** Serial input comes from this buffer. Output goes to host_serial_out, if set. */
+extern const char *host_serial_in;
+extern size_t host_serial_in_len;
+extern size_t host_serial_in_pos;
+extern void (*host_serial_out)(uint8_t c);
+
+#endif
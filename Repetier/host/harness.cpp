@@ -0,0 +1,120 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+extern void setup();
+extern void loop();
+extern volatile byte gcode_buflen;
+
+static char *gcode_text = 0;
+
+static void echo_out(uint8_t c) {
+  if(c!='\r') putchar(c);
+}
+static void set_text(char *text,size_t len) {
+  free(gcode_text);
+  gcode_text = text;
+  host_serial_in = text;
+  host_serial_in_len = len;
+  host_serial_in_pos = 0;
+}
+bool host_load_gcode(const char *filename) {
+  FILE *f = fopen(filename,"rb");
+  if(!f) return false;
+  fseek(f,0,SEEK_END);
+  long len = ftell(f);
+  fseek(f,0,SEEK_SET);
+  char *text = (char*)malloc(len+2);
+  len = fread(text,1,len,f);
+  fclose(f);
+  text[len++] = '\n'; // the last line needs an end
+  set_text(text,len);
+  return true;
+}
+void host_set_gcode(const char *text) {
+  size_t len = strlen(text);
+  char *copy = (char*)malloc(len+2);
+  memcpy(copy,text,len);
+  copy[len++] = '\n';
+  set_text(copy,len);
+}
+void host_set_endstop(int pin,bool inverting,bool triggered) {
+  if(pin>-1) host_set_input(pin,triggered ? !inverting : inverting);
+}
+void host_start(bool echo) {
+  memset(host_eeprom,255,sizeof(host_eeprom));
+  host_serial_out = (echo ? echo_out : 0);
+#if X_MIN_PIN>-1
+  host_set_endstop(X_MIN_PIN,ENDSTOP_X_MIN_INVERTING,false);
+#endif
+#if Y_MIN_PIN>-1
+  host_set_endstop(Y_MIN_PIN,ENDSTOP_Y_MIN_INVERTING,false);
+#endif
+#if Z_MIN_PIN>-1
+  host_set_endstop(Z_MIN_PIN,ENDSTOP_Z_MIN_INVERTING,false);
+#endif
+#if X_MAX_PIN>-1
+  host_set_endstop(X_MAX_PIN,ENDSTOP_X_MAX_INVERTING,false);
+#endif
+#if Y_MAX_PIN>-1
+  host_set_endstop(Y_MAX_PIN,ENDSTOP_Y_MAX_INVERTING,false);
+#endif
+#if Z_MAX_PIN>-1
+  host_set_endstop(Z_MAX_PIN,ENDSTOP_Z_MAX_INVERTING,false);
+#endif
+  setup();
+}
+volatile long host_counted_steps[3];
+static int step_port[3],step_bit[3],dir_port[3],dir_bit[3];
+static byte dir_level[3];
+static const bool dir_inverted[3] = {INVERT_X_DIR,INVERT_Y_DIR,INVERT_Z_DIR};
+
+static void count_pin(uint8_t port,uint8_t bit,uint8_t level) {
+  for(int i=0;i<3;i++) {
+    if(port==dir_port[i] && bit==dir_bit[i]) dir_level[i] = level;
+    if(port==step_port[i] && bit==step_bit[i] && level)
+      host_counted_steps[i] += ((dir_level[i]!=0)!=dir_inverted[i] ? 1 : -1);
+  }
+}
+void host_count_steps() {
+  const int stepPins[3] = {X_STEP_PIN,Y_STEP_PIN,Z_STEP_PIN};
+  const int dirPins[3] = {X_DIR_PIN,Y_DIR_PIN,Z_DIR_PIN};
+  for(int i=0;i<3;i++) {
+    step_port[i] = host_pin_port(stepPins[i]);
+    step_bit[i] = host_pin_bit(stepPins[i]);
+    dir_port[i] = host_pin_port(dirPins[i]);
+    dir_bit[i] = host_pin_bit(dirPins[i]);
+    host_trace_mask[step_port[i]] |= 1<<step_bit[i];
+    host_trace_mask[dir_port[i]] |= 1<<dir_bit[i];
+    dir_level[i] = (host_port[dir_port[i]]>>dir_bit[i]) & 1;
+    host_counted_steps[i] = 0;
+  }
+  host_pin_hook = count_pin;
+}
+bool host_run(uint64_t maxTicks) {
+  uint64_t end = host_ticks+maxTicks;
+  byte idle = 0;
+  while(host_ticks<end) {
+    loop();
+    if(host_serial_in_pos>=host_serial_in_len && gcode_buflen==0 && lines_count==0) {
+      if(++idle>10) return true; // some loops for held back moves
+    } else idle = 0;
+  }
+  return false;
+}
@@ -0,0 +1,40 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Runs the firmware on the host: feeds G-code as serial input and calls loop() until all moves are done.
+*/
+#ifndef HOST_HARNESS_H
+#define HOST_HARNESS_H
+
+#include "hal.h"
+
+/** Reads a G-code file as serial input. Returns false if it can't be read. */
+extern bool host_load_gcode(const char *filename);
+/** Uses text as serial input. */
+extern void host_set_gcode(const char *text);
+/** Sets all endstops to not triggered and calls setup(). Serial output goes to stdout, if echo is set. */
+extern void host_start(bool echo);
+/** Calls loop() until the input is processed and all moves are finished or maxTicks cycles passed.
+Returns false on timeout. */
+extern bool host_run(uint64_t maxTicks);
+/** Sets the input level of an endstop pin to triggered or not triggered. */
+extern void host_set_endstop(int pin,bool inverting,bool triggered);
+/** Counts the step pulses of the x, y and z steppers (the towers of delta printers) from now on in
+host_counted_steps, +1 for steps in positive direction. Uses host_pin_hook. */
+extern void host_count_steps();
+extern volatile long host_counted_steps[3];
+
+#endif
@@ -0,0 +1,55 @@
+/* Host build: the parts of the Arduino core used by the firmware, implemented in hal.cpp. */
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include "Print.h"
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define sq(x) ((x)*(x))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+typedef unsigned int word;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin,uint8_t mode);
+void digitalWrite(uint8_t pin,uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin,int val);
+inline void tone(uint8_t pin,unsigned int frequency,unsigned long duration = 0) {}
+inline void noTone(uint8_t pin) {}
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud);
+  void end();
+  int available(void);
+  int peek(void);
+  int read(void);
+  void flush(void);
+  virtual size_t write(uint8_t c);
+  using Print::write;
+  operator bool() {return true;}
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,2 @@
+/* Host build: pre 1.0 name of Arduino.h */
+#include "Arduino.h"
@@ -0,0 +1,25 @@
+/* Host build: the EEPROM is a RAM array, see hal.cpp. */
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include "../../hal.h"
+
+#define EEMEM
+
+inline uint8_t eeprom_read_byte(const void *p) {return host_eeprom[(size_t)p];}
+inline uint16_t eeprom_read_word(const void *p) {uint16_t v;memcpy(&v,&host_eeprom[(size_t)p],2);return v;}
+inline uint32_t eeprom_read_dword(const void *p) {uint32_t v;memcpy(&v,&host_eeprom[(size_t)p],4);return v;}
+inline float eeprom_read_float(const void *p) {float v;memcpy(&v,&host_eeprom[(size_t)p],4);return v;}
+inline void eeprom_read_block(void *dst,const void *src,size_t n) {memcpy(dst,&host_eeprom[(size_t)src],n);}
+inline void eeprom_write_byte(void *p,uint8_t v) {host_eeprom[(size_t)p] = v;}
+inline void eeprom_write_word(void *p,uint16_t v) {memcpy(&host_eeprom[(size_t)p],&v,2);}
+inline void eeprom_write_dword(void *p,uint32_t v) {memcpy(&host_eeprom[(size_t)p],&v,4);}
+inline void eeprom_write_float(void *p,float v) {memcpy(&host_eeprom[(size_t)p],&v,4);}
+inline void eeprom_write_block(const void *src,void *dst,size_t n) {memcpy(&host_eeprom[(size_t)dst],src,n);}
+#define eeprom_update_byte eeprom_write_byte
+#define eeprom_update_word eeprom_write_word
+#define eeprom_update_dword eeprom_write_dword
+#define eeprom_update_float eeprom_write_float
+#define eeprom_update_block eeprom_write_block
+
+#endif
@@ -0,0 +1,14 @@
+/* Host build: interrupt control, see hal.cpp. */
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include "io.h"
+
+#define cli() host_cli()
+#define sei() host_sei()
+#define ISR(vector,...) extern "C" void vector(void)
+#define ISR_ALIASOF(vector)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+
+#endif
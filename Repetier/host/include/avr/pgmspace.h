@@ -0,0 +1,26 @@
+/* Host build: program memory is normal memory. */
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_byte_near(p) (*(const uint8_t *)(p))
+// Words and double words read the element type, pointers in tables are 64 bit here
+template<typename T> inline T host_pgm_read(const T *p) {return *p;}
+inline uint16_t host_pgm_read(const void *p) {return *(const uint16_t *)p;}
+#define pgm_read_word(p) host_pgm_read(p)
+#define pgm_read_word_near(p) host_pgm_read(p)
+#define pgm_read_dword(p) host_pgm_read(p)
+#define pgm_read_float(p) (*(const float *)(p))
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+
+#endif
@@ -0,0 +1,16 @@
+/* Host build: TWI status codes. Nothing is connected, so transfers are answered by nobody. */
+#ifndef HOST_COMPAT_TWI_H
+#define HOST_COMPAT_TWI_H
+
+#include <avr/io.h>
+
+#define TW_STATUS (TWSR & 0xF8)
+#define TW_START 0x08
+#define TW_REP_START 0x10
+#define TW_MT_SLA_ACK 0x18
+#define TW_MT_SLA_NACK 0x20
+#define TW_MT_DATA_ACK 0x28
+#define TW_MR_SLA_ACK 0x40
+#define TW_MR_DATA_NACK 0x58
+
+#endif
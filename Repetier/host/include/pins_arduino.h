@@ -0,0 +1,17 @@
+/* Host build: pin change interrupt mapping of the ATmega2560, implemented in hal.cpp. */
+#ifndef HOST_PINS_ARDUINO_H
+#define HOST_PINS_ARDUINO_H
+
+#include <avr/io.h>
+
+/** Pin change interrupt group 0-2 of an arduino pin, -1 if it has none. */
+extern int host_pcint_group(uint8_t pin);
+extern int host_pcint_bit(uint8_t pin);
+extern volatile uint8_t *host_pcmsk(int group);
+
+#define digitalPinToPCICR(p) (host_pcint_group(p)<0 ? (volatile uint8_t *)0 : &PCICR)
+#define digitalPinToPCICRbit(p) (host_pcint_group(p))
+#define digitalPinToPCMSK(p) (host_pcmsk(host_pcint_group(p)))
+#define digitalPinToPCMSKbit(p) (host_pcint_bit(p))
+
+#endif
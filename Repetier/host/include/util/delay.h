@@ -0,0 +1,10 @@
+/* Host build: busy waits advance the virtual clock. */
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#include "../../hal.h"
+
+#define _delay_us(us) host_advance((uint32_t)((us)*(F_CPU/1000000UL)))
+#define _delay_ms(ms) host_advance((uint32_t)((ms)*(F_CPU/1000UL)))
+
+#endif
@@ -0,0 +1,72 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Main loop latency while moves are streamed. After homing, long moves that fill the move cache and
+  the delta segment cache alternate with short ones. The virtual time of every loop() call is measured.
+  Queueing a G0/G1 must not wait for free cache entries, loop() has to return and read the next commands.
+  The longest calls left are display refreshes of about 27 ms.
+
+  Usage: loopwait [max_ms]
+
+  Returns 1 if a loop() call takes longer than max_ms (default 50) milliseconds.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+extern void loop();
+extern volatile byte gcode_buflen;
+
+int main(int argc,char **argv) {
+  double max_ms = (argc>1 ? atof(argv[1]) : 50);
+  host_set_gcode("G28\nG90\nG1 Z5 F6000");
+  host_start(false);
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  char gcode[20000],*pos = gcode;
+  for(int layer=0;layer<3;layer++) {
+    pos += sprintf(pos,"G1 X-60 Y-60 F6000\nG1 X60 Y-60\nG1 X60 Y60\nG1 X-60 Y60\nG1 X-60 Y-60\n");
+    for(int i=0;i<=60;i++) {
+      double a = i*2*M_PI/60;
+      pos += sprintf(pos,"G1 X%.3f Y%.3f F3000\n",20*cos(a),20*sin(a));
+    }
+  }
+  host_set_gcode(gcode);
+  uint64_t longest = 0,start = host_ticks,end = host_ticks+F_CPU*600ULL;
+  unsigned long loops = 0;
+  byte idle = 0;
+  while(host_ticks<end && idle<=10) {
+    uint64_t before = host_ticks;
+    loop();
+    loops++;
+    if(host_ticks-before>longest) longest = host_ticks-before;
+    if(host_serial_in_pos>=host_serial_in_len && gcode_buflen==0 && lines_count==0) idle++;
+    else idle = 0;
+  }
+  double ms = longest*1000.0/F_CPU;
+  printf("Loops: %lu in %.3f s, longest loop() call: %.3f ms\n",loops,(double)(host_ticks-start)/F_CPU,ms);
+  if(idle<=10) {
+    fprintf(stderr,"Timeout, moves not finished\n");
+    return 1;
+  }
+  if(ms>max_ms) {
+    fprintf(stderr,"loop() blocked longer than %.3f ms\n",max_ms);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Path planner benchmark. Prints a G-code file on the host build and reports the planning time
+  per line, the lines planned per second of planning time, the move cache occupancy, how often
+  MOVE_BUFFER_HORIZON slowed down lines and the planned time of the print.
+
+  Usage: planbench file.gcode [occupancy.csv [interval_ms]]
+
+  The planning time is real time on this computer for the whole path from queue_move/split_delta_move
+  to the queued line, without waits for a free cache entry and without interrupt routines. It compares
+  planner versions, it is not the time on the AVR. This computer has a FPU and the AVR has none, so
+  here the float planner (stats variant) is much faster compared to the integer planner (fixedstats
+  variant, FIXED_POINT_PLANNER) than on the AVR. The print itself runs in virtual time, so the
+  occupancy is the one of the real printer, as far as the main loop is not slower there.
+  The csv file gets one row per interval of printing time: time [ms], lines in the cache and
+  buffered move time [ms].
+  The planned time is the sum of the times of the speed profiles of all lines, as they are when the
+  stepper interrupt starts the line. It compares the cornering models (see JUNCTION_MODEL), the
+  printing time also contains the time lost by stepping.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+extern PrintLine *cur;
+static FILE *csv = 0;
+static uint64_t sample_ticks = F_CPU/100;
+static uint64_t next_sample = 0;
+static PrintLine *last_line = 0;
+static double planned_time = 0;
+
+/** Time of the trapezoidal speed profile of a line in seconds. */
+static double profile_time(PlanLine *pl) {
+  double v0 = PLANNER_TO_FLOAT(pl->startSpeed),v1 = PLANNER_TO_FLOAT(pl->endSpeed);
+  double vf = PLANNER_TO_FLOAT(PLANNER_FULL_SPEED(pl)),d = pl->distance;
+  if(d<=0 || vf<=0) return 0;
+  double a = PLANNER2_TO_FLOAT(pl->acceleration)/(2.0*d);
+  double up = (vf*vf-v0*v0)/(2.0*a),down = (vf*vf-v1*v1)/(2.0*a);
+  if(up+down<=d)
+    return (vf-v0)/a+(vf-v1)/a+(d-up-down)/vf;
+  double vp = sqrt(a*d+0.5*(v0*v0+v1*v1)); // Full speed is not reached
+  return (vp-v0)/a+(vp-v1)/a;
+}
+
+static void sample() {
+  if(cur && cur!=last_line) { // The stepper interrupt started a new line
+    last_line = cur;
+    if(!(cur->flags & FLAG_WARMUP)) planned_time += profile_time(PLAN_LINE(lines_pos));
+  }
+  if(!csv) return;
+  while(host_ticks>=next_sample) {
+    fprintf(csv,"%.0f,%d,%.1f\n",(double)next_sample*1000.0/F_CPU,(int)lines_count,(double)lines_ticks*1000.0/F_CPU);
+    next_sample += sample_ticks;
+  }
+}
+
+int main(int argc,char **argv) {
+  if(argc<2 || !host_load_gcode(argv[1])) {
+    fprintf(stderr,"Usage: %s file.gcode [occupancy.csv [interval_ms]]\n",argv[0]);
+    return 2;
+  }
+  if(argc>2) {
+    csv = fopen(argv[2],"w");
+    if(!csv) {
+      fprintf(stderr,"Can't write %s\n",argv[2]);
+      return 2;
+    }
+    if(argc>3) sample_ticks = atol(argv[3])*(F_CPU/1000);
+    fprintf(csv,"time_ms,lines,buffered_ms\n");
+  }
+  host_timer1_hook = sample;
+  host_time_isr = 1;
+  host_start(false);
+  uint64_t start = host_real_ns();
+  bool done = host_run(F_CPU*36000ULL);
+  double total = (double)(host_real_ns()-start);
+  if(csv) fclose(csv);
+  printf("Planned lines: %lu\n",planner_stats.moves);
+  if(planner_stats.moves) {
+    printf("Planning time per line [ns]: %.0f\n",(double)planner_stats.planTime/planner_stats.moves);
+    printf("Planned lines per second: %.0f\n",1e9*planner_stats.moves/planner_stats.planTime);
+  }
+  printf("Max. planning time of a line [ns]: %ld\n",planner_stats.maxPlanTime);
+  printf("Planning share of the run time: %.1f %%\n",100.0*planner_stats.planTime/total);
+  printf("Cache low slowdowns: %lu\n",planner_stats.slowdowns);
+  printf("Buffer starvations: %lu\n",buffer_starvations);
+  printf("Planned time [s]: %.3f\n",planned_time);
+  printf("Printing time [s]: %.3f\n",(double)host_ticks/F_CPU);
+  printf("Cache occupancy when adding a line:");
+  for(byte i=0;i<=MOVE_CACHE_SIZE;i++)
+    printf(" %lu",planner_stats.occupancy[i]);
+  printf("\n");
+  if(!done) fprintf(stderr,"Timeout, print not finished\n");
+  return done ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Stress test of the handoff between path planner and stepper interrupt. After homing, short random
+  moves are printed with the stepper interrupt raised by signals from a second thread (see
+  host_preempt_init), so it interrupts the path planner at any point, not only at polling points.
+  While planner_busy is set, the signals come without pause. Every HOLD_EVERY planner run is held
+  busy after it committed its lines, until the interrupt ran out of committed lines and had to wait
+  for the planner (counted in planner_stalls), so the stall and retry path runs. The step pulses of
+  the towers are counted and must match the position the firmware computed.
+
+  Usage: preemptstress [moves [signal_period_us]]
+
+  Defaults are 500 moves and a signal every 5 us. Returns 1 if the steps don't match, the interrupt
+  never stalled or the moves don't finish.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+
+#define HOLD_EVERY 10            // Planner runs between held runs
+#define HOLD_STALLS 3            // Stalls to wait for in a held run
+#define HOLD_TIMEOUT_NS 50000000 // Real time limit of a held run
+
+static volatile bool stop = false;
+static long signal_period_ns = 5000;
+static long planner_runs = 0,held_runs = 0;
+/** Keeps every HOLD_EVERY planner run busy, until the interrupt stalled HOLD_STALLS times. */
+static void hold_planner() {
+  if(++planner_runs%HOLD_EVERY) return;
+  held_runs++;
+  unsigned long stalls = planner_stalls;
+  uint64_t start = host_real_ns();
+  struct timespec ts = {0,1000};
+  while(planner_stalls-stalls<HOLD_STALLS && host_real_ns()-start<HOLD_TIMEOUT_NS)
+    nanosleep(&ts,0); // lets the signal thread run, also with one CPU
+}
+static void *signaller(void *) {
+  struct timespec ts = {0,signal_period_ns};
+  while(!stop) {
+    host_signal_timer1();
+    if(!planner_busy) nanosleep(&ts,0); // drain the committed lines while the planner runs
+  }
+  return 0;
+}
+
+int main(int argc,char **argv) {
+  int moves = argc>1 ? atoi(argv[1]) : 500;
+  if(argc>2) signal_period_ns = atol(argv[2])*1000;
+  host_set_gcode("G28\nG90\nG1 X0 Y0 Z10 F6000\n");
+  host_start(false);
+  if(!host_run(F_CPU*600ULL)) {
+    fprintf(stderr,"Timeout while homing\n");
+    return 1;
+  }
+  // Short moves, so the planner runs all the time
+  size_t size = moves*40+100;
+  char *gcode = (char*)malloc(size),*pos = gcode;
+  unsigned long seed = 1;
+  double x = 0,y = 0;
+  for(int i=0;i<moves;i++) {
+    seed = seed*1103515245+12345;
+    double a = (seed>>8)%3600*M_PI/1800.0,l = 0.5+(seed>>4)%30/10.0;
+    x += l*cos(a);
+    y += l*sin(a);
+    if(x*x+y*y>2500) {x = x*0.5;y = y*0.5;}
+    pos += sprintf(pos,"G1 X%.2f Y%.2f F%d\n",x,y,3000+(i%5)*1500);
+  }
+  host_set_gcode(gcode);
+  free(gcode);
+  long start[3];
+  for(int i=0;i<3;i++) start[i] = printer_state.currentDeltaPositionSteps[i];
+  host_count_steps();
+  host_planner_hook = hold_planner;
+  host_preempt_init();
+  pthread_t thread;
+  pthread_create(&thread,0,signaller,0);
+  uint64_t realStart = host_real_ns();
+  bool done = host_run(F_CPU*3600ULL);
+  stop = true;
+  pthread_join(thread,0);
+  host_planner_hook = 0;
+  bool ok = done;
+  const char *names[3] = {"X","Y","Z"};
+  for(int i=0;i<3;i++) {
+    long expected = printer_state.currentDeltaPositionSteps[i]-start[i];
+    printf("%s steps: %ld, expected %ld\n",names[i],(long)host_counted_steps[i],expected);
+    if(host_counted_steps[i]!=expected) ok = false;
+  }
+  printf("Planner runs: %ld, held: %ld, stalls: %lu\n",planner_runs,held_runs,(unsigned long)planner_stalls);
+  if(planner_stalls==0) {
+    fprintf(stderr,"The stepper interrupt never waited for the planner\n");
+    ok = false;
+  }
+  printf("Printing time [s]: %.3f, real time [s]: %.3f\n",(double)host_ticks/F_CPU,(host_real_ns()-realStart)*1e-9);
+  if(!done) fprintf(stderr,"Timeout, moves not finished\n");
+  if(!ok) fprintf(stderr,"Preempt stress test failed\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,34 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Runs a G-code file on the host build and prints the serial output.
+
+  Usage: repetier file.gcode
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include <stdio.h>
+
+int main(int argc,char **argv) {
+  if(argc<2 || !host_load_gcode(argv[1])) {
+    fprintf(stderr,"Usage: %s file.gcode\n",argv[0]);
+    return 2;
+  }
+  host_start(true);
+  bool done = host_run(F_CPU*3600ULL);
+  printf("Printing time: %.3f s\n",(double)host_ticks/F_CPU);
+  return done ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Step timing simulation. Prints a G-code file on the host build and writes every level change of the
+  step and direction pins with its cycle, together with the planned lines and the progress after each
+  stepper interrupt, to a binary trace (see tracefmt.h). bresenham_step, setTimer and the stepperWait
+  handling of the timer interrupt run unchanged against the emulated TCNT1/OCR1A and ports.
+
+  Usage: steptrace file.gcode trace.bin [isr_cycles]
+
+  isr_cycles is charged for every stepper interrupt, to model a slow interrupt. Analyze the trace with
+  traceanalyze.
+*/
+#include "Reptier.h"
+#include "harness.h"
+#include "tracefmt.h"
+#include <stdio.h>
+
+extern PrintLine *cur;
+
+static FILE *trace = 0;
+static int16_t traced_pin[HOST_PORTS][8]; ///< Arduino pin of a traced port bit
+static int8_t traced_axis[HOST_PORTS][8];
+static PrintLine *pre_cur;
+static byte pre_pos;
+static PrintLine pre_line; ///< Copy of the next line before the interrupt, it may start there
+
+static void write_record(uint8_t kind,uint8_t pin,uint8_t level,uint8_t axis,int32_t value) {
+  TraceRecord r;
+  r.tick = host_ticks;
+  r.kind = kind;
+  r.pin = pin;
+  r.level = level;
+  r.axis = axis;
+  r.value = value;
+  fwrite(&r,sizeof(r),1,trace);
+}
+static void pin_changed(uint8_t port,uint8_t bit,uint8_t level) {
+  write_record(TRACE_PIN,traced_pin[port][bit],level,traced_axis[port][bit],0);
+}
+static void before_isr() {
+  pre_cur = cur;
+  pre_pos = lines_pos;
+  if(cur==0) pre_line = lines[lines_pos];
+}
+static void after_isr() {
+  if(pre_cur==0) {
+    if((cur==0 && lines_pos==pre_pos) || (pre_line.flags & FLAG_WARMUP)) return; // no line started
+    int32_t fields[TRACE_LINE_FIELDS];
+    fields[TRACE_LINE_STEPS] = pre_line.stepsRemaining;
+    fields[TRACE_LINE_VSTART] = pre_line.vStart;
+    fields[TRACE_LINE_VMAX] = pre_line.vMax;
+    fields[TRACE_LINE_VEND] = pre_line.vEnd;
+    fields[TRACE_LINE_ACCEL_STEPS] = pre_line.accelSteps;
+    fields[TRACE_LINE_DECEL_STEPS] = pre_line.decelSteps;
+    fields[TRACE_LINE_PRIMARY] = pre_line.primaryAxis;
+#if PLANNER_CACHE_SIZE<MOVE_CACHE_SIZE
+    fields[TRACE_LINE_DISTANCE] = 0; // The PlanLine entry may belong to a later line already
+#else
+    fields[TRACE_LINE_DISTANCE] = (int32_t)(PLAN_LINE(pre_pos)->distance*1000.0f+0.5f);
+#endif
+    for(int i=0;i<TRACE_LINE_FIELDS;i++)
+      write_record(TRACE_LINE,i,0,0,fields[i]);
+  }
+#if STEPPER_LOOP_SPREAD
+  write_record(TRACE_ISR,0,stepper_loop_count==0,0,cur ? cur->stepsRemaining : 0);
+#else
+  write_record(TRACE_ISR,0,1,0,cur ? cur->stepsRemaining : 0);
+#endif
+}
+static void trace_pin(int pin,int axis) {
+  if(pin<0 || host_pin_port(pin)<0) return;
+  traced_pin[host_pin_port(pin)][host_pin_bit(pin)] = pin;
+  traced_axis[host_pin_port(pin)][host_pin_bit(pin)] = axis;
+  host_trace_mask[host_pin_port(pin)] |= 1<<host_pin_bit(pin);
+}
+
+int main(int argc,char **argv) {
+  if(argc<3 || !host_load_gcode(argv[1])) {
+    fprintf(stderr,"Usage: %s file.gcode trace.bin [isr_cycles]\n",argv[0]);
+    return 2;
+  }
+  trace = fopen(argv[2],"wb");
+  if(!trace) {
+    fprintf(stderr,"Can't write %s\n",argv[2]);
+    return 2;
+  }
+  if(argc>3) host_isr_ticks = atol(argv[3]);
+  TraceHeader h;
+  memset(&h,0,sizeof(h));
+  h.magic = TRACE_MAGIC;
+  h.version = TRACE_VERSION;
+  h.cpuFrequency = F_CPU;
+  const int stepPins[TRACE_AXES] = {X_STEP_PIN,Y_STEP_PIN,Z_STEP_PIN,EXT0_STEP_PIN};
+  const int dirPins[TRACE_AXES] = {X_DIR_PIN,Y_DIR_PIN,Z_DIR_PIN,EXT0_DIR_PIN};
+  const bool inverted[TRACE_AXES] = {INVERT_X_DIR,INVERT_Y_DIR,INVERT_Z_DIR,EXT0_INVERSE};
+  for(int i=0;i<TRACE_AXES;i++) {
+    h.stepPin[i] = stepPins[i];
+    h.dirPin[i] = dirPins[i];
+    h.dirInverted[i] = inverted[i];
+    trace_pin(stepPins[i],i);
+    trace_pin(dirPins[i],TRACE_AXES+i);
+  }
+  host_start(false);
+  for(int i=0;i<TRACE_AXES;i++) h.stepsPerMM[i] = axis_steps_per_unit[i]; // set by setup
+  h.maxJerk = printer_state.maxJerk;
+  for(int i=0;i<3;i++) { // the path acceleration of a diagonal move is the norm of the axis accelerations
+    float a = max(max_acceleration_units_per_sq_second[i],max_travel_acceleration_units_per_sq_second[i]);
+    h.peakAcceleration += a*a;
+  }
+  h.peakAcceleration = sqrt(h.peakAcceleration);
+#ifdef S_CURVE_ACCELERATION
+  h.peakAcceleration *= 100.0f/(100-S_CURVE_JERK_PERCENT);
+#endif
+  fwrite(&h,sizeof(h),1,trace);
+  host_pin_hook = pin_changed;
+  host_timer1_prehook = before_isr;
+  host_timer1_hook = after_isr;
+  bool done = host_run(F_CPU*36000ULL);
+  fclose(trace);
+  printf("Printing time [s]: %.3f\n",(double)host_ticks/F_CPU);
+  if(!done) fprintf(stderr,"Timeout, print not finished\n");
+  return done ? 0 : 1;
+}
@@ -0,0 +1,392 @@
+; Test print for the host build: homing, travel, 3 layers of a circle with short segments and a square
+G28
+G90
+M82
+G92 E0
+G1 Z0.3 F3000
+G1 X20 Y0 F6000
+G1 Z0.30 F3000
+G1 X19.973 Y1.047 E0.0346 F2400
+G1 X19.890 Y2.091 E0.0691 F2400
+G1 X19.754 Y3.129 E0.1037 F2400
+G1 X19.563 Y4.158 E0.1382 F2400
+G1 X19.319 Y5.176 E0.1728 F2400
+G1 X19.021 Y6.180 E0.2073 F2400
+G1 X18.672 Y7.167 E0.2419 F2400
+G1 X18.271 Y8.135 E0.2764 F2400
+G1 X17.820 Y9.080 E0.3110 F2400
+G1 X17.321 Y10.000 E0.3455 F2400
+G1 X16.773 Y10.893 E0.3801 F2400
+G1 X16.180 Y11.756 E0.4146 F2400
+G1 X15.543 Y12.586 E0.4492 F2400
+G1 X14.863 Y13.383 E0.4838 F2400
+G1 X14.142 Y14.142 E0.5183 F2400
+G1 X13.383 Y14.863 E0.5529 F2400
+G1 X12.586 Y15.543 E0.5874 F2400
+G1 X11.756 Y16.180 E0.6220 F2400
+G1 X10.893 Y16.773 E0.6565 F2400
+G1 X10.000 Y17.321 E0.6911 F2400
+G1 X9.080 Y17.820 E0.7256 F2400
+G1 X8.135 Y18.271 E0.7602 F2400
+G1 X7.167 Y18.672 E0.7947 F2400
+G1 X6.180 Y19.021 E0.8293 F2400
+G1 X5.176 Y19.319 E0.8638 F2400
+G1 X4.158 Y19.563 E0.8984 F2400
+G1 X3.129 Y19.754 E0.9329 F2400
+G1 X2.091 Y19.890 E0.9675 F2400
+G1 X1.047 Y19.973 E1.0021 F2400
+G1 X0.000 Y20.000 E1.0366 F2400
+G1 X-1.047 Y19.973 E1.0712 F2400
+G1 X-2.091 Y19.890 E1.1057 F2400
+G1 X-3.129 Y19.754 E1.1403 F2400
+G1 X-4.158 Y19.563 E1.1748 F2400
+G1 X-5.176 Y19.319 E1.2094 F2400
+G1 X-6.180 Y19.021 E1.2439 F2400
+G1 X-7.167 Y18.672 E1.2785 F2400
+G1 X-8.135 Y18.271 E1.3130 F2400
+G1 X-9.080 Y17.820 E1.3476 F2400
+G1 X-10.000 Y17.321 E1.3821 F2400
+G1 X-10.893 Y16.773 E1.4167 F2400
+G1 X-11.756 Y16.180 E1.4513 F2400
+G1 X-12.586 Y15.543 E1.4858 F2400
+G1 X-13.383 Y14.863 E1.5204 F2400
+G1 X-14.142 Y14.142 E1.5549 F2400
+G1 X-14.863 Y13.383 E1.5895 F2400
+G1 X-15.543 Y12.586 E1.6240 F2400
+G1 X-16.180 Y11.756 E1.6586 F2400
+G1 X-16.773 Y10.893 E1.6931 F2400
+G1 X-17.321 Y10.000 E1.7277 F2400
+G1 X-17.820 Y9.080 E1.7622 F2400
+G1 X-18.271 Y8.135 E1.7968 F2400
+G1 X-18.672 Y7.167 E1.8313 F2400
+G1 X-19.021 Y6.180 E1.8659 F2400
+G1 X-19.319 Y5.176 E1.9004 F2400
+G1 X-19.563 Y4.158 E1.9350 F2400
+G1 X-19.754 Y3.129 E1.9696 F2400
+G1 X-19.890 Y2.091 E2.0041 F2400
+G1 X-19.973 Y1.047 E2.0387 F2400
+G1 X-20.000 Y0.000 E2.0732 F2400
+G1 X-19.973 Y-1.047 E2.1078 F2400
+G1 X-19.890 Y-2.091 E2.1423 F2400
+G1 X-19.754 Y-3.129 E2.1769 F2400
+G1 X-19.563 Y-4.158 E2.2114 F2400
+G1 X-19.319 Y-5.176 E2.2460 F2400
+G1 X-19.021 Y-6.180 E2.2805 F2400
+G1 X-18.672 Y-7.167 E2.3151 F2400
+G1 X-18.271 Y-8.135 E2.3496 F2400
+G1 X-17.820 Y-9.080 E2.3842 F2400
+G1 X-17.321 Y-10.000 E2.4188 F2400
+G1 X-16.773 Y-10.893 E2.4533 F2400
+G1 X-16.180 Y-11.756 E2.4879 F2400
+G1 X-15.543 Y-12.586 E2.5224 F2400
+G1 X-14.863 Y-13.383 E2.5570 F2400
+G1 X-14.142 Y-14.142 E2.5915 F2400
+G1 X-13.383 Y-14.863 E2.6261 F2400
+G1 X-12.586 Y-15.543 E2.6606 F2400
+G1 X-11.756 Y-16.180 E2.6952 F2400
+G1 X-10.893 Y-16.773 E2.7297 F2400
+G1 X-10.000 Y-17.321 E2.7643 F2400
+G1 X-9.080 Y-17.820 E2.7988 F2400
+G1 X-8.135 Y-18.271 E2.8334 F2400
+G1 X-7.167 Y-18.672 E2.8679 F2400
+G1 X-6.180 Y-19.021 E2.9025 F2400
+G1 X-5.176 Y-19.319 E2.9371 F2400
+G1 X-4.158 Y-19.563 E2.9716 F2400
+G1 X-3.129 Y-19.754 E3.0062 F2400
+G1 X-2.091 Y-19.890 E3.0407 F2400
+G1 X-1.047 Y-19.973 E3.0753 F2400
+G1 X-0.000 Y-20.000 E3.1098 F2400
+G1 X1.047 Y-19.973 E3.1444 F2400
+G1 X2.091 Y-19.890 E3.1789 F2400
+G1 X3.129 Y-19.754 E3.2135 F2400
+G1 X4.158 Y-19.563 E3.2480 F2400
+G1 X5.176 Y-19.319 E3.2826 F2400
+G1 X6.180 Y-19.021 E3.3171 F2400
+G1 X7.167 Y-18.672 E3.3517 F2400
+G1 X8.135 Y-18.271 E3.3863 F2400
+G1 X9.080 Y-17.820 E3.4208 F2400
+G1 X10.000 Y-17.321 E3.4554 F2400
+G1 X10.893 Y-16.773 E3.4899 F2400
+G1 X11.756 Y-16.180 E3.5245 F2400
+G1 X12.586 Y-15.543 E3.5590 F2400
+G1 X13.383 Y-14.863 E3.5936 F2400
+G1 X14.142 Y-14.142 E3.6281 F2400
+G1 X14.863 Y-13.383 E3.6627 F2400
+G1 X15.543 Y-12.586 E3.6972 F2400
+G1 X16.180 Y-11.756 E3.7318 F2400
+G1 X16.773 Y-10.893 E3.7663 F2400
+G1 X17.321 Y-10.000 E3.8009 F2400
+G1 X17.820 Y-9.080 E3.8354 F2400
+G1 X18.271 Y-8.135 E3.8700 F2400
+G1 X18.672 Y-7.167 E3.9046 F2400
+G1 X19.021 Y-6.180 E3.9391 F2400
+G1 X19.319 Y-5.176 E3.9737 F2400
+G1 X19.563 Y-4.158 E4.0082 F2400
+G1 X19.754 Y-3.129 E4.0428 F2400
+G1 X19.890 Y-2.091 E4.0773 F2400
+G1 X19.973 Y-1.047 E4.1119 F2400
+G1 X20.000 Y-0.000 E4.1464 F2400
+G1 E3.1464 F1800
+G1 X-10 Y-10 F6000
+G1 E4.1464 F1800
+G1 X10 Y-10 E4.8064 F1800
+G1 X10 Y10 E5.4664 F1800
+G1 X-10 Y10 E6.1264 F1800
+G1 X-10 Y-10 E6.7864 F1800
+G1 Z0.50 F3000
+G1 X19.973 Y1.047 E6.8210 F2400
+G1 X19.890 Y2.091 E6.8555 F2400
+G1 X19.754 Y3.129 E6.8901 F2400
+G1 X19.563 Y4.158 E6.9246 F2400
+G1 X19.319 Y5.176 E6.9592 F2400
+G1 X19.021 Y6.180 E6.9938 F2400
+G1 X18.672 Y7.167 E7.0283 F2400
+G1 X18.271 Y8.135 E7.0629 F2400
+G1 X17.820 Y9.080 E7.0974 F2400
+G1 X17.321 Y10.000 E7.1320 F2400
+G1 X16.773 Y10.893 E7.1665 F2400
+G1 X16.180 Y11.756 E7.2011 F2400
+G1 X15.543 Y12.586 E7.2356 F2400
+G1 X14.863 Y13.383 E7.2702 F2400
+G1 X14.142 Y14.142 E7.3047 F2400
+G1 X13.383 Y14.863 E7.3393 F2400
+G1 X12.586 Y15.543 E7.3738 F2400
+G1 X11.756 Y16.180 E7.4084 F2400
+G1 X10.893 Y16.773 E7.4429 F2400
+G1 X10.000 Y17.321 E7.4775 F2400
+G1 X9.080 Y17.820 E7.5121 F2400
+G1 X8.135 Y18.271 E7.5466 F2400
+G1 X7.167 Y18.672 E7.5812 F2400
+G1 X6.180 Y19.021 E7.6157 F2400
+G1 X5.176 Y19.319 E7.6503 F2400
+G1 X4.158 Y19.563 E7.6848 F2400
+G1 X3.129 Y19.754 E7.7194 F2400
+G1 X2.091 Y19.890 E7.7539 F2400
+G1 X1.047 Y19.973 E7.7885 F2400
+G1 X0.000 Y20.000 E7.8230 F2400
+G1 X-1.047 Y19.973 E7.8576 F2400
+G1 X-2.091 Y19.890 E7.8921 F2400
+G1 X-3.129 Y19.754 E7.9267 F2400
+G1 X-4.158 Y19.563 E7.9613 F2400
+G1 X-5.176 Y19.319 E7.9958 F2400
+G1 X-6.180 Y19.021 E8.0304 F2400
+G1 X-7.167 Y18.672 E8.0649 F2400
+G1 X-8.135 Y18.271 E8.0995 F2400
+G1 X-9.080 Y17.820 E8.1340 F2400
+G1 X-10.000 Y17.321 E8.1686 F2400
+G1 X-10.893 Y16.773 E8.2031 F2400
+G1 X-11.756 Y16.180 E8.2377 F2400
+G1 X-12.586 Y15.543 E8.2722 F2400
+G1 X-13.383 Y14.863 E8.3068 F2400
+G1 X-14.142 Y14.142 E8.3413 F2400
+G1 X-14.863 Y13.383 E8.3759 F2400
+G1 X-15.543 Y12.586 E8.4104 F2400
+G1 X-16.180 Y11.756 E8.4450 F2400
+G1 X-16.773 Y10.893 E8.4796 F2400
+G1 X-17.321 Y10.000 E8.5141 F2400
+G1 X-17.820 Y9.080 E8.5487 F2400
+G1 X-18.271 Y8.135 E8.5832 F2400
+G1 X-18.672 Y7.167 E8.6178 F2400
+G1 X-19.021 Y6.180 E8.6523 F2400
+G1 X-19.319 Y5.176 E8.6869 F2400
+G1 X-19.563 Y4.158 E8.7214 F2400
+G1 X-19.754 Y3.129 E8.7560 F2400
+G1 X-19.890 Y2.091 E8.7905 F2400
+G1 X-19.973 Y1.047 E8.8251 F2400
+G1 X-20.000 Y0.000 E8.8596 F2400
+G1 X-19.973 Y-1.047 E8.8942 F2400
+G1 X-19.890 Y-2.091 E8.9288 F2400
+G1 X-19.754 Y-3.129 E8.9633 F2400
+G1 X-19.563 Y-4.158 E8.9979 F2400
+G1 X-19.319 Y-5.176 E9.0324 F2400
+G1 X-19.021 Y-6.180 E9.0670 F2400
+G1 X-18.672 Y-7.167 E9.1015 F2400
+G1 X-18.271 Y-8.135 E9.1361 F2400
+G1 X-17.820 Y-9.080 E9.1706 F2400
+G1 X-17.321 Y-10.000 E9.2052 F2400
+G1 X-16.773 Y-10.893 E9.2397 F2400
+G1 X-16.180 Y-11.756 E9.2743 F2400
+G1 X-15.543 Y-12.586 E9.3088 F2400
+G1 X-14.863 Y-13.383 E9.3434 F2400
+G1 X-14.142 Y-14.142 E9.3779 F2400
+G1 X-13.383 Y-14.863 E9.4125 F2400
+G1 X-12.586 Y-15.543 E9.4471 F2400
+G1 X-11.756 Y-16.180 E9.4816 F2400
+G1 X-10.893 Y-16.773 E9.5162 F2400
+G1 X-10.000 Y-17.321 E9.5507 F2400
+G1 X-9.080 Y-17.820 E9.5853 F2400
+G1 X-8.135 Y-18.271 E9.6198 F2400
+G1 X-7.167 Y-18.672 E9.6544 F2400
+G1 X-6.180 Y-19.021 E9.6889 F2400
+G1 X-5.176 Y-19.319 E9.7235 F2400
+G1 X-4.158 Y-19.563 E9.7580 F2400
+G1 X-3.129 Y-19.754 E9.7926 F2400
+G1 X-2.091 Y-19.890 E9.8271 F2400
+G1 X-1.047 Y-19.973 E9.8617 F2400
+G1 X-0.000 Y-20.000 E9.8963 F2400
+G1 X1.047 Y-19.973 E9.9308 F2400
+G1 X2.091 Y-19.890 E9.9654 F2400
+G1 X3.129 Y-19.754 E9.9999 F2400
+G1 X4.158 Y-19.563 E10.0345 F2400
+G1 X5.176 Y-19.319 E10.0690 F2400
+G1 X6.180 Y-19.021 E10.1036 F2400
+G1 X7.167 Y-18.672 E10.1381 F2400
+G1 X8.135 Y-18.271 E10.1727 F2400
+G1 X9.080 Y-17.820 E10.2072 F2400
+G1 X10.000 Y-17.321 E10.2418 F2400
+G1 X10.893 Y-16.773 E10.2763 F2400
+G1 X11.756 Y-16.180 E10.3109 F2400
+G1 X12.586 Y-15.543 E10.3454 F2400
+G1 X13.383 Y-14.863 E10.3800 F2400
+G1 X14.142 Y-14.142 E10.4146 F2400
+G1 X14.863 Y-13.383 E10.4491 F2400
+G1 X15.543 Y-12.586 E10.4837 F2400
+G1 X16.180 Y-11.756 E10.5182 F2400
+G1 X16.773 Y-10.893 E10.5528 F2400
+G1 X17.321 Y-10.000 E10.5873 F2400
+G1 X17.820 Y-9.080 E10.6219 F2400
+G1 X18.271 Y-8.135 E10.6564 F2400
+G1 X18.672 Y-7.167 E10.6910 F2400
+G1 X19.021 Y-6.180 E10.7255 F2400
+G1 X19.319 Y-5.176 E10.7601 F2400
+G1 X19.563 Y-4.158 E10.7946 F2400
+G1 X19.754 Y-3.129 E10.8292 F2400
+G1 X19.890 Y-2.091 E10.8638 F2400
+G1 X19.973 Y-1.047 E10.8983 F2400
+G1 X20.000 Y-0.000 E10.9329 F2400
+G1 E9.9329 F1800
+G1 X-10 Y-10 F6000
+G1 E10.9329 F1800
+G1 X10 Y-10 E11.5929 F1800
+G1 X10 Y10 E12.2529 F1800
+G1 X-10 Y10 E12.9129 F1800
+G1 X-10 Y-10 E13.5729 F1800
+G1 Z0.70 F3000
+G1 X19.973 Y1.047 E13.6074 F2400
+G1 X19.890 Y2.091 E13.6420 F2400
+G1 X19.754 Y3.129 E13.6765 F2400
+G1 X19.563 Y4.158 E13.7111 F2400
+G1 X19.319 Y5.176 E13.7456 F2400
+G1 X19.021 Y6.180 E13.7802 F2400
+G1 X18.672 Y7.167 E13.8147 F2400
+G1 X18.271 Y8.135 E13.8493 F2400
+G1 X17.820 Y9.080 E13.8838 F2400
+G1 X17.321 Y10.000 E13.9184 F2400
+G1 X16.773 Y10.893 E13.9529 F2400
+G1 X16.180 Y11.756 E13.9875 F2400
+G1 X15.543 Y12.586 E14.0221 F2400
+G1 X14.863 Y13.383 E14.0566 F2400
+G1 X14.142 Y14.142 E14.0912 F2400
+G1 X13.383 Y14.863 E14.1257 F2400
+G1 X12.586 Y15.543 E14.1603 F2400
+G1 X11.756 Y16.180 E14.1948 F2400
+G1 X10.893 Y16.773 E14.2294 F2400
+G1 X10.000 Y17.321 E14.2639 F2400
+G1 X9.080 Y17.820 E14.2985 F2400
+G1 X8.135 Y18.271 E14.3330 F2400
+G1 X7.167 Y18.672 E14.3676 F2400
+G1 X6.180 Y19.021 E14.4021 F2400
+G1 X5.176 Y19.319 E14.4367 F2400
+G1 X4.158 Y19.563 E14.4713 F2400
+G1 X3.129 Y19.754 E14.5058 F2400
+G1 X2.091 Y19.890 E14.5404 F2400
+G1 X1.047 Y19.973 E14.5749 F2400
+G1 X0.000 Y20.000 E14.6095 F2400
+G1 X-1.047 Y19.973 E14.6440 F2400
+G1 X-2.091 Y19.890 E14.6786 F2400
+G1 X-3.129 Y19.754 E14.7131 F2400
+G1 X-4.158 Y19.563 E14.7477 F2400
+G1 X-5.176 Y19.319 E14.7822 F2400
+G1 X-6.180 Y19.021 E14.8168 F2400
+G1 X-7.167 Y18.672 E14.8513 F2400
+G1 X-8.135 Y18.271 E14.8859 F2400
+G1 X-9.080 Y17.820 E14.9204 F2400
+G1 X-10.000 Y17.321 E14.9550 F2400
+G1 X-10.893 Y16.773 E14.9896 F2400
+G1 X-11.756 Y16.180 E15.0241 F2400
+G1 X-12.586 Y15.543 E15.0587 F2400
+G1 X-13.383 Y14.863 E15.0932 F2400
+G1 X-14.142 Y14.142 E15.1278 F2400
+G1 X-14.863 Y13.383 E15.1623 F2400
+G1 X-15.543 Y12.586 E15.1969 F2400
+G1 X-16.180 Y11.756 E15.2314 F2400
+G1 X-16.773 Y10.893 E15.2660 F2400
+G1 X-17.321 Y10.000 E15.3005 F2400
+G1 X-17.820 Y9.080 E15.3351 F2400
+G1 X-18.271 Y8.135 E15.3696 F2400
+G1 X-18.672 Y7.167 E15.4042 F2400
+G1 X-19.021 Y6.180 E15.4388 F2400
+G1 X-19.319 Y5.176 E15.4733 F2400
+G1 X-19.563 Y4.158 E15.5079 F2400
+G1 X-19.754 Y3.129 E15.5424 F2400
+G1 X-19.890 Y2.091 E15.5770 F2400
+G1 X-19.973 Y1.047 E15.6115 F2400
+G1 X-20.000 Y0.000 E15.6461 F2400
+G1 X-19.973 Y-1.047 E15.6806 F2400
+G1 X-19.890 Y-2.091 E15.7152 F2400
+G1 X-19.754 Y-3.129 E15.7497 F2400
+G1 X-19.563 Y-4.158 E15.7843 F2400
+G1 X-19.319 Y-5.176 E15.8188 F2400
+G1 X-19.021 Y-6.180 E15.8534 F2400
+G1 X-18.672 Y-7.167 E15.8879 F2400
+G1 X-18.271 Y-8.135 E15.9225 F2400
+G1 X-17.820 Y-9.080 E15.9571 F2400
+G1 X-17.321 Y-10.000 E15.9916 F2400
+G1 X-16.773 Y-10.893 E16.0262 F2400
+G1 X-16.180 Y-11.756 E16.0607 F2400
+G1 X-15.543 Y-12.586 E16.0953 F2400
+G1 X-14.863 Y-13.383 E16.1298 F2400
+G1 X-14.142 Y-14.142 E16.1644 F2400
+G1 X-13.383 Y-14.863 E16.1989 F2400
+G1 X-12.586 Y-15.543 E16.2335 F2400
+G1 X-11.756 Y-16.180 E16.2680 F2400
+G1 X-10.893 Y-16.773 E16.3026 F2400
+G1 X-10.000 Y-17.321 E16.3371 F2400
+G1 X-9.080 Y-17.820 E16.3717 F2400
+G1 X-8.135 Y-18.271 E16.4063 F2400
+G1 X-7.167 Y-18.672 E16.4408 F2400
+G1 X-6.180 Y-19.021 E16.4754 F2400
+G1 X-5.176 Y-19.319 E16.5099 F2400
+G1 X-4.158 Y-19.563 E16.5445 F2400
+G1 X-3.129 Y-19.754 E16.5790 F2400
+G1 X-2.091 Y-19.890 E16.6136 F2400
+G1 X-1.047 Y-19.973 E16.6481 F2400
+G1 X-0.000 Y-20.000 E16.6827 F2400
+G1 X1.047 Y-19.973 E16.7172 F2400
+G1 X2.091 Y-19.890 E16.7518 F2400
+G1 X3.129 Y-19.754 E16.7863 F2400
+G1 X4.158 Y-19.563 E16.8209 F2400
+G1 X5.176 Y-19.319 E16.8554 F2400
+G1 X6.180 Y-19.021 E16.8900 F2400
+G1 X7.167 Y-18.672 E16.9246 F2400
+G1 X8.135 Y-18.271 E16.9591 F2400
+G1 X9.080 Y-17.820 E16.9937 F2400
+G1 X10.000 Y-17.321 E17.0282 F2400
+G1 X10.893 Y-16.773 E17.0628 F2400
+G1 X11.756 Y-16.180 E17.0973 F2400
+G1 X12.586 Y-15.543 E17.1319 F2400
+G1 X13.383 Y-14.863 E17.1664 F2400
+G1 X14.142 Y-14.142 E17.2010 F2400
+G1 X14.863 Y-13.383 E17.2355 F2400
+G1 X15.543 Y-12.586 E17.2701 F2400
+G1 X16.180 Y-11.756 E17.3046 F2400
+G1 X16.773 Y-10.893 E17.3392 F2400
+G1 X17.321 Y-10.000 E17.3738 F2400
+G1 X17.820 Y-9.080 E17.4083 F2400
+G1 X18.271 Y-8.135 E17.4429 F2400
+G1 X18.672 Y-7.167 E17.4774 F2400
+G1 X19.021 Y-6.180 E17.5120 F2400
+G1 X19.319 Y-5.176 E17.5465 F2400
+G1 X19.563 Y-4.158 E17.5811 F2400
+G1 X19.754 Y-3.129 E17.6156 F2400
+G1 X19.890 Y-2.091 E17.6502 F2400
+G1 X19.973 Y-1.047 E17.6847 F2400
+G1 X20.000 Y-0.000 E17.7193 F2400
+G1 E16.7193 F1800
+G1 X-10 Y-10 F6000
+G1 E17.7193 F1800
+G1 X10 Y-10 E18.3793 F1800
+G1 X10 Y10 E19.0393 F1800
+G1 X-10 Y10 E19.6993 F1800
+G1 X-10 Y-10 E20.3593 F1800
+G1 Z20 F3000
@@ -0,0 +1,11 @@
+; Test print for several steps per stepper interrupt: fast travel moves, needs the fast variant
+G28
+G90
+G1 Z20 F12000
+G1 X60 Y0 F12000
+G1 X-60 Y0
+G1 X0 Y60
+G1 X0 Y-60
+G1 X60 Y60 Z40
+G1 X-60 Y-60 Z10
+G1 X0 Y0 Z20
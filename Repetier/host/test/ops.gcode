@@ -0,0 +1,71 @@
+; OPS test for the host build: retraction before travel moves and pushback before printing (M231 S1)
+G28
+G90
+M82
+G92 E0
+M231 S1
+G1 Z0.3 F3000
+G1 Z0.30 F3000
+G1 X-40 Y-40 F6000
+G1 X-20 Y-40 E0.6620 F2400
+G1 X-20 Y-20 E1.3240 F2400
+G1 X-40 Y-20 E1.9860 F2400
+G1 X-40 Y-40 E2.6480 F2400
+G1 X20 Y-40 F6000
+G1 X40 Y-40 E3.3100 F2400
+G1 X40 Y-20 E3.9720 F2400
+G1 X20 Y-20 E4.6340 F2400
+G1 X20 Y-40 E5.2960 F2400
+G1 X20 Y20 F6000
+G1 X40 Y20 E5.9580 F2400
+G1 X40 Y40 E6.6200 F2400
+G1 X20 Y40 E7.2820 F2400
+G1 X20 Y20 E7.9440 F2400
+G1 X-40 Y20 F6000
+G1 X-20 Y20 E8.6060 F2400
+G1 X-20 Y40 E9.2680 F2400
+G1 X-40 Y40 E9.9300 F2400
+G1 X-40 Y20 E10.5920 F2400
+G1 Z0.50 F3000
+G1 X-40 Y-40 F6000
+G1 X-20 Y-40 E11.2540 F2400
+G1 X-20 Y-20 E11.9160 F2400
+G1 X-40 Y-20 E12.5780 F2400
+G1 X-40 Y-40 E13.2400 F2400
+G1 X20 Y-40 F6000
+G1 X40 Y-40 E13.9020 F2400
+G1 X40 Y-20 E14.5640 F2400
+G1 X20 Y-20 E15.2260 F2400
+G1 X20 Y-40 E15.8880 F2400
+G1 X20 Y20 F6000
+G1 X40 Y20 E16.5500 F2400
+G1 X40 Y40 E17.2120 F2400
+G1 X20 Y40 E17.8740 F2400
+G1 X20 Y20 E18.5360 F2400
+G1 X-40 Y20 F6000
+G1 X-20 Y20 E19.1980 F2400
+G1 X-20 Y40 E19.8600 F2400
+G1 X-40 Y40 E20.5220 F2400
+G1 X-40 Y20 E21.1840 F2400
+G1 Z0.70 F3000
+G1 X-40 Y-40 F6000
+G1 X-20 Y-40 E21.8460 F2400
+G1 X-20 Y-20 E22.5080 F2400
+G1 X-40 Y-20 E23.1700 F2400
+G1 X-40 Y-40 E23.8320 F2400
+G1 X20 Y-40 F6000
+G1 X40 Y-40 E24.4940 F2400
+G1 X40 Y-20 E25.1560 F2400
+G1 X20 Y-20 E25.8180 F2400
+G1 X20 Y-40 E26.4800 F2400
+G1 X20 Y20 F6000
+G1 X40 Y20 E27.1420 F2400
+G1 X40 Y40 E27.8040 F2400
+G1 X20 Y40 E28.4660 F2400
+G1 X20 Y20 E29.1280 F2400
+G1 X-40 Y20 F6000
+G1 X-20 Y20 E29.7900 F2400
+G1 X-20 Y40 E30.4520 F2400
+G1 X-40 Y40 E31.1140 F2400
+G1 X-40 Y20 E31.7760 F2400
+G1 X0 Y0 Z20 F6000
@@ -0,0 +1,304 @@
+; Planner test for the host build: circle of 300 segments, r=50 mm, at F6000 for the cornering models
+G90
+G1 Z10 F6000
+G1 X50 Y0 F6000
+G1 X49.989 Y1.047
+G1 X49.956 Y2.094
+G1 X49.901 Y3.140
+G1 X49.825 Y4.184
+G1 X49.726 Y5.226
+G1 X49.606 Y6.267
+G1 X49.464 Y7.304
+G1 X49.300 Y8.338
+G1 X49.114 Y9.369
+G1 X48.907 Y10.396
+G1 X48.679 Y11.418
+G1 X48.429 Y12.434
+G1 X48.158 Y13.446
+G1 X47.866 Y14.452
+G1 X47.553 Y15.451
+G1 X47.219 Y16.443
+G1 X46.864 Y17.429
+G1 X46.489 Y18.406
+G1 X46.093 Y19.376
+G1 X45.677 Y20.337
+G1 X45.241 Y21.289
+G1 X44.786 Y22.232
+G1 X44.310 Y23.165
+G1 X43.815 Y24.088
+G1 X43.301 Y25.000
+G1 X42.768 Y25.901
+G1 X42.216 Y26.791
+G1 X41.646 Y27.670
+G1 X41.057 Y28.536
+G1 X40.451 Y29.389
+G1 X39.826 Y30.230
+G1 X39.185 Y31.057
+G1 X38.526 Y31.871
+G1 X37.850 Y32.671
+G1 X37.157 Y33.457
+G1 X36.448 Y34.227
+G1 X35.724 Y34.983
+G1 X34.983 Y35.724
+G1 X34.227 Y36.448
+G1 X33.457 Y37.157
+G1 X32.671 Y37.850
+G1 X31.871 Y38.526
+G1 X31.057 Y39.185
+G1 X30.230 Y39.826
+G1 X29.389 Y40.451
+G1 X28.536 Y41.057
+G1 X27.670 Y41.646
+G1 X26.791 Y42.216
+G1 X25.901 Y42.768
+G1 X25.000 Y43.301
+G1 X24.088 Y43.815
+G1 X23.165 Y44.310
+G1 X22.232 Y44.786
+G1 X21.289 Y45.241
+G1 X20.337 Y45.677
+G1 X19.376 Y46.093
+G1 X18.406 Y46.489
+G1 X17.429 Y46.864
+G1 X16.443 Y47.219
+G1 X15.451 Y47.553
+G1 X14.452 Y47.866
+G1 X13.446 Y48.158
+G1 X12.434 Y48.429
+G1 X11.418 Y48.679
+G1 X10.396 Y48.907
+G1 X9.369 Y49.114
+G1 X8.338 Y49.300
+G1 X7.304 Y49.464
+G1 X6.267 Y49.606
+G1 X5.226 Y49.726
+G1 X4.184 Y49.825
+G1 X3.140 Y49.901
+G1 X2.094 Y49.956
+G1 X1.047 Y49.989
+G1 X0.000 Y50.000
+G1 X-1.047 Y49.989
+G1 X-2.094 Y49.956
+G1 X-3.140 Y49.901
+G1 X-4.184 Y49.825
+G1 X-5.226 Y49.726
+G1 X-6.267 Y49.606
+G1 X-7.304 Y49.464
+G1 X-8.338 Y49.300
+G1 X-9.369 Y49.114
+G1 X-10.396 Y48.907
+G1 X-11.418 Y48.679
+G1 X-12.434 Y48.429
+G1 X-13.446 Y48.158
+G1 X-14.452 Y47.866
+G1 X-15.451 Y47.553
+G1 X-16.443 Y47.219
+G1 X-17.429 Y46.864
+G1 X-18.406 Y46.489
+G1 X-19.376 Y46.093
+G1 X-20.337 Y45.677
+G1 X-21.289 Y45.241
+G1 X-22.232 Y44.786
+G1 X-23.165 Y44.310
+G1 X-24.088 Y43.815
+G1 X-25.000 Y43.301
+G1 X-25.901 Y42.768
+G1 X-26.791 Y42.216
+G1 X-27.670 Y41.646
+G1 X-28.536 Y41.057
+G1 X-29.389 Y40.451
+G1 X-30.230 Y39.826
+G1 X-31.057 Y39.185
+G1 X-31.871 Y38.526
+G1 X-32.671 Y37.850
+G1 X-33.457 Y37.157
+G1 X-34.227 Y36.448
+G1 X-34.983 Y35.724
+G1 X-35.724 Y34.983
+G1 X-36.448 Y34.227
+G1 X-37.157 Y33.457
+G1 X-37.850 Y32.671
+G1 X-38.526 Y31.871
+G1 X-39.185 Y31.057
+G1 X-39.826 Y30.230
+G1 X-40.451 Y29.389
+G1 X-41.057 Y28.536
+G1 X-41.646 Y27.670
+G1 X-42.216 Y26.791
+G1 X-42.768 Y25.901
+G1 X-43.301 Y25.000
+G1 X-43.815 Y24.088
+G1 X-44.310 Y23.165
+G1 X-44.786 Y22.232
+G1 X-45.241 Y21.289
+G1 X-45.677 Y20.337
+G1 X-46.093 Y19.376
+G1 X-46.489 Y18.406
+G1 X-46.864 Y17.429
+G1 X-47.219 Y16.443
+G1 X-47.553 Y15.451
+G1 X-47.866 Y14.452
+G1 X-48.158 Y13.446
+G1 X-48.429 Y12.434
+G1 X-48.679 Y11.418
+G1 X-48.907 Y10.396
+G1 X-49.114 Y9.369
+G1 X-49.300 Y8.338
+G1 X-49.464 Y7.304
+G1 X-49.606 Y6.267
+G1 X-49.726 Y5.226
+G1 X-49.825 Y4.184
+G1 X-49.901 Y3.140
+G1 X-49.956 Y2.094
+G1 X-49.989 Y1.047
+G1 X-50.000 Y0.000
+G1 X-49.989 Y-1.047
+G1 X-49.956 Y-2.094
+G1 X-49.901 Y-3.140
+G1 X-49.825 Y-4.184
+G1 X-49.726 Y-5.226
+G1 X-49.606 Y-6.267
+G1 X-49.464 Y-7.304
+G1 X-49.300 Y-8.338
+G1 X-49.114 Y-9.369
+G1 X-48.907 Y-10.396
+G1 X-48.679 Y-11.418
+G1 X-48.429 Y-12.434
+G1 X-48.158 Y-13.446
+G1 X-47.866 Y-14.452
+G1 X-47.553 Y-15.451
+G1 X-47.219 Y-16.443
+G1 X-46.864 Y-17.429
+G1 X-46.489 Y-18.406
+G1 X-46.093 Y-19.376
+G1 X-45.677 Y-20.337
+G1 X-45.241 Y-21.289
+G1 X-44.786 Y-22.232
+G1 X-44.310 Y-23.165
+G1 X-43.815 Y-24.088
+G1 X-43.301 Y-25.000
+G1 X-42.768 Y-25.901
+G1 X-42.216 Y-26.791
+G1 X-41.646 Y-27.670
+G1 X-41.057 Y-28.536
+G1 X-40.451 Y-29.389
+G1 X-39.826 Y-30.230
+G1 X-39.185 Y-31.057
+G1 X-38.526 Y-31.871
+G1 X-37.850 Y-32.671
+G1 X-37.157 Y-33.457
+G1 X-36.448 Y-34.227
+G1 X-35.724 Y-34.983
+G1 X-34.983 Y-35.724
+G1 X-34.227 Y-36.448
+G1 X-33.457 Y-37.157
+G1 X-32.671 Y-37.850
+G1 X-31.871 Y-38.526
+G1 X-31.057 Y-39.185
+G1 X-30.230 Y-39.826
+G1 X-29.389 Y-40.451
+G1 X-28.536 Y-41.057
+G1 X-27.670 Y-41.646
+G1 X-26.791 Y-42.216
+G1 X-25.901 Y-42.768
+G1 X-25.000 Y-43.301
+G1 X-24.088 Y-43.815
+G1 X-23.165 Y-44.310
+G1 X-22.232 Y-44.786
+G1 X-21.289 Y-45.241
+G1 X-20.337 Y-45.677
+G1 X-19.376 Y-46.093
+G1 X-18.406 Y-46.489
+G1 X-17.429 Y-46.864
+G1 X-16.443 Y-47.219
+G1 X-15.451 Y-47.553
+G1 X-14.452 Y-47.866
+G1 X-13.446 Y-48.158
+G1 X-12.434 Y-48.429
+G1 X-11.418 Y-48.679
+G1 X-10.396 Y-48.907
+G1 X-9.369 Y-49.114
+G1 X-8.338 Y-49.300
+G1 X-7.304 Y-49.464
+G1 X-6.267 Y-49.606
+G1 X-5.226 Y-49.726
+G1 X-4.184 Y-49.825
+G1 X-3.140 Y-49.901
+G1 X-2.094 Y-49.956
+G1 X-1.047 Y-49.989
+G1 X-0.000 Y-50.000
+G1 X1.047 Y-49.989
+G1 X2.094 Y-49.956
+G1 X3.140 Y-49.901
+G1 X4.184 Y-49.825
+G1 X5.226 Y-49.726
+G1 X6.267 Y-49.606
+G1 X7.304 Y-49.464
+G1 X8.338 Y-49.300
+G1 X9.369 Y-49.114
+G1 X10.396 Y-48.907
+G1 X11.418 Y-48.679
+G1 X12.434 Y-48.429
+G1 X13.446 Y-48.158
+G1 X14.452 Y-47.866
+G1 X15.451 Y-47.553
+G1 X16.443 Y-47.219
+G1 X17.429 Y-46.864
+G1 X18.406 Y-46.489
+G1 X19.376 Y-46.093
+G1 X20.337 Y-45.677
+G1 X21.289 Y-45.241
+G1 X22.232 Y-44.786
+G1 X23.165 Y-44.310
+G1 X24.088 Y-43.815
+G1 X25.000 Y-43.301
+G1 X25.901 Y-42.768
+G1 X26.791 Y-42.216
+G1 X27.670 Y-41.646
+G1 X28.536 Y-41.057
+G1 X29.389 Y-40.451
+G1 X30.230 Y-39.826
+G1 X31.057 Y-39.185
+G1 X31.871 Y-38.526
+G1 X32.671 Y-37.850
+G1 X33.457 Y-37.157
+G1 X34.227 Y-36.448
+G1 X34.983 Y-35.724
+G1 X35.724 Y-34.983
+G1 X36.448 Y-34.227
+G1 X37.157 Y-33.457
+G1 X37.850 Y-32.671
+G1 X38.526 Y-31.871
+G1 X39.185 Y-31.057
+G1 X39.826 Y-30.230
+G1 X40.451 Y-29.389
+G1 X41.057 Y-28.536
+G1 X41.646 Y-27.670
+G1 X42.216 Y-26.791
+G1 X42.768 Y-25.901
+G1 X43.301 Y-25.000
+G1 X43.815 Y-24.088
+G1 X44.310 Y-23.165
+G1 X44.786 Y-22.232
+G1 X45.241 Y-21.289
+G1 X45.677 Y-20.337
+G1 X46.093 Y-19.376
+G1 X46.489 Y-18.406
+G1 X46.864 Y-17.429
+G1 X47.219 Y-16.443
+G1 X47.553 Y-15.451
+G1 X47.866 Y-14.452
+G1 X48.158 Y-13.446
+G1 X48.429 Y-12.434
+G1 X48.679 Y-11.418
+G1 X48.907 Y-10.396
+G1 X49.114 Y-9.369
+G1 X49.300 Y-8.338
+G1 X49.464 Y-7.304
+G1 X49.606 Y-6.267
+G1 X49.726 Y-5.226
+G1 X49.825 Y-4.184
+G1 X49.901 Y-3.140
+G1 X49.956 Y-2.094
+G1 X49.989 Y-1.047
+G1 X50.000 Y-0.000
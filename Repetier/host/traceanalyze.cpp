@@ -0,0 +1,348 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Analyzes a step trace of steptrace (see tracefmt.h). Doesn't need the firmware.
+
+  Usage: traceanalyze trace.bin [motion.csv [interval_ms]]
+
+  Reports for each axis the steps, final position, highest step rate and the interval jitter, which
+  is the change between two following step intervals of one line. For the planned lines it reports
+  how far the progress of the primary axis deviates from the planned trapezoid: the time of each
+  stepper interrupt is compared with the time the trapezoid needs to reach the first step of that
+  interrupt, both counted from the first step of the line.
+  The step timing error shows the cost of several steps per speed computation: the steps of an axis
+  of one speed computation are compared with steps evenly spaced between the first of them and the
+  first step of the next speed computation. Only x, y and z count and only if they step in both speed
+  computations of the same line. Without STEPPER_LOOP_SPREAD the steps of a speed computation are
+  the steps of one interrupt.
+  At the joins of lines with known length that move x, y or z, speed and acceleration along the path at the join are
+  fitted to the steps of the primary axis in the last and first JOIN_WINDOW of the two lines. The
+  speed jump must not exceed the jerk the path planner allows, the acceleration jump not twice the
+  peak acceleration of the speed profiles, or traceanalyze returns 1.
+  motion.csv gets position [mm] and velocity [mm/s] of all axes for each interval (default 10 ms).
+*/
+#include "tracefmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+struct AxisStats {
+  long position;           ///< Steps in positive direction minus steps in negative direction
+  long steps;
+  int dirLevel;
+  uint64_t lastStep;
+  long lastInterval;       ///< 0 if the last step started a line or followed a pause
+  long minInterval;
+  std::vector<long> jitter; ///< |interval change| in ticks
+  long lastSampleSteps;    ///< position at the last csv sample
+  std::vector<uint64_t> callSteps; ///< ticks of the steps of the current speed computation
+  int callsSinceStep;      ///< speed computations finished since the first entry of callSteps
+  std::vector<long> stepError; ///< |step time - evenly spaced time| in ticks
+  AxisStats() : position(0),steps(0),dirLevel(0),lastStep(0),lastInterval(0),minInterval(0),lastSampleSteps(0),callsSinceStep(0) {}
+  /** Adds a step, the steps of the last speed computation are evaluated when the step starts a new one. */
+  void addCallStep(uint64_t tick,long pauseTicks) {
+    if(callsSinceStep==0) {
+      callSteps.push_back(tick);
+      return;
+    }
+    if(callsSinceStep==1 && callSteps.size()>1 && tick-callSteps[0]<(uint64_t)pauseTicks) {
+      double spacing = (double)(tick-callSteps[0])/callSteps.size();
+      for(size_t j=1;j<callSteps.size();j++)
+        stepError.push_back(labs((long)(callSteps[j]-callSteps[0])-(long)(j*spacing+0.5)));
+    }
+    callSteps.clear();
+    callSteps.push_back(tick);
+    callsSinceStep = 0;
+  }
+  void resetCall() {
+    callSteps.clear();
+    callsSinceStep = 0;
+  }
+};
+
+/** Length of the path done at a tick, from the primary axis progress of the lines. */
+struct PathSample {
+  uint64_t tick;
+  double mm;
+};
+
+#define JOIN_WINDOW 0.01 // s
+#define JOIN_MIN_SAMPLES 5
+/** Allowed speed jump above the jerk, the steps make the estimate inexact */
+#define JOIN_SPEED_TOLERANCE 2.0 // mm/s
+/** Allowed acceleration jump above twice the peak acceleration, in fractions of it */
+#define JOIN_ACCEL_TOLERANCE 0.2
+
+/** Least squares fit of the path samples in [from,to) to mm = c0+speed*t+accel/2*t^2, t in s from at.
+Returns false with less than JOIN_MIN_SAMPLES samples. */
+static bool fit_path(const std::vector<PathSample> &path,double from,double to,double at,double freq,double &speed,double &accel) {
+  size_t lo = 0,hi = path.size();
+  while(lo<hi) { // first sample at or after from
+    size_t mid = (lo+hi)>>1;
+    if(path[mid].tick<from) lo = mid+1; else hi = mid;
+  }
+  double st[5] = {0,0,0,0,0},sy[3] = {0,0,0};
+  int n = 0;
+  for(size_t i=lo;i<path.size() && path[i].tick<to;i++,n++) {
+    double t = (path[i].tick-at)/freq,y = path[i].mm-path[lo].mm,tk = 1;
+    for(int k=0;k<5;k++,tk*=t) {
+      st[k] += tk;
+      if(k<3) sy[k] += y*tk;
+    }
+  }
+  if(n<JOIN_MIN_SAMPLES) return false;
+  double m[3][3] = {{st[0],st[1],st[2]},{st[1],st[2],st[3]},{st[2],st[3],st[4]}};
+  double det = m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])-m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+              +m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]);
+  if(det==0) return false;
+  // Cramer's rule for c1 and c2
+  double c1 = (m[0][0]*(sy[1]*m[2][2]-m[1][2]*sy[2])-sy[0]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+              +m[0][2]*(m[1][0]*sy[2]-sy[1]*m[2][0]))/det;
+  double c2 = (m[0][0]*(m[1][1]*sy[2]-sy[1]*m[2][1])-m[0][1]*(m[1][0]*sy[2]-sy[1]*m[2][0])
+              +sy[0]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]))/det;
+  speed = c1;
+  accel = 2*c2;
+  return true;
+}
+
+struct LinePlan {
+  double steps,vStart,vMax,vEnd,accelSteps,decelSteps;
+  double accel,decel;      ///< steps/s^2
+  double tAccel,tPlateau,tTotal;
+  /** Time in s to do s steps, starting at 0 steps. */
+  double time(double s) const {
+    if(s<=accelSteps) {
+      if(accel<=0) return s/vMax;
+      return (sqrt(vStart*vStart+2.0*accel*s)-vStart)/accel;
+    }
+    if(s<steps-decelSteps) return tAccel+(s-accelSteps)/vMax;
+    double r = steps-s;
+    if(r<0) r = 0;
+    if(decel<=0) return tTotal-r/vMax;
+    return tTotal-(sqrt(vEnd*vEnd+2.0*decel*r)-vEnd)/decel;
+  }
+  void prepare() {
+    accel = (accelSteps>0 && vMax>vStart ? (vMax*vMax-vStart*vStart)/(2.0*accelSteps) : 0);
+    decel = (decelSteps>0 && vMax>vEnd ? (vMax*vMax-vEnd*vEnd)/(2.0*decelSteps) : 0);
+    tAccel = (accel>0 ? (vMax-vStart)/accel : accelSteps/vMax);
+    tPlateau = (steps-accelSteps-decelSteps)/vMax;
+    tTotal = tAccel+tPlateau+(decel>0 ? (vMax-vEnd)/decel : decelSteps/vMax);
+  }
+};
+
+static double percentile(std::vector<long> &v,double p) {
+  if(v.empty()) return 0;
+  size_t i = (size_t)(p*(v.size()-1));
+  std::nth_element(v.begin(),v.begin()+i,v.end());
+  return v[i];
+}
+
+int main(int argc,char **argv) {
+  if(argc<2) {
+    fprintf(stderr,"Usage: %s trace.bin [motion.csv [interval_ms]]\n",argv[0]);
+    return 2;
+  }
+  FILE *f = fopen(argv[1],"rb");
+  TraceHeader h;
+  if(!f || fread(&h,sizeof(h),1,f)!=1 || h.magic!=TRACE_MAGIC || h.version!=TRACE_VERSION) {
+    fprintf(stderr,"%s is no step trace\n",argv[1]);
+    return 2;
+  }
+  FILE *csv = 0;
+  double interval = 0.01;
+  if(argc>2) {
+    csv = fopen(argv[2],"w");
+    if(!csv) {
+      fprintf(stderr,"Can't write %s\n",argv[2]);
+      return 2;
+    }
+    if(argc>3) interval = atof(argv[3])/1000.0;
+    fprintf(csv,"time_ms,x_mm,y_mm,z_mm,e_mm,vx_mm_s,vy_mm_s,vz_mm_s,ve_mm_s\n");
+  }
+  const double freq = h.cpuFrequency;
+  const uint64_t sampleTicks = (uint64_t)(interval*freq);
+  const long pauseTicks = h.cpuFrequency/10; // longer intervals are pauses, no jitter
+  AxisStats axis[TRACE_AXES];
+  LinePlan plan;
+  int lineFields = 0;
+  long lines = 0,planned = 0;
+  int32_t field[TRACE_LINE_FIELDS];
+  uint64_t lineStart = 0,lastIsr = 0;
+  double lastSteps = 0;
+  bool lineActive = false;
+  double devMax = 0,devSum2 = 0,devWorstTime = 0,plannedTime = 0,actualTime = 0;
+  std::vector<PathSample> path;
+  std::vector<uint64_t> starts;  ///< Start ticks of all lines
+  std::vector<size_t> joins;     ///< Index in starts of lines with known length after one with known length
+  double pathStart = 0,mmPerStep = 0;
+  long devCount = 0,devWorstLine = 0;
+  uint64_t nextSample = sampleTicks;
+  TraceRecord r;
+  while(fread(&r,sizeof(r),1,f)==1) {
+    while(csv && r.tick>=nextSample) {
+      fprintf(csv,"%.0f",nextSample*1000.0/freq);
+      for(int i=0;i<TRACE_AXES;i++)
+        fprintf(csv,",%.4f",axis[i].position/h.stepsPerMM[i]);
+      for(int i=0;i<TRACE_AXES;i++) {
+        fprintf(csv,",%.3f",(axis[i].position-axis[i].lastSampleSteps)/h.stepsPerMM[i]/interval);
+        axis[i].lastSampleSteps = axis[i].position;
+      }
+      fprintf(csv,"\n");
+      nextSample += sampleTicks;
+    }
+    if(r.kind==TRACE_PIN) {
+      if(r.axis>=TRACE_AXES) {
+        axis[r.axis-TRACE_AXES].dirLevel = r.level;
+        continue;
+      }
+      if(!r.level) continue; // steps count at the rising edge
+      AxisStats &a = axis[r.axis];
+      bool positive = (a.dirLevel!=0)!=(h.dirInverted[r.axis]!=0);
+      a.position += (positive ? 1 : -1);
+      a.steps++;
+      if(a.steps>1) {
+        long iv = (long)(r.tick-a.lastStep);
+        if(iv<pauseTicks) {
+          if(a.minInterval==0 || iv<a.minInterval) a.minInterval = iv;
+          if(a.lastInterval) a.jitter.push_back(labs(iv-a.lastInterval));
+          a.lastInterval = iv;
+        } else a.lastInterval = 0;
+      }
+      a.lastStep = r.tick;
+      if(r.axis<3) a.addCallStep(r.tick,pauseTicks);
+    } else if(r.kind==TRACE_LINE) {
+      if(r.pin==0) lineFields = 0;
+      field[r.pin] = r.value;
+      if(++lineFields<TRACE_LINE_FIELDS) continue;
+      if(lineActive) actualTime += (lastIsr-lineStart)/freq;
+      for(int i=0;i<TRACE_AXES;i++) { // new line, the speed may jump
+        axis[i].lastInterval = 0;
+        axis[i].resetCall();
+      }
+      plan.steps = field[TRACE_LINE_STEPS];
+      plan.vStart = field[TRACE_LINE_VSTART];
+      plan.vMax = field[TRACE_LINE_VMAX];
+      plan.vEnd = field[TRACE_LINE_VEND];
+      plan.accelSteps = field[TRACE_LINE_ACCEL_STEPS];
+      plan.decelSteps = field[TRACE_LINE_DECEL_STEPS];
+      lines++;
+      if(!path.empty()) pathStart = path.back().mm;
+      bool known = mmPerStep>0;
+      mmPerStep = (plan.steps>0 && field[TRACE_LINE_PRIMARY]!=3 ? field[TRACE_LINE_DISTANCE]/1000.0/plan.steps : 0); // not for moves of e only
+      if(known && mmPerStep>0) joins.push_back(starts.size());
+      starts.push_back(r.tick);
+      if(path.empty() || r.tick-path.back().tick>(uint64_t)pauseTicks) { // standstill until now
+        PathSample ps = {r.tick,pathStart};
+        path.push_back(ps);
+      }
+      lineActive = plan.vMax>0 && plan.steps>0;
+      if(!lineActive) continue;
+      plan.prepare();
+      planned++;
+      plannedTime += plan.tTotal-plan.time(1);
+      lineStart = r.tick;
+      lastSteps = 0;
+    } else if(r.kind==TRACE_ISR && lineActive) {
+      for(int i=0;i<TRACE_AXES;i++)
+        if(r.level && !axis[i].callSteps.empty()) axis[i].callsSinceStep++;
+      double done = plan.steps-r.value;
+      if(done>lastSteps && lastSteps>0) { // first step of this interrupt against the plan
+        double dev = (r.tick-lineStart)/freq-(plan.time(lastSteps+1)-plan.time(1));
+        devSum2 += dev*dev;
+        devCount++;
+        if(fabs(dev)>devMax) {
+          devMax = fabs(dev);
+          devWorstLine = lines;
+          devWorstTime = r.tick/freq;
+        }
+      }
+      if(done>lastSteps) { // the path is known exactly at the steps, the ISRs between them don't step
+        lastIsr = r.tick;
+        PathSample ps = {r.tick,pathStart+done*mmPerStep};
+        path.push_back(ps);
+      }
+      lastSteps = done;
+    }
+  }
+  if(lineActive) actualTime += (lastIsr-lineStart)/freq;
+  fclose(f);
+  double speedJumpSum = 0,speedJumpMax = 0,accelJumpSum = 0,accelJumpMax = 0,speedJumpTime = 0,accelJumpTime = 0;
+  long joinCount = 0;
+  const double w = JOIN_WINDOW*freq;
+  for(size_t j=0;j<joins.size();j++) {
+    size_t k = joins[j];
+    double t = starts[k];
+    double before = std::max(t-w,(double)starts[k-1]),after = (k+1<starts.size() ? std::min(t+w,(double)starts[k+1]) : t+w);
+    double speedBefore,accelBefore,speedAfter,accelAfter;
+    if(!fit_path(path,before,t,t,freq,speedBefore,accelBefore) || !fit_path(path,t,after,t,freq,speedAfter,accelAfter))
+      continue; // too few steps for a fit
+    double speedJump = fabs(speedAfter-speedBefore),accelJump = fabs(accelAfter-accelBefore);
+    speedJumpSum += speedJump;
+    accelJumpSum += accelJump;
+    if(speedJump>speedJumpMax) {
+      speedJumpMax = speedJump;
+      speedJumpTime = t/freq;
+    }
+    if(accelJump>accelJumpMax) {
+      accelJumpMax = accelJump;
+      accelJumpTime = t/freq;
+    }
+    joinCount++;
+  }
+  if(csv) fclose(csv);
+  const char *names[TRACE_AXES] = {"X","Y","Z","E"};
+  printf("Axis   Steps  Position[mm]  MaxRate[steps/s]  Jitter[ticks]: mean    p99     max\n");
+  for(int i=0;i<TRACE_AXES;i++) {
+    AxisStats &a = axis[i];
+    double mean = 0,maxJ = 0;
+    for(size_t j=0;j<a.jitter.size();j++) {
+      mean += a.jitter[j];
+      if(a.jitter[j]>maxJ) maxJ = a.jitter[j];
+    }
+    if(!a.jitter.empty()) mean /= a.jitter.size();
+    printf("%-4s %8ld %13.3f %17.0f %20.1f %7.0f %7.0f\n",names[i],a.steps,a.position/h.stepsPerMM[i],
+      a.minInterval ? freq/a.minInterval : 0.0,mean,percentile(a.jitter,0.99),maxJ);
+  }
+  printf("Step timing error [ticks]:");
+  for(int i=0;i<3;i++) {
+    AxisStats &a = axis[i];
+    double mean = 0;
+    for(size_t j=0;j<a.stepError.size();j++) mean += a.stepError[j];
+    if(!a.stepError.empty()) mean /= a.stepError.size();
+    printf(" %s mean %.1f p99 %.0f max %.0f%s",names[i],mean,percentile(a.stepError,0.99),
+      a.stepError.empty() ? 0.0 : (double)*std::max_element(a.stepError.begin(),a.stepError.end()),i<2 ? "," : "\n");
+  }
+  printf("Lines: %ld, with steps: %ld\n",lines,planned);
+  printf("Planned time [s]: %.4f, actual time [s]: %.4f\n",plannedTime,actualTime);
+  printf("Deviation from trapezoid [us]: rms %.1f, max %.1f in line %ld at %.4f s\n",
+    devCount ? sqrt(devSum2/devCount)*1e6 : 0.0,devMax*1e6,devWorstLine,devWorstTime);
+  printf("Joins: %ld, speed jump [mm/s]: mean %.2f max %.2f at %.4f s (jerk %.1f)\n",joinCount,
+    joinCount ? speedJumpSum/joinCount : 0.0,speedJumpMax,speedJumpTime,h.maxJerk);
+  printf("Acceleration jump at joins [mm/s^2]: mean %.0f max %.0f at %.4f s (peak acceleration %.0f)\n",
+    joinCount ? accelJumpSum/joinCount : 0.0,accelJumpMax,accelJumpTime,h.peakAcceleration);
+  if(speedJumpMax>h.maxJerk+JOIN_SPEED_TOLERANCE) {
+    fprintf(stderr,"Speed jump at a join larger than the jerk\n");
+    return 1;
+  }
+  if(accelJumpMax>(2+JOIN_ACCEL_TOLERANCE)*h.peakAcceleration) {
+    fprintf(stderr,"Acceleration jump at a join larger than twice the peak acceleration\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Compares the planned lines of two step traces of the same G-code file, e.g. of the float and the
+  fixed point path planner. Doesn't need the firmware.
+
+  Usage: tracecompare reference.bin other.bin [max_speed_diff_percent [min_speed_diff_steps]]
+
+  The lines must have the same primary axis steps. Start, maximum and end speed of each line may
+  differ by max_speed_diff_percent (default 2) of the maximum speed of the line or by
+  min_speed_diff_steps steps/s (default 10), whatever is larger. Returns 1 if a line differs more.
+*/
+#include "tracefmt.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+struct Line {
+  int32_t field[TRACE_LINE_FIELDS];
+};
+
+static bool read_lines(const char *name,std::vector<Line> &lines,double &time) {
+  FILE *f = fopen(name,"rb");
+  TraceHeader h;
+  if(!f || fread(&h,sizeof(h),1,f)!=1 || h.magic!=TRACE_MAGIC || h.version!=TRACE_VERSION) {
+    fprintf(stderr,"%s is no step trace\n",name);
+    return false;
+  }
+  TraceRecord r;
+  Line l;
+  uint64_t last = 0;
+  while(fread(&r,sizeof(r),1,f)==1) {
+    last = r.tick;
+    if(r.kind!=TRACE_LINE) continue;
+    l.field[r.pin] = r.value;
+    if(r.pin==TRACE_LINE_FIELDS-1) lines.push_back(l);
+  }
+  fclose(f);
+  time = (double)last/h.cpuFrequency;
+  return true;
+}
+
+int main(int argc,char **argv) {
+  if(argc<3) {
+    fprintf(stderr,"Usage: %s reference.bin other.bin [max_speed_diff_percent [min_speed_diff_steps]]\n",argv[0]);
+    return 2;
+  }
+  double maxPercent = (argc>3 ? atof(argv[3]) : 2.0);
+  double minSteps = (argc>4 ? atof(argv[4]) : 10.0);
+  std::vector<Line> a,b;
+  double timeA,timeB;
+  if(!read_lines(argv[1],a,timeA) || !read_lines(argv[2],b,timeB)) return 2;
+  printf("Lines: %lu / %lu\n",(unsigned long)a.size(),(unsigned long)b.size());
+  printf("Printing time [s]: %.4f / %.4f\n",timeA,timeB);
+  if(a.size()!=b.size()) {
+    printf("FAIL: different number of lines\n");
+    return 1;
+  }
+  const int speeds[3] = {TRACE_LINE_VSTART,TRACE_LINE_VMAX,TRACE_LINE_VEND};
+  const char *names[3] = {"start","max","end"};
+  double worst[3] = {0,0,0};
+  double worstRel = 0;
+  long failed = 0;
+  for(size_t i=0;i<a.size();i++) {
+    if(a[i].field[TRACE_LINE_STEPS]!=b[i].field[TRACE_LINE_STEPS]) {
+      printf("Line %lu: steps %d / %d\n",(unsigned long)i,a[i].field[TRACE_LINE_STEPS],b[i].field[TRACE_LINE_STEPS]);
+      failed++;
+      continue;
+    }
+    double vMax = a[i].field[TRACE_LINE_VMAX];
+    double allowed = fmax(vMax*maxPercent/100.0,minSteps);
+    for(int j=0;j<3;j++) {
+      double d = fabs((double)a[i].field[speeds[j]]-b[i].field[speeds[j]]);
+      if(d>worst[j]) worst[j] = d;
+      if(vMax>0 && d/vMax>worstRel) worstRel = d/vMax;
+      if(d>allowed) {
+        if(failed<20)
+          printf("Line %lu: %s speed %d / %d steps/s\n",(unsigned long)i,names[j],a[i].field[speeds[j]],b[i].field[speeds[j]]);
+        failed++;
+      }
+    }
+  }
+  printf("Largest speed difference [steps/s]: start %.0f, max %.0f, end %.0f, %.2f %% of the line speed\n",
+    worst[0],worst[1],worst[2],worstRel*100.0);
+  if(failed) {
+    printf("FAIL: %ld differences above the limit\n",failed);
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,70 @@
+/*
+    This file is part of Repetier-Firmware.
+
+    Repetier-Firmware is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Repetier-Firmware is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Repetier-Firmware.  If not, see <http://www.gnu.org/licenses/>.
+
+  Binary step trace written by steptrace and read by traceanalyze. All values are little endian.
+  The file starts with a TraceHeader, followed by TraceRecords in time order.
+*/
+#ifndef HOST_TRACEFMT_H
+#define HOST_TRACEFMT_H
+
+#include <stdint.h>
+
+#define TRACE_MAGIC 0x54534652 // "RFST"
+#define TRACE_VERSION 2
+
+/** Axis index of the traced pins: 0-3 step pin of x,y,z,e, 4-7 direction pin of x,y,z,e. */
+#define TRACE_AXES 4
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t cpuFrequency;      ///< Ticks per second
+  int8_t stepPin[TRACE_AXES]; ///< Arduino pin numbers, x,y,z,e. For delta printers x,y,z are the towers.
+  int8_t dirPin[TRACE_AXES];
+  uint8_t dirInverted[TRACE_AXES]; ///< 1 if a high direction pin moves in negative direction
+  float stepsPerMM[TRACE_AXES];
+  float maxJerk;              ///< Speed change in mm/s the path planner allows at a join
+  float peakAcceleration;     ///< Largest path acceleration of a speed profile in mm/s^2, all axes at their limit
+} TraceHeader;
+
+/** Level change of a step or direction pin. pin is the arduino pin, axis is 0-3 for step and 4-7 for direction pins. */
+#define TRACE_PIN 0
+/** Planned parameters of a line, when the stepper interrupt starts it. pin is one of TRACE_LINE_*. */
+#define TRACE_LINE 1
+/** End of a stepper interrupt working on a line. value is the remaining primary axis steps, level is 1
+if the interrupt did the last steps of a speed computation (always without STEPPER_LOOP_SPREAD). */
+#define TRACE_ISR 2
+
+#define TRACE_LINE_STEPS 0        ///< Primary axis steps of the line
+#define TRACE_LINE_VSTART 1       ///< Speeds in primary axis steps/s
+#define TRACE_LINE_VMAX 2
+#define TRACE_LINE_VEND 3
+#define TRACE_LINE_ACCEL_STEPS 4
+#define TRACE_LINE_DECEL_STEPS 5
+#define TRACE_LINE_PRIMARY 6      ///< Primary axis, 4 is the virtual axis of delta printers
+#define TRACE_LINE_DISTANCE 7     ///< Planned length in um, 0 if unknown
+#define TRACE_LINE_FIELDS 8       ///< The TRACE_LINE records of a line have the same tick and come in field order
+
+typedef struct {
+  uint64_t tick;              ///< CPU cycles since start
+  uint8_t kind;               ///< TRACE_PIN, TRACE_LINE or TRACE_ISR
+  uint8_t pin;
+  uint8_t level;
+  uint8_t axis;
+  int32_t value;
+} TraceRecord;
+
+#endif
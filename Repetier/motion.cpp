@@ -29,6 +29,7 @@
 // ##########################################################################
 
 inline unsigned long U16SquaredToU32(unsigned int val) {
+#if CPU_ARCH==ARCH_AVR
   long res;
    __asm__ __volatile__ ( // 15 Ticks
    "mul %A1,%A1 \n\t"
@@ -48,9 +49,43 @@ inline unsigned long U16SquaredToU32(unsigned int val) {
   : "1"(val)
    );
   return res;
+#else
+  return (unsigned long)val*val;
+#endif
 }
 
-inline void computeMaxJunctionSpeed(PrintLine *previous,PrintLine *current) {
+/** \brief Integer square root, rounded down.
+
+Bitwise method, needs only shifts and additions. Starts at the highest used bit pair, so small
+values are computed faster.
+*/
+unsigned int isqrt32(unsigned long val) {
+  unsigned long res = 0;
+  unsigned long bit = 1UL<<30;
+  while(bit>val) bit>>=2;
+  while(bit) {
+    if(val>=res+bit) {
+      val -= res+bit;
+      res = (res>>1)+bit;
+    } else
+      res>>=1;
+    bit>>=2;
+  }
+  return res;
+}
+
+/** Speed reached after accelerating from v with acc = 2*acceleration*distance. */
+inline planspeed_t plannerAccelerate(planspeed_t v,planspeed2_t acc) {
+#ifdef FIXED_POINT_PLANNER
+  unsigned long v2 = U16SquaredToU32(v)+acc;
+  if(v2<acc) return 65535; // overflow, far above any allowed speed
+  return isqrt32(v2);
+#else
+  return sqrt(v*v+acc);
+#endif
+}
+
+inline void computeMaxJunctionSpeed(PrintLine *previous,PrintLine *current,PlanLine *previousPlan,PlanLine *currentPlan) {
   if(previous->flags & FLAG_WARMUP) {
     current->joinFlags |= FLAG_JOIN_START_FIXED;
     return;
@@ -60,53 +95,79 @@ inline void computeMaxJunctionSpeed(PrintLine *previous,PrintLine *current) {
         if((previous->dir & 128)!=(current->dir & 128) && ((previous->dir & 48) || (current->dir & 48))) {
             previous->joinFlags |= FLAG_JOIN_END_FIXED;
             current->joinFlags |= FLAG_JOIN_START_FIXED;
-            previous->maxJunctionSpeed = min(previous->endSpeed,current->startSpeed);
+            previousPlan->maxJunctionSpeed = min(previousPlan->endSpeed,currentPlan->startSpeed);
             previous->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED;
             current->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED;
-            previous->endSpeed = current->startSpeed = previous->maxJunctionSpeed;
+            previousPlan->endSpeed = currentPlan->startSpeed = previousPlan->maxJunctionSpeed;
             return;
         }
     }
 #endif // USE_ADVANCE
-#if DRIVE_SYSTEM==3
-  if (previous->moveID == current->moveID) { // Avoid computing junction speed for split delta lines
-   if(previous->fullSpeed>current->fullSpeed)
-      previous->maxJunctionSpeed = current->fullSpeed;
+#ifdef USE_MOVE_ID
+  if (previous->moveID == current->moveID) { // Avoid computing junction speed for split delta lines and arcs
+   if(PLANNER_FULL_SPEED(previousPlan)>PLANNER_FULL_SPEED(currentPlan))
+      previousPlan->maxJunctionSpeed = PLANNER_FULL_SPEED(currentPlan);
    else
-      previous->maxJunctionSpeed = previous->fullSpeed;
+      previousPlan->maxJunctionSpeed = PLANNER_FULL_SPEED(previousPlan);
    return;
   }
 #endif
+#if JUNCTION_MODEL==1
+   float factor=1,tmp;
+   // Cosine of the angle between the moves, -1 = straight, 1 = reversal
+   float cosTheta = -(previousPlan->unitX*currentPlan->unitX+previousPlan->unitY*currentPlan->unitY+previousPlan->unitZ*currentPlan->unitZ);
+   if(cosTheta>1.0) cosTheta = 1.0; // rounding of the unit vectors
+   float sinThetaD2 = sqrt(0.5*(1.0-cosTheta)); // sin(theta/2), 1 = straight
+   if(sinThetaD2<0.9999) { // Nearly straight moves need no reduction
+     // acceleration is 2*a*distance, take the lower acceleration of both moves
+     float accel = PLANNER2_TO_FLOAT(previousPlan->acceleration)/(2.0*previousPlan->distance);
+     tmp = PLANNER2_TO_FLOAT(currentPlan->acceleration)/(2.0*currentPlan->distance);
+     if(tmp<accel) accel = tmp;
+     float v2 = 0.25*printer_state.maxJerk*printer_state.maxJerk; // Never slower then start speed
+     tmp = accel*JUNCTION_DEVIATION*sinThetaD2/(1.0-sinThetaD2);
+     if(tmp>v2) v2 = tmp;
+     if(v2<previousPlan->fullSpeed*previousPlan->fullSpeed)
+       factor = sqrt(v2)*previousPlan->invFullSpeed;
+   }
+#else
    // First we compute the normalized jerk for speed 1
-   float dx = current->speedX-previous->speedX;
-   float dy = current->speedY-previous->speedY;
+   float dx = currentPlan->speedX-previousPlan->speedX;
+   float dy = currentPlan->speedY-previousPlan->speedY;
    float factor=1,tmp;
 #if (DRIVE_SYSTEM == 3) // No point computing Z Jerk separately for delta moves
-   float dz = current->speedZ-previous->speedZ;
-   float jerk = sqrt(dx*dx+dy*dy+dz*dz);
+   float dz = currentPlan->speedZ-previousPlan->speedZ;
+   float jerk2 = dx*dx+dy*dy+dz*dz;
 #else
-   float jerk = sqrt(dx*dx+dy*dy);
+   float jerk2 = dx*dx+dy*dy;
 #endif
    //if(DEBUG_ECHO) {OUT_P_F_LN("Jerk:",jerk);OUT_P_F_LN("FS:",p1->fullSpeed);OUT_P_F_LN("MaxJerk:",printer_state.maxJerk);}
-   if(jerk>printer_state.maxJerk)
-     factor = printer_state.maxJerk/jerk;
+   if(jerk2>printer_state.maxJerk*printer_state.maxJerk) // sqrt only needed if we must reduce speed
+     factor = printer_state.maxJerk/sqrt(jerk2);
+#endif // JUNCTION_MODEL
 #if (DRIVE_SYSTEM!=3)
    if((previous->dir & 64) || (current->dir & 64)) {
    //  float dz = (p2->speedZ*p2->invFullSpeed-p1->speedZ*p1->invFullSpeed)*printer_state.maxJerk/printer_state.maxZJerk;
-     float dz = fabs(current->speedZ-previous->speedZ);
+     float dz = fabs(currentPlan->speedZ-previousPlan->speedZ);
      if(dz>printer_state.maxZJerk) {
        tmp = printer_state.maxZJerk/dz;
        if(tmp<factor) factor = tmp;
      }
    }
 #endif
-   float eJerk = fabs(current->speedE-previous->speedE);
+   float eJerk = fabs(currentPlan->speedE-previousPlan->speedE);
    if(eJerk>current_extruder->maxStartFeedrate) {
      tmp = current_extruder->maxStartFeedrate/eJerk;
      if(tmp<factor) factor = tmp;
    }
-   previous->maxJunctionSpeed = previous->fullSpeed*factor;
-   if(previous->maxJunctionSpeed>current->fullSpeed) previous->maxJunctionSpeed = current->fullSpeed;
+#ifdef FIXED_POINT_PLANNER
+   if(factor<1.0)
+     previousPlan->maxJunctionSpeed = PLANNER_SPEED(previousPlan->fullSpeed*factor);
+   else
+     previousPlan->maxJunctionSpeed = previousPlan->fullSpeedFixed;
+#else
+   previousPlan->maxJunctionSpeed = previousPlan->fullSpeed*factor;
+#endif
+   if(previousPlan->maxJunctionSpeed>PLANNER_FULL_SPEED(currentPlan)) previousPlan->maxJunctionSpeed = PLANNER_FULL_SPEED(currentPlan);
    //if(DEBUG_ECHO) OUT_P_F_LN("Factor:",factor);
    //if(DEBUG_ECHO) OUT_P_F_LN("JSPD:",p1->maxJunctionSpeed);
 }
@@ -115,11 +176,49 @@ inline void computeMaxJunctionSpeed(PrintLine *previous,PrintLine *current) {
 
 Computes the acceleration/decelleration steps and advanced parameter associated.
 */
-void updateStepsParameter(PrintLine *p/*,byte caller*/) {
+#if RAMP_TABLE_SIZE>0
+/** Fills the interval tables of both ramps. Each entry holds the lowest speed of its step range,
+so the tables never exceed the ramp. Moves too slow for 16 bit intervals compute their ramps in the stepper interrupt.
+*/
+void computeRampTables(PrintLine *p) {
+  p->flags &= ~FLAG_RAMP_TABLE;
+  unsigned int vMin = (p->vStart<p->vEnd ? p->vStart : p->vEnd);
+  if(vMin<=F_CPU/65535) return;
+  byte shift = 0;
+  while((p->accelSteps>>shift)>=RAMP_TABLE_SIZE) shift++;
+  p->accelShift = shift;
+  shift = 0;
+  while((p->decelSteps>>shift)>=RAMP_TABLE_SIZE) shift++;
+  p->decelShift = shift;
+  unsigned long acc2 = p->accelerationPrim<<1;
+  unsigned long vStart2 = U16SquaredToU32(p->vStart);
+  unsigned long vEnd2 = U16SquaredToU32(p->vEnd);
+  byte last = p->accelSteps>>p->accelShift;
+  for(byte i=0;i<=last;i++) { // v^2 = v0^2+2*a*s
+    unsigned int v = isqrt32(vStart2+acc2*((unsigned long)i<<p->accelShift));
+    if(v>p->vMax) v = p->vMax;
+    p->accelInterval[i] = F_CPU/v;
+#ifdef USE_ADVANCE
+    p->accelSpeed[i] = v;
+#endif
+  }
+  last = p->decelSteps>>p->decelShift;
+  for(byte i=0;i<=last;i++) {
+    unsigned int v = isqrt32(vEnd2+acc2*((unsigned long)i<<p->decelShift));
+    if(v>p->vMax) v = p->vMax;
+    p->decelInterval[i] = F_CPU/v;
+#ifdef USE_ADVANCE
+    p->decelSpeed[i] = v;
+#endif
+  }
+  p->flags |= FLAG_RAMP_TABLE;
+}
+#endif
+void updateStepsParameter(PrintLine *p,PlanLine *pl/*,byte caller*/) {
     if(p->flags & FLAG_WARMUP) return;
     if(p->joinFlags & FLAG_JOIN_STEPPARAMS_COMPUTED) return; // Already up to date, spare time
-    float startFactor = p->startSpeed * p->invFullSpeed;
-    float endFactor   = p->endSpeed   * p->invFullSpeed;
+    float startFactor = PLANNER_TO_FLOAT(pl->startSpeed) * pl->invFullSpeed;
+    float endFactor   = PLANNER_TO_FLOAT(pl->endSpeed)   * pl->invFullSpeed;
     p->vStart = p->vMax*startFactor; //starting speed
     p->vEnd   = p->vMax*endFactor;
     unsigned long vmax2 = U16SquaredToU32(p->vMax);
@@ -130,6 +229,9 @@ void updateStepsParameter(PrintLine *p/*,byte caller*/) {
     p->advanceStart = (float)p->advanceFull*startFactor * startFactor;
     p->advanceEnd   = (float)p->advanceFull*endFactor   * endFactor;
 #endif
+#endif
+#ifdef S_CURVE_ACCELERATION
+    unsigned int accelPeak = p->vMax,decelPeak = p->vMax;
 #endif
     if(p->accelSteps+p->decelSteps>=p->stepsRemaining) { // can't reach limit speed
       unsigned int red = (p->accelSteps+p->decelSteps+2-p->stepsRemaining)>>1;
@@ -141,7 +243,23 @@ void updateStepsParameter(PrintLine *p/*,byte caller*/) {
         p->decelSteps-=red;
       } else
         p->decelSteps = 0;
+#ifdef S_CURVE_ACCELERATION
+      // Shortened ramps end below vMax, v^2 = v0^2+2*a*s
+      accelPeak = isqrt32(U16SquaredToU32(p->vStart)+(p->accelerationPrim<<1)*p->accelSteps);
+      decelPeak = isqrt32(U16SquaredToU32(p->vEnd)+(p->accelerationPrim<<1)*p->decelSteps);
+      if(accelPeak>p->vMax) accelPeak = p->vMax;
+      if(decelPeak>p->vMax) decelPeak = p->vMax;
+#endif
     }
+#ifdef S_CURVE_ACCELERATION
+    p->accelDV = (accelPeak>p->vStart ? accelPeak-p->vStart : 0);
+    p->decelDV = (decelPeak>p->vEnd ? decelPeak-p->vEnd : 0);
+    p->accelRampInv = (p->accelDV ? 16777216UL/p->accelDV : 0);
+    p->decelRampInv = (p->decelDV ? 16777216UL/p->decelDV : 0);
+#endif
+#if RAMP_TABLE_SIZE>0
+    computeRampTables(p);
+#endif
     p->joinFlags|=FLAG_JOIN_STEPPARAMS_COMPUTED;
 #ifdef DEBUG_QUEUE_MOVE
     if(DEBUG_ECHO) {
@@ -150,8 +268,8 @@ void updateStepsParameter(PrintLine *p/*,byte caller*/) {
       out.println_int_P(PSTR("/"),p->vEnd);
       out.print_int_P(PSTR("accel/decel steps:"),p->accelSteps);
       out.println_int_P(PSTR("/"),p->decelSteps);
-      out.print_float_P(PSTR("st./end speed:"),p->startSpeed);
-      out.println_float_P(PSTR("/"),p->endSpeed);
+      out.print_float_P(PSTR("st./end speed:"),PLANNER_TO_FLOAT(pl->startSpeed));
+      out.println_float_P(PSTR("/"),PLANNER_TO_FLOAT(pl->endSpeed));
 #if USE_OPS==1
       if(!(p->dir & 128) && printer_state.opsMode==2)
         out.println_long_P(PSTR("Reverse at:"),p->opsReverseSteps);
@@ -185,16 +303,18 @@ last = last element until we check
 inline void backwardPlanner(byte p,byte last) {
   if(p==last) return;
   PrintLine *act = &lines[p],*prev;
-  float lastJunctionSpeed = act->endSpeed; // Start always with safe speed
+  PlanLine *pact = PLAN_LINE(p),*pprev;
+  planspeed_t lastJunctionSpeed = pact->endSpeed; // Start always with safe speed
   //PREVIOUS_PLANNER_INDEX(last); // Last element is already fixed in start speed
   while(p!=last) {
     PREVIOUS_PLANNER_INDEX(p);
     prev = &lines[p];
+    pprev = PLAN_LINE(p);
 #if USE_OPS==1
     // Retraction points are fixed points where the extruder movement stops anyway. Finish the computation for the move and exit.
     if(printer_state.opsMode && printmoveSeen) {
       if((prev->dir & 136)==136 && (act->dir & 136)!=136) {
-        if((act->dir & 64)!=0 || act->distance>printer_state.opsMinDistance) { // Switch printing - travel
+        if((act->dir & 64)!=0 || pact->distance>printer_state.opsMinDistance) { // Switch printing - travel
           act->joinFlags |= FLAG_JOIN_START_RETRACT | FLAG_JOIN_START_FIXED; // enable retract for this point
           prev->joinFlags |= FLAG_JOIN_END_FIXED;
           return;
@@ -215,10 +335,10 @@ inline void backwardPlanner(byte p,byte last) {
       }
     }
 #endif
-    // Avoid speed calc once crusing in split delta move
-#if DRIVE_SYSTEM==3
-    if (prev->moveID==act->moveID && lastJunctionSpeed==prev->maxJunctionSpeed) {
-      act->startSpeed = prev->endSpeed = lastJunctionSpeed;
+    // Avoid speed calc once crusing in split delta move or arc
+#ifdef USE_MOVE_ID
+    if (prev->moveID==act->moveID && lastJunctionSpeed==pprev->maxJunctionSpeed) {
+      pact->startSpeed = pprev->endSpeed = lastJunctionSpeed;
       prev->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
       act->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
     }
@@ -237,54 +357,59 @@ inline void backwardPlanner(byte p,byte last) {
 	
     // Avoid speed calcs if we know we can accelerate within the line
     if (act->flags & FLAG_NOMINAL)
-      lastJunctionSpeed = act->fullSpeed;
+      lastJunctionSpeed = PLANNER_FULL_SPEED(pact);
     else
       // If you accelerate from end of move to start what speed to you reach?
-      lastJunctionSpeed = sqrt(lastJunctionSpeed*lastJunctionSpeed+act->acceleration); // acceleration is acceleration*distance*2! What can be reached if we try?
-      // If that speed is more that the maximum junction speed allowed then ...
-      if(lastJunctionSpeed>=prev->maxJunctionSpeed) { // Limit is reached
+      lastJunctionSpeed = plannerAccelerate(lastJunctionSpeed,pact->acceleration); // acceleration is acceleration*distance*2! What can be reached if we try?
+    // If that speed is more that the maximum junction speed allowed then ...
+    if(lastJunctionSpeed>=pprev->maxJunctionSpeed) { // Limit is reached
       // If the previous line's end speed has not been updated to maximum speed then do it now
-      if(prev->endSpeed!=prev->maxJunctionSpeed) {
+      if(pprev->endSpeed!=pprev->maxJunctionSpeed) {
         prev->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
-        prev->endSpeed = prev->maxJunctionSpeed; // possibly unneeded???
+        pprev->endSpeed = pprev->maxJunctionSpeed; // possibly unneeded???
       }        
       // If actual line start speed has not been updated to maximum speed then do it now
-      if(act->startSpeed!=prev->maxJunctionSpeed) {
-        act->startSpeed = prev->maxJunctionSpeed; // possibly unneeded???
+      if(pact->startSpeed!=pprev->maxJunctionSpeed) {
+        pact->startSpeed = pprev->maxJunctionSpeed; // possibly unneeded???
         act->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
       }
-      lastJunctionSpeed = prev->maxJunctionSpeed;     
+      lastJunctionSpeed = pprev->maxJunctionSpeed;     
     } else {
       // Block prev end and act start as calculated speed and recalculate plateau speeds (which could move the speed higher again)
-      act->startSpeed = prev->endSpeed = lastJunctionSpeed;
+      pact->startSpeed = pprev->endSpeed = lastJunctionSpeed;
       prev->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
       act->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
     }
     act = prev;
+    pact = pprev;
   } // while loop
 }
 
 inline void forwardPlanner(byte p) {
   PrintLine *act,*next;
+  PlanLine *pact,*pnext;
   if(p==lines_write_pos) return;
   byte last = lines_write_pos;
   //NEXT_PLANNER_INDEX(last);
   next = &lines[p];
-  float leftspeed = next->startSpeed;
+  pnext = PLAN_LINE(p);
+  planspeed_t leftspeed = pnext->startSpeed;
 
   while(p!=last) { // All except last segment, which has fixed end speed
     act = next;
+    pact = pnext;
     NEXT_PLANNER_INDEX(p);
     next = &lines[p];
+    pnext = PLAN_LINE(p);
     if(act->joinFlags & FLAG_JOIN_END_FIXED) {
-      leftspeed = act->endSpeed;
+      leftspeed = pact->endSpeed;
       continue; // Nothing to do here
     }
-	// Avoid speed calc once crusing in split delta move	
-	#if DRIVE_SYSTEM==3
-	if (act->moveID == next->moveID && act->endSpeed == act->maxJunctionSpeed) {
-		act->startSpeed = leftspeed;
-		leftspeed       = act->endSpeed;
+	// Avoid speed calc once crusing in split delta move or arc
+	#ifdef USE_MOVE_ID
+	if (act->moveID == next->moveID && pact->endSpeed == pact->maxJunctionSpeed) {
+		pact->startSpeed = leftspeed;
+		leftspeed       = pact->endSpeed;
 	    act->joinFlags  |= FLAG_JOIN_END_FIXED;
         next->joinFlags |= FLAG_JOIN_START_FIXED;
 		continue;
@@ -292,16 +417,16 @@ inline void forwardPlanner(byte p) {
 	#endif
 
 
-    float vmax_right;
+    planspeed_t vmax_right;
 	// Avoid speed calcs if we know we can accelerate within the line.
 	if (act->flags & FLAG_NOMINAL)
-	  vmax_right = act->fullSpeed;
+	  vmax_right = PLANNER_FULL_SPEED(pact);
 	else
-      vmax_right = sqrt(leftspeed*leftspeed+act->acceleration); // acceleration is 2*acceleration*distance!, 1000 Ticks
-    if(vmax_right>act->endSpeed) { // Could be higher next run?
-      act->startSpeed = leftspeed;
-      leftspeed       = act->endSpeed;
-      if(act->endSpeed==act->maxJunctionSpeed) {// Full speed reached, don't compute again!
+      vmax_right = plannerAccelerate(leftspeed,pact->acceleration); // acceleration is 2*acceleration*distance!, 1000 Ticks
+    if(vmax_right>pact->endSpeed) { // Could be higher next run?
+      pact->startSpeed = leftspeed;
+      leftspeed       = pact->endSpeed;
+      if(pact->endSpeed==pact->maxJunctionSpeed) {// Full speed reached, don't compute again!
         act->joinFlags  |= FLAG_JOIN_END_FIXED;
         next->joinFlags |= FLAG_JOIN_START_FIXED;
       }
@@ -309,12 +434,27 @@ inline void forwardPlanner(byte p) {
     } else { // We can accelerate full speed without reaching limit, which is as fast as possible. Fix it!
       act->joinFlags |= FLAG_JOIN_END_FIXED | FLAG_JOIN_START_FIXED;
       act->joinFlags &= ~FLAG_JOIN_STEPPARAMS_COMPUTED; // Needs recomputation
-      act->startSpeed = leftspeed;
-      act->endSpeed   = next->startSpeed = leftspeed = vmax_right;
+      pact->startSpeed = leftspeed;
+      pact->endSpeed   = pnext->startSpeed = leftspeed = vmax_right;
       next->joinFlags |= FLAG_JOIN_START_FIXED;
     }
   }
-  next->startSpeed = leftspeed; // This is the new segment, wgich is updated anyway, no extra flag needed.
+  pnext->startSpeed = leftspeed; // This is the new segment, wgich is updated anyway, no extra flag needed.
+}
+
+/** Commits the first uncommitted line. Its end speed gets fixed and the stepper interrupt may take it from now on.
+Only called with planner_busy set.
+*/
+inline void commitPlannerLine() {
+  byte idx = lines_commit_pos;
+  PrintLine *l = &lines[idx];
+  l->joinFlags |= FLAG_JOIN_END_FIXED;
+  updateStepsParameter(l,PLAN_LINE(idx)); // Normally already up to date
+  NEXT_PLANNER_INDEX(idx);
+  lines[idx].joinFlags |= FLAG_JOIN_START_FIXED;
+  MEMORY_BARRIER(); // Line must be complete before it gets published
+  lines_commit_pos = idx;
+  lines_commit_seq++;
 }
 
 /**
@@ -323,24 +463,32 @@ This is the path planner.
 It goes from the last entry and tries to increase the end speed of previous moves in a fashion that the maximum jerk
 is never exceeded. If a segment with reached maximum speed is met, the planner stops. Everything left from this
 is already optimal from previous updates.
-The first 2 entries in the queue are not checked. The first is the one that is already in print and the following will likely become active.
+The planner only changes uncommitted lines. Before it starts, it commits enough lines to keep the stepper interrupt
+busy during planning. While planner_busy is set, the interrupt only takes committed lines, so no interrupts need
+to be disabled.
 
 The method is called before lines_count is increased!
 */
 void updateTrapezoids(byte p) {
   byte first = p;
-  PrintLine *firstLine;
   PrintLine *act = &lines[p];
-  BEGIN_INTERRUPT_PROTECTED; 
-  byte maxfirst = lines_pos; // first non fixed segment
-  if(maxfirst!=p)
-    NEXT_PLANNER_INDEX(maxfirst); // don't touch the line printing
-  // Now ignore enough segments to gain enough time for path planning
+  planner_busy = 1; // From now on the stepper interrupt takes only committed lines
+  MEMORY_BARRIER();
+  // Now commit enough segments to gain enough time for path planning
   long timeleft = 0;
-  while(timeleft<4500*MOVE_CACHE_SIZE && maxfirst!=p) {
-    timeleft+=lines[maxfirst].timeInTicks;
-    NEXT_PLANNER_INDEX(maxfirst);
+  byte idx = lines_pos;
+  if(idx!=lines_commit_pos)
+    NEXT_PLANNER_INDEX(idx); // don't count the line printing
+  while(idx!=lines_commit_pos) {
+    timeleft+=lines[idx].timeInTicks;
+    NEXT_PLANNER_INDEX(idx);
   }
+  while(timeleft<4500*MOVE_CACHE_SIZE && lines_commit_pos!=p) {
+    timeleft+=lines[lines_commit_pos].timeInTicks;
+    commitPlannerLine();
+  }
+  PLANNER_BUSY_HOOK();
+  byte maxfirst = lines_commit_pos; // first non fixed segment
   while(first!=maxfirst && !(lines[first].joinFlags & FLAG_JOIN_END_FIXED)) {
     PREVIOUS_PLANNER_INDEX(first);
   }
@@ -349,13 +497,10 @@ void updateTrapezoids(byte p) {
   }
   // First is now the new element or the first element with non fixed end speed.
   // anyhow, the start speed of first is fixed
-  firstLine = &lines[first];
-  firstLine->flags |= FLAG_BLOCKED; // don't let printer touch this or following segments during update
-  END_INTERRUPT_PROTECTED; 
   byte previdx = p-1;
   if(previdx>=MOVE_CACHE_SIZE) previdx = MOVE_CACHE_SIZE-1;
-  if(lines_count && (lines[previdx].flags & FLAG_WARMUP)==0)
-    computeMaxJunctionSpeed(&lines[previdx],act); // Set maximum junction speed if we have a real move before
+  if(maxfirst!=p && (lines[previdx].flags & FLAG_WARMUP)==0)
+    computeMaxJunctionSpeed(&lines[previdx],act,PLAN_LINE(previdx),PLAN_LINE(p)); // Set maximum junction speed if we have a real move before
   else
     act->joinFlags |= FLAG_JOIN_START_FIXED;
 
@@ -364,14 +509,13 @@ void updateTrapezoids(byte p) {
   forwardPlanner(first);
   
   // Update precomputed data
-  do {
-    updateStepsParameter(&lines[first]);
-    lines[first].flags &= ~FLAG_BLOCKED;  // Flying block to release next used segment as early as possible
+  while(first!=p) {
+    updateStepsParameter(&lines[first],PLAN_LINE(first));
     NEXT_PLANNER_INDEX(first);
-    lines[first].flags |= FLAG_BLOCKED;
-  } while(first!=lines_write_pos);
-  updateStepsParameter(act);
-  act->flags &= ~FLAG_BLOCKED;
+  }
+  updateStepsParameter(act,PLAN_LINE(p));
+  MEMORY_BARRIER();
+  planner_busy = 0;
 }
 
 
@@ -379,37 +523,46 @@ void updateTrapezoids(byte p) {
 // ###                         Motion computations                        ###
 // ##########################################################################
 
-inline float safeSpeed(PrintLine *p) {
+inline float safeSpeed(PrintLine *p,PlanLine *pl) {
     float safe;
     #ifdef USE_ADVANCE
     if((p->dir & 128) && printer_state.isAdvanceActivated()) {
-        safe = min(p->fullSpeed,printer_state.minimumSpeed);
+        safe = min(pl->fullSpeed,printer_state.minimumSpeed);
     } else
     #endif
-    safe = min(p->fullSpeed,max(printer_state.minimumSpeed,printer_state.maxJerk*0.5));
+    safe = min(pl->fullSpeed,max(printer_state.minimumSpeed,printer_state.maxJerk*0.5));
 #if DRIVE_SYSTEM != 3
   if(p->dir & 64) {
-    if(fabs(p->speedZ)>printer_state.maxZJerk*0.5) {
-      float safe2 = printer_state.maxZJerk*0.5*p->fullSpeed/fabs(p->speedZ);
+    if(fabs(pl->speedZ)>printer_state.maxZJerk*0.5) {
+      float safe2 = printer_state.maxZJerk*0.5*pl->fullSpeed/fabs(pl->speedZ);
       if(safe2<safe) safe = safe2;
     }
   }
 #endif
   if(p->dir & 128) {
     if(p->dir & 112) {
-      float safe2 = 0.5*current_extruder->maxStartFeedrate*p->fullSpeed/fabs(p->speedE);
+      float safe2 = 0.5*current_extruder->maxStartFeedrate*pl->fullSpeed/fabs(pl->speedE);
       if(safe2<safe) safe = safe2;
     } else {
       safe = 0.5*current_extruder->maxStartFeedrate; // This is a retraction move
     }
   }
-  return (safe<p->fullSpeed?safe:p->fullSpeed);
+  return (safe<pl->fullSpeed?safe:pl->fullSpeed);
 }
 
 /**
 Move printer the given number of steps. Puts the move into the queue. Used by e.g. homing commands.
 */
 void move_steps(long x,long y,long z,long e,float feedrate,bool waitEnd,bool check_endstop) {
+#if ARC_SUPPORT
+  mc_arc_continue(true);
+#endif
+#if DRIVE_SYSTEM==3
+  delta_split_continue(true);
+#endif
+#if MOVE_COALESCING
+  coalesce_flush();
+#endif
   float saved_feedrate = printer_state.feedrate;
   for(byte i=0; i < 4; i++) {
       printer_state.destinationSteps[i] = printer_state.currentPositionSteps[i];
@@ -420,7 +573,7 @@ void move_steps(long x,long y,long z,long e,float feedrate,bool waitEnd,bool che
   printer_state.destinationSteps[3]+=e;
   printer_state.feedrate = feedrate;
 #if DRIVE_SYSTEM==3
-  split_delta_move(check_endstop,false,false);
+  split_delta_move(check_endstop,false,false,true);
 #else
   queue_move(check_endstop,false);
 #endif
@@ -429,6 +582,86 @@ void move_steps(long x,long y,long z,long e,float feedrate,bool waitEnd,bool che
     wait_until_end_of_move();
 }
 
+#if MOVE_COALESCING
+/** Start of the held back move. printer_state.currentPositionSteps already contains its end, so following
+moves are computed relative to it. */
+long coalesce_start[4];
+float coalesce_feedrate;
+/** Upper bound of the distance in mm between the skipped corners and the held back move. */
+float coalesce_deviation;
+byte coalesce_pending = 0;
+
+inline void coalesce_queue() {
+#if DRIVE_SYSTEM == 3
+  split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true, true); // later moves are computed from the end position
+#else
+  queue_move(ALWAYS_CHECK_ENDSTOPS,true);
+#endif
+}
+/** Queue the held back move, if there is one. destinationSteps and feedrate are preserved. */
+void coalesce_flush() {
+  if(!coalesce_pending) return;
+  coalesce_pending = 0;
+  long dest[4];
+  float feedrate = printer_state.feedrate;
+  for(byte i=0; i < 4; i++) {
+    dest[i] = printer_state.destinationSteps[i];
+    printer_state.destinationSteps[i] = printer_state.currentPositionSteps[i];
+    printer_state.currentPositionSteps[i] = coalesce_start[i];
+  }
+  printer_state.feedrate = coalesce_feedrate;
+  coalesce_queue();
+  printer_state.feedrate = feedrate;
+  for(byte i=0; i < 4; i++)
+    printer_state.destinationSteps[i] = dest[i];
+}
+/** \brief Queue a G0/G1 move to destinationSteps.
+
+The move is merged with the held back move, if the direction and the extrusion per mm are nearly equal.
+Otherwise the held back move is queued and the new move is held back.
+*/
+void coalesce_move() {
+  if(coalesce_pending && printer_state.feedrate==coalesce_feedrate) {
+    float d1[3],d2[3],l1=0,l2=0,dot=0;
+    for(byte i=0; i < 3; i++) {
+      d1[i] = (printer_state.currentPositionSteps[i]-coalesce_start[i])*inv_axis_steps_per_unit[i];
+      d2[i] = (printer_state.destinationSteps[i]-printer_state.currentPositionSteps[i])*inv_axis_steps_per_unit[i];
+      l1 += d1[i]*d1[i];
+      l2 += d2[i]*d2[i];
+      dot += d1[i]*d2[i];
+    }
+    // cos(angle) = dot/sqrt(l1*l2)
+    const float cosMax = cos(MOVE_COALESCE_MAX_ANGLE*M_PI/180.0);
+    if(l1>0 && l2>0 && dot>0 && dot*dot>=cosMax*cosMax*l1*l2) {
+      // Distance of the current end from the merged move |d1 x d2|/|d1+d2|. Earlier skipped corners move
+      // at most by the same distance, because both moves start at coalesce_start.
+      float cx = d1[1]*d2[2]-d1[2]*d2[1];
+      float cy = d1[2]*d2[0]-d1[0]*d2[2];
+      float cz = d1[0]*d2[1]-d1[1]*d2[0];
+      float deviation = coalesce_deviation+sqrt((cx*cx+cy*cy+cz*cz)/(l1+l2+2*dot));
+      // Extrusion per mm e1/sqrt(l1) == e2/sqrt(l2) <=> e1*sqrt(l1*l2) == e2*l1
+      float e1 = (printer_state.currentPositionSteps[3]-coalesce_start[3])*sqrt(l1*l2);
+      float e2 = (printer_state.destinationSteps[3]-printer_state.currentPositionSteps[3])*l1;
+      if(deviation<=MOVE_COALESCE_MAX_DEVIATION && e1*e2>=0 && fabs(e1-e2)<=MOVE_COALESCE_MAX_E_RATIO*max(fabs(e1),fabs(e2))) {
+        coalesce_deviation = deviation;
+        for(byte i=0; i < 4; i++)
+          printer_state.currentPositionSteps[i] = printer_state.destinationSteps[i];
+        if(lines_count==0) coalesce_flush(); // Don't let the printer wait
+        return;
+      }
+    }
+  }
+  coalesce_flush();
+  for(byte i=0; i < 4; i++) {
+    coalesce_start[i] = printer_state.currentPositionSteps[i];
+    printer_state.currentPositionSteps[i] = printer_state.destinationSteps[i];
+  }
+  coalesce_feedrate = printer_state.feedrate;
+  coalesce_deviation = 0;
+  coalesce_pending = 1;
+  if(lines_count==0) coalesce_flush(); // Don't let the printer wait
+}
+#endif
 /** Check if move is new. If it is insert some dummy moves to allow the path optimizer to work since it does
 not act on the first two moves in the queue. The stepper timer will spot these moves and leave some time for
 processing.
@@ -450,7 +683,13 @@ byte check_new_move(byte pathOptimize, byte waitExtraLines) {
       if(lines_write_pos>=MOVE_CACHE_SIZE) lines_write_pos = 0;
 BEGIN_INTERRUPT_PROTECTED
       lines_count++;
+      lines_ticks += p->timeInTicks;
+      lines_commit_pos = lines_write_pos; // Warmup lines never change
+      lines_commit_seq++;
 END_INTERRUPT_PROTECTED
+#if DRIVE_SYSTEM==3 && DELTA_JIT_SEGMENTS
+      delta_gen_lines++;
+#endif
       p = &lines[lines_write_pos];
       w--;
     }
@@ -472,16 +711,16 @@ void log_float_array(PGM_P ptr,float *arr) {
     out.print_float_P(PSTR(" "),arr[i]);
   out.println_float_P(PSTR(" "),arr[3]);
 }
-void log_printLine(PrintLine *p) {
-  out.println_int_P(PSTR("ID:"),(int)p);
+void log_printLine(PrintLine *p,PlanLine *pl) {
+  out.println_int_P(PSTR("ID:"),(int)(size_t)p);
   log_long_array(PSTR("Delta"),p->delta);
   //log_long_array(PSTR("Error"),p->error);
   //out.println_int_P(PSTR("Prim:"),p->primaryAxis);
   out.println_int_P(PSTR("Dir:"),p->dir);
   out.println_int_P(PSTR("Flags:"),p->flags);
-  out.println_float_P(PSTR("fullSpeed:"),p->fullSpeed);
+  out.println_float_P(PSTR("fullSpeed:"),pl->fullSpeed);
   out.println_long_P(PSTR("vMax:"),p->vMax);
-  out.println_float_P(PSTR("Acceleration:"),p->acceleration);
+  out.println_float_P(PSTR("Acceleration:"),PLANNER2_TO_FLOAT(pl->acceleration));
   out.println_long_P(PSTR("Acceleration Prim:"),p->accelerationPrim);
   //out.println_long_P(PSTR("Acceleration Timer:"),p->facceleration);
   out.println_long_P(PSTR("Remaining steps:"),p->stepsRemaining);
@@ -494,21 +733,140 @@ void log_printLine(PrintLine *p) {
 }
 
 
-void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte pathOptimize)
+#ifdef DEBUG_PLANNER_STATS
+PlannerStats planner_stats;
+unsigned long planner_stats_mark; ///< Clock at the start of the not yet counted planning time
+long planner_stats_line;          ///< Planning time of the current line so far
+/** Adds the planning time since planner_stats_mark to the totals. With lineEnd set, the current line is complete. */
+void planner_stats_charge(byte lineEnd) {
+  unsigned long now = PLANNER_STATS_CLOCK();
+  long t = now-planner_stats_mark;
+  planner_stats_mark = now;
+  planner_stats.planTime += t;
+  planner_stats_line += t;
+  if(lineEnd) {
+    planner_stats.moves++;
+    if(planner_stats_line>planner_stats.maxPlanTime) planner_stats.maxPlanTime = planner_stats_line;
+    planner_stats_line = 0;
+  }
+}
+/** Writes planner statistics and resets them if requested. */
+void planner_stats_report(byte reset) {
+  OUT_P_L_LN("Planned lines:",planner_stats.moves);
+  if(planner_stats.moves)
+    OUT_P_L_LN("Avg. planning time [" PLANNER_STATS_UNIT "]:",planner_stats.planTime/planner_stats.moves);
+  OUT_P_L_LN("Max. planning time [" PLANNER_STATS_UNIT "]:",planner_stats.maxPlanTime);
+  OUT_P_L_LN("Cache low slowdowns:",planner_stats.slowdowns);
+  OUT_P("Cache occupancy:");
+  for(byte i=0;i<=MOVE_CACHE_SIZE;i++) {
+    out.print(' ');
+    out.print(planner_stats.occupancy[i]);
+  }
+  out.println();
+  if(reset) memset(&planner_stats,0,sizeof(PlannerStats));
+}
+#endif
+
+unsigned long buffer_starvations = 0; ///< Lines added while the move cache had run empty during a print
+unsigned long buffer_slowdowns = 0;   ///< Lines slowed down because the buffered time was below MOVE_BUFFER_HORIZON
+/** Writes move buffer starvation counters and resets them if requested. */
+void buffer_stats_report(byte reset) {
+  long buffered;
+BEGIN_INTERRUPT_PROTECTED
+  buffered = lines_ticks;
+END_INTERRUPT_PROTECTED
+  OUT_P_L_LN("Buffer starvations:",buffer_starvations);
+  OUT_P_L_LN("Buffer slowdowns:",buffer_slowdowns);
+  OUT_P_L_LN("Buffered time [ms]:",buffered/(F_CPU/1000));
+  unsigned long stalls;
+BEGIN_INTERRUPT_PROTECTED
+  stalls = planner_stalls;
+  if(reset) planner_stalls = 0;
+END_INTERRUPT_PROTECTED
+  OUT_P_L_LN("Planner stalls:",stalls);
+  if(reset) buffer_starvations = buffer_slowdowns = 0;
+}
+
+/** Waits until less than maxLines lines are in the move cache. Serial input and periodical tasks go on
+meanwhile. The wait doesn't count as planning time. */
+void wait_for_move_cache(byte maxLines) {
+  if(lines_count<maxLines) return;
+  PLANNER_STATS_CHARGE;
+  while(lines_count>=maxLines) {
+    gcode_read_serial();
+    check_periodical();
+  }
+  PLANNER_STATS_RESUME;
+}
+
+#if PLANNER_CACHE_SIZE<MOVE_CACHE_SIZE
+/** Frees the planner data for the line at lines_write_pos.
+
+The PlanLine entry is shared with the line PLANNER_CACHE_SIZE positions earlier. If that line is not
+committed yet, it gets committed, so neither the path planner nor the stepper interrupt will read the
+entry again.
+*/
+inline void releasePlanLine() {
+  planner_busy = 1;
+  MEMORY_BARRIER();
+  byte uncommitted = lines_write_pos+MOVE_CACHE_SIZE-lines_commit_pos;
+  if(uncommitted>=MOVE_CACHE_SIZE) uncommitted-=MOVE_CACHE_SIZE;
+  while(uncommitted>=PLANNER_CACHE_SIZE) {
+    commitPlannerLine();
+    uncommitted--;
+  }
+  MEMORY_BARRIER();
+  planner_busy = 0;
+}
+#endif
+
+/**
+  Computes the speeds for the line at lines_write_pos and adds it to the cache.
+  @param distance Length of the move in mm.
+*/
+void calculate_move(PrintLine *p,float axis_diff[],float distance,byte check_endstops,byte pathOptimize)
 {
+#ifdef DEBUG_PLANNER_STATS
+  planner_stats.occupancy[lines_count]++;
+#endif
+#if PLANNER_CACHE_SIZE<MOVE_CACHE_SIZE
+  releasePlanLine();
+#endif
+  PlanLine *pl = PLAN_LINE(lines_write_pos);
+  pl->distance = distance;
 #if DRIVE_SYSTEM==3
   long axis_interval[5];
 #else
   long axis_interval[4];
 #endif
-  float time_for_move = (float)(F_CPU)*p->distance / printer_state.feedrate; // time is in ticks
+#if DRIVE_SYSTEM!=3 && ARC_SUPPORT
+  p->moveID = lastMoveID; // Set in split_delta_move for delta printer
+  if(!arc_pending) lastMoveID++; // Segments of one arc share the id
+#endif
+  float time_for_move = (float)(F_CPU)*pl->distance / printer_state.feedrate; // time is in ticks
   bool critical=false;
-  if(lines_count<MOVE_CACHE_LOW && time_for_move<LOW_TICKS_PER_MOVE) { // Limit speed to keep cache full.
-    //OUT_P_I("L:",lines_count);
-    time_for_move += (3*(LOW_TICKS_PER_MOVE-time_for_move))/(lines_count+1); // Increase time if queue gets empty. Add more time if queue gets smaller.
+  long buffered;
+BEGIN_INTERRUPT_PROTECTED
+  buffered = lines_ticks;
+END_INTERRUPT_PROTECTED
+  if(lines_count==0 && waitRelax) buffer_starvations++; // Queue ran dry while a print was going on
+#if MOVE_BUFFER_HORIZON>0
+  if(buffered<BUFFER_HORIZON_TICKS && time_for_move<LOW_TICKS_PER_MOVE) { // Limit speed to keep cache full.
+    //OUT_P_L("B:",buffered);
+    // Increase time if buffered time gets low. Add more time the less time is left.
+    time_for_move += 3.0*(LOW_TICKS_PER_MOVE-time_for_move)*(float)(BUFFER_HORIZON_TICKS-buffered)/(float)BUFFER_HORIZON_TICKS;
     //OUT_P_F_LN("Slow ",time_for_move);
     critical=true;
+    buffer_slowdowns++;
+#ifdef DEBUG_PLANNER_STATS
+    planner_stats.slowdowns++;
+#endif
   }
+#endif
+#if STEP_OVERRUN_SLOWDOWN>0
+  if(step_overrun_slowdown) // Stepper interrupt misses deadlines, reduce feedrate
+    time_for_move = time_for_move*100.0/(float)(100-step_overrun_slowdown);
+#endif
   p->timeInTicks = time_for_move;
   UI_MEDIUM; // do check encoder
   // Compute the solwest allowed interval (ticks/step), so maximum feedrate is not violated
@@ -533,28 +891,31 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
   float inv_time_s = (float)F_CPU/time_for_move;
   if(p->dir & 16) {
     axis_interval[0] = time_for_move/p->delta[0];
-    p->speedX = axis_diff[0]*inv_time_s;
-    if(!(p->dir & 1)) p->speedX = -p->speedX;
-  } else p->speedX = 0;
+    pl->speedX = axis_diff[0]*inv_time_s;
+    if(!(p->dir & 1)) pl->speedX = -pl->speedX;
+  } else pl->speedX = 0;
   if(p->dir & 32) {
     axis_interval[1] = time_for_move/p->delta[1];
-    p->speedY = axis_diff[1]*inv_time_s;
-    if(!(p->dir & 2)) p->speedY = -p->speedY;
-  } else p->speedY = 0;
+    pl->speedY = axis_diff[1]*inv_time_s;
+    if(!(p->dir & 2)) pl->speedY = -pl->speedY;
+  } else pl->speedY = 0;
   if(p->dir & 64) {
     axis_interval[2] = time_for_move/p->delta[2];
-    p->speedZ = axis_diff[2]*inv_time_s;
-    if(!(p->dir & 4)) p->speedZ = -p->speedZ;
-  } else p->speedZ = 0;
+    pl->speedZ = axis_diff[2]*inv_time_s;
+    if(!(p->dir & 4)) pl->speedZ = -pl->speedZ;
+  } else pl->speedZ = 0;
   if(p->dir & 128) {
     axis_interval[3] = time_for_move/p->delta[3];
-    p->speedE = axis_diff[3]*inv_time_s;
-    if(!(p->dir & 8)) p->speedE = -p->speedE;
+    pl->speedE = axis_diff[3]*inv_time_s;
+    if(!(p->dir & 8)) pl->speedE = -pl->speedE;
   }
 #if DRIVE_SYSTEM==3
   axis_interval[4] = time_for_move/p->stepsRemaining;
 #endif
-  p->fullSpeed = p->distance*inv_time_s;
+  pl->fullSpeed = pl->distance*inv_time_s;
+#ifdef FIXED_POINT_PLANNER
+  pl->fullSpeedFixed = PLANNER_SPEED(pl->fullSpeed);
+#endif
 
 
   //long interval = axis_interval[primary_axis]; // time for every step in ticks with full speed
@@ -583,14 +944,19 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
 #if DRIVE_SYSTEM==3
     p->error[3] = p->stepsRemaining >> 1;
 #endif
-    p->invFullSpeed = 1.0/p->fullSpeed;
+    pl->invFullSpeed = 1.0/pl->fullSpeed;
+#if JUNCTION_MODEL==1
+    pl->unitX = pl->speedX*pl->invFullSpeed;
+    pl->unitY = pl->speedY*pl->invFullSpeed;
+    pl->unitZ = pl->speedZ*pl->invFullSpeed;
+#endif
     p->accelerationPrim = slowest_axis_plateau_time_repro / axis_interval[p->primaryAxis]; // a = v/t = F_CPU/(c*t): Steps/s^2
     //Now we can calculate the new primary axis acceleration, so that the slowest axis max acceleration is not violated
     p->facceleration = 262144.0*(float)p->accelerationPrim/F_CPU; // will overflow without float!
-    p->acceleration = 2.0*p->distance*slowest_axis_plateau_time_repro*p->fullSpeed/((float)F_CPU); // mm^2/s^2
-    p->startSpeed = p->endSpeed = safeSpeed(p);
+    pl->acceleration = PLANNER_SPEED2(2.0*pl->distance*slowest_axis_plateau_time_repro*pl->fullSpeed/((float)F_CPU)); // mm^2/s^2
+    pl->startSpeed = pl->endSpeed = PLANNER_SPEED(safeSpeed(p,pl));
 	// Can accelerate to full speed within the line
-	if (sqrt(p->startSpeed*p->startSpeed+p->acceleration) >= p->fullSpeed)
+	if (plannerAccelerate(pl->startSpeed,pl->acceleration) >= PLANNER_FULL_SPEED(pl))
 	  p->flags |= FLAG_NOMINAL;
 
     p->vMax = F_CPU / p->fullInterval; // maximum steps per second, we can reach
@@ -605,27 +971,27 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
 #endif
     p->advanceL = 0;
   } else {
-    float advlin = fabs(p->speedE)*current_extruder->advanceL*0.001*axis_steps_per_unit[3];
+    float advlin = fabs(pl->speedE)*current_extruder->advanceL*0.001*axis_steps_per_unit[3];
     p->advanceL = (65536*advlin)/p->vMax; //advanceLscaled = (65536*vE*k2)/vMax
- #ifdef ENABLE_QUADRATIC_ADVANCE;
-    p->advanceFull = 65536*current_extruder->advanceK*p->speedE*p->speedE; // Steps*65536 at full speed
+ #ifdef ENABLE_QUADRATIC_ADVANCE
+    p->advanceFull = 65536*current_extruder->advanceK*pl->speedE*pl->speedE; // Steps*65536 at full speed
     long steps = (U16SquaredToU32(p->vMax))/(p->accelerationPrim<<1); // v^2/(2*a) = steps needed to accelerate from 0-vMax
     p->advanceRate = p->advanceFull/steps;
     if((p->advanceFull>>16)>maxadv) {
         maxadv = (p->advanceFull>>16);
-        maxadvspeed = fabs(p->speedE);
+        maxadvspeed = fabs(pl->speedE);
     }
  #endif
     if(advlin>maxadv2) {
       maxadv2 = advlin;
-      maxadvspeed = fabs(p->speedE);
+      maxadvspeed = fabs(pl->speedE);
     }
   }
 #endif
     UI_MEDIUM; // do check encoder
     updateTrapezoids(lines_write_pos);
     // how much steps on primary axis do we need to reach target feedrate
-    //p->plateauSteps = (long) (((float)p->acceleration *0.5f / slowest_axis_plateau_time_repro + p->vMin) *1.01f/slowest_axis_plateau_time_repro);
+    //p->plateauSteps = (long) (((float)pl->acceleration *0.5f / slowest_axis_plateau_time_repro + p->vMin) *1.01f/slowest_axis_plateau_time_repro);
   #else
   #ifdef USE_ADVANCE
   #ifdef ENABLE_QUADRATIC_ADVANCE
@@ -636,7 +1002,7 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
   #endif
 
   // Correct integers for fixed point math used in bresenham_step
-  if(p->fullInterval<MAX_HALFSTEP_INTERVAL || critical)
+  if(!HALFSTEPPING || p->fullInterval<MAX_HALFSTEP_INTERVAL || critical)
     p->halfstep = 0;
   else {
     p->halfstep = 1;
@@ -655,9 +1021,9 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
 #endif
 #ifdef DEBUG_QUEUE_MOVE
   if(DEBUG_ECHO) {
-    log_printLine(p);
+    log_printLine(p,pl);
       OUT_P_L_LN("limitInterval:", limitInterval);
-      OUT_P_F_LN("Move distance on the XYZ space:", p->distance);
+      OUT_P_F_LN("Move distance on the XYZ space:", pl->distance);
       OUT_P_F_LN("Commanded feedrate:", printer_state.feedrate);
       OUT_P_F_LN("Constant full speed move time:", time_for_move);
       //log_long_array(PSTR("axis_int"),(long*)axis_interval);
@@ -669,7 +1035,12 @@ void calculate_move(PrintLine *p,float axis_diff[],byte check_endstops,byte path
   if (pathOptimize) waitRelax = 70;
 BEGIN_INTERRUPT_PROTECTED
   lines_count++;
+  lines_ticks += p->timeInTicks;
 END_INTERRUPT_PROTECTED
+#if DRIVE_SYSTEM==3 && DELTA_JIT_SEGMENTS
+  delta_gen_lines++;
+#endif
+  PLANNER_STATS_LINE_END;
   DEBUG_MEMORY;
 }
 
@@ -681,11 +1052,9 @@ END_INTERRUPT_PROTECTED
   @param check_endstops Read endstop during move.
 */
 void queue_move(byte check_endstops,byte pathOptimize) {
+  PLANNER_STATS_BEGIN;
   printer_state.flag0 &= ~PRINTER_FLAG0_STEPPER_DISABLED; // Motor is enabled now
-  while(lines_count>=MOVE_CACHE_SIZE) { // wait for a free entry in movement cache
-    gcode_read_serial();
-    check_periodical();
-  }
+  wait_for_move_cache(MOVE_CACHE_SIZE); // wait for a free entry in movement cache
   byte newPath=check_new_move(pathOptimize, 0);
   PrintLine *p = &lines[lines_write_pos];
   float axis_diff[4]; // Axis movement in mm
@@ -760,22 +1129,23 @@ void queue_move(byte check_endstops,byte pathOptimize) {
 #endif
   if((p->dir & 240)==0) {
     if(newPath) { // need to delete dummy elements, otherwise commands can get locked.
+BEGIN_INTERRUPT_PROTECTED
       lines_count = 0;
-      lines_pos = lines_write_pos;
+      lines_ticks = 0;
+      lines_pos = lines_commit_pos = lines_write_pos;
+      lines_commit_seq = lines_done_seq;
+END_INTERRUPT_PROTECTED
     }
     return; // No steps included
   }
   byte primary_axis;
-  float xydist2;
+  float xydist2,distance;
 #if USE_OPS==1
   p->opsReverseSteps=0;
 #endif
 #if ENABLE_BACKLASH_COMPENSATION
   if((p->dir & 112) && ((p->dir & 7)^(printer_state.backlashDir & 7)) & (printer_state.backlashDir >> 3)) { // We need to compensate backlash, add a move
-    while(lines_count>=MOVE_CACHE_SIZE-1) { // wait for a second free entry in movement cache
-      gcode_read_serial();
-      check_periodical();
-    }
+    wait_for_move_cache(MOVE_CACHE_SIZE-1); // wait for a second free entry in movement cache
     byte wpos2 = lines_write_pos+1;
     if(wpos2>=MOVE_CACHE_SIZE) wpos2 = 0;
     PrintLine *p2 = &lines[wpos2];
@@ -800,12 +1170,18 @@ void queue_move(byte check_endstops,byte pathOptimize) {
     //Feedrate calc based on XYZ travel distance
     xydist2 = back_diff[0] * back_diff[0] + back_diff[1] * back_diff[1];
     if(p->dir & 64) {
-      p->distance = sqrt(xydist2 + back_diff[2] * back_diff[2]);
+      distance = sqrt(xydist2 + back_diff[2] * back_diff[2]);
     } else {
-      p->distance = sqrt(xydist2);
+      distance = sqrt(xydist2);
     }
     printer_state.backlashDir = (printer_state.backlashDir & 56) | (p2->dir & 7);
-    calculate_move(p,back_diff,false,pathOptimize);    
+#if ARC_SUPPORT
+    lastMoveID++; // Backlash move never joins an arc
+#endif
+    calculate_move(p,back_diff,distance,false,pathOptimize);    
+#if ARC_SUPPORT
+    lastMoveID++;
+#endif
     p = p2; // use saved instance for the real move
   } 
 #endif
@@ -835,29 +1211,80 @@ void queue_move(byte check_endstops,byte pathOptimize) {
     xydist2 = dx*dx+dy*dy;
 #endif
     if(p->dir & 64) {
-      p->distance = sqrt(xydist2 + axis_diff[2] * axis_diff[2]);
+      distance = sqrt(xydist2 + axis_diff[2] * axis_diff[2]);
     } else {
-      p->distance = sqrt(xydist2);
+      distance = sqrt(xydist2);
     }
   }  else if(p->dir & 128)
-    p->distance = fabs(axis_diff[3]);
+    distance = fabs(axis_diff[3]);
   else {
     return; // no steps to take, we are finished
   }
-  calculate_move(p,axis_diff,check_endstops,pathOptimize);
+  calculate_move(p,axis_diff,distance,check_endstops,pathOptimize);
 }
 #endif
 
 #if DRIVE_SYSTEM==3
-#define DEBUG_DELTA_OVERFLOW
+/**
+  Compute a delta segment from the current tower positions to a cartesian position.
+  @param d Segment to fill.
+  @param cart Cartesian target in steps.
+  @param towers Current tower positions, updated to the target.
+  @param maxTowers Tower positions are clipped to these values, 0 for no clipping.
+  @return The largest tower move of the segment or -1 if the position can't be reached.
+*/
+long compute_delta_segment(DeltaSegment *d, long cart[], long towers[], long *maxTowers) {
+	long destination_delta_steps[3];
+	long max_axis_move = 0;
+	d->dir = 0;
+	// Verify that delta calc has a solution
+	if (calculate_delta(cart, destination_delta_steps)) {
+		for(byte i=0; i < NUM_AXIS - 1; i++) {
+			if (maxTowers && destination_delta_steps[i] > maxTowers[i])
+				destination_delta_steps[i] = maxTowers[i];
+			long delta = destination_delta_steps[i] - towers[i];
+//#ifdef DEBUG_DELTA_CALC
+//			out.println_long_P(PSTR("dest:"), destination_delta_steps[i]);
+//			out.println_long_P(PSTR("cur:"), towers[i]);
+//#endif
+			if (delta == 0) {
+				d->deltaSteps[i] = 0;
+			} else if (delta > 0) {
+				d->dir |= 17<<i;
+	#if !DELTA_JIT_SEGMENTS
+				if (delta > DELTA_MAX_SEGMENT_STEPS)
+					out.println_long_P(PSTR("Delta overflow:"), delta);
+	#endif
+				d->deltaSteps[i] = delta;
+			} else {
+				d->dir |= 16<<i;
+	#if !DELTA_JIT_SEGMENTS
+				if (-delta > DELTA_MAX_SEGMENT_STEPS)
+					out.println_long_P(PSTR("Delta overflow:"), delta);
+	#endif
+				d->deltaSteps[i] = -delta;
+			}
+			if (max_axis_move < (long)d->deltaSteps[i]) max_axis_move = d->deltaSteps[i];
+			towers[i] = destination_delta_steps[i];
+		}
+		return max_axis_move;
+	}
+	for(byte i=0; i < NUM_AXIS - 1; i++) {
+		d->deltaSteps[i]=0;
+	}
+	return -1;
+}
+
 /**
   Calculate and cache the delta robot positions of the cartesian move in a line.
+  With DELTA_JIT_SEGMENTS the segments are only computed to get the step counts and
+  delta_generate_segments computes them again, when they are needed.
   @return The largest delta axis move in a single segment
   @param p The line to examine.
 */
 inline long calculate_delta_segments(PrintLine *p, byte softEndstop) {
 
-	long destination_steps[3], destination_delta_steps[3];
+	long destination_steps[3];
 
 	for(byte i=0; i < NUM_AXIS - 1; i++) {
 		// Save current position
@@ -865,75 +1292,59 @@ inline long calculate_delta_segments(PrintLine *p, byte softEndstop) {
 	}
 
 //	out.println_byte_P(PSTR("Calculate delta segments:"), p->numDeltaSegments);
-	p->deltaSegmentReadPos = delta_segment_write_pos;
 #ifdef DEBUG_STEPCOUNT
 	p->totalStepsRemaining=0;
 #endif
 
 	long max_axis_move = 0;
+#if DELTA_JIT_SEGMENTS
+	for(byte i=0; i < NUM_AXIS - 1; i++) {
+		p->deltaCartStart[i] = destination_steps[i];
+		p->deltaCartEnd[i] = printer_state.destinationSteps[i];
+		p->deltaTowerStart[i] = printer_state.currentDeltaPositionSteps[i];
+		// Homing or a changed geometry may change maxDeltaPositionSteps before the segments are generated
+		p->deltaMaxSteps[i] = (softEndstop ? printer_state.maxDeltaPositionSteps[i] : 0x7fffffffL);
+	}
+	p->deltaSegmentsReady = 0;
+	DeltaSegment segment;
+#else
+	// delta_split_line waited until all segments of the line fit
+	p->deltaSegmentReadPos = delta_segment_write_pos;
 	unsigned int produced_segments = 0;
+#endif
 	for (int s = p->numDeltaSegments; s > 0; s--) {
 		for(byte i=0; i < NUM_AXIS - 1; i++)
 			destination_steps[i] += (printer_state.destinationSteps[i] - destination_steps[i]) / s;
 
-		// Wait for buffer here
-		while(delta_segment_count + produced_segments>=DELTA_CACHE_SIZE) { // wait for a free entry in movement cache
-			gcode_read_serial();
-			check_periodical();
-		}
-
+#if DELTA_JIT_SEGMENTS
+		DeltaSegment *d = &segment;
+#else
 		DeltaSegment *d = &segments[delta_segment_write_pos];
-
-		// Verify that delta calc has a solution
-		if (calculate_delta(destination_steps, destination_delta_steps)) {
-			d->dir = 0;
-			for(byte i=0; i < NUM_AXIS - 1; i++) {
-				if (softEndstop && destination_delta_steps[i] > printer_state.maxDeltaPositionSteps)
-					destination_delta_steps[i] = printer_state.maxDeltaPositionSteps;
-				long delta = destination_delta_steps[i] - printer_state.currentDeltaPositionSteps[i];
-//#ifdef DEBUG_DELTA_CALC
-//				out.println_long_P(PSTR("dest:"), destination_delta_steps[i]);
-//				out.println_long_P(PSTR("cur:"), printer_state.currentDeltaPositionSteps[i]);
-//#endif
-				if (delta == 0) {
-					d->deltaSteps[i] = 0;
-				} else if (delta > 0) {
-					d->dir |= 17<<i;
-	#ifdef DEBUG_DELTA_OVERFLOW
-					if (delta > 65535)
-						out.println_long_P(PSTR("Delta overflow:"), delta);
-	#endif
-					d->deltaSteps[i] = delta;
-				} else {
-					d->dir |= 16<<i;
-	#ifdef DEBUG_DELTA_OVERFLOW
-					if (-delta > 65535)
-						out.println_long_P(PSTR("Delta overflow:"), delta);
-	#endif
-					d->deltaSteps[i] = -delta;
-				}
-	#ifdef DEBUG_STEPCOUNT
-				p->totalStepsRemaining += d->deltaSteps[i];
-	#endif
-
-				if (max_axis_move < d->deltaSteps[i]) max_axis_move = d->deltaSteps[i];
-				printer_state.currentDeltaPositionSteps[i] = destination_delta_steps[i];
-			}
-		} else {
+#endif
+#if DELTA_JIT_SEGMENTS
+		long axis_move = compute_delta_segment(d, destination_steps, printer_state.currentDeltaPositionSteps, p->deltaMaxSteps);
+#else
+		long axis_move = compute_delta_segment(d, destination_steps, printer_state.currentDeltaPositionSteps, softEndstop ? printer_state.maxDeltaPositionSteps : 0);
+#endif
+		if (axis_move < 0) {
 			// Illegal position - idnore move
 			out.println_P(PSTR("Invalid delta coordinate - move ignored"));
-			d->dir = 0;
-			for(byte i=0; i < NUM_AXIS - 1; i++) {
-				d->deltaSteps[i]=0;
-			}
-		}
+		} else if (max_axis_move < axis_move) max_axis_move = axis_move;
+	#ifdef DEBUG_STEPCOUNT
+		p->totalStepsRemaining += (long)d->deltaSteps[0]+d->deltaSteps[1]+d->deltaSteps[2];
+	#endif
+#if !DELTA_JIT_SEGMENTS
 		// Move to the next segment
 		delta_segment_write_pos++; if (delta_segment_write_pos >= DELTA_CACHE_SIZE) delta_segment_write_pos=0;
 		produced_segments++;
+#endif
 	}
+#if !DELTA_JIT_SEGMENTS
 	BEGIN_INTERRUPT_PROTECTED
 	delta_segment_count+=produced_segments;
+	if(delta_segment_count>delta_segment_peak) delta_segment_peak = delta_segment_count;
 	END_INTERRUPT_PROTECTED
+#endif
 
 	#ifdef DEBUG_STEPCOUNT
 //		out.println_long_P(PSTR("totalStepsRemaining:"), p->totalStepsRemaining);
@@ -941,6 +1352,77 @@ inline long calculate_delta_segments(PrintLine *p, byte softEndstop) {
 	return max_axis_move;
 }
 
+#if DELTA_JIT_SEGMENTS
+byte delta_gen_line = 0;		///< Next line that needs its segments
+byte delta_gen_lines = 0;		///< Queued lines, which are not processed by the segment generator
+byte delta_gen_left = 0;		///< Segments to generate for delta_gen_line, 0 = line not started
+long delta_gen_cart[3];			///< Cartesian position of the last generated segment
+long delta_gen_towers[3];		///< Tower positions of the last generated segment
+/** \brief Fill the delta segment cache with the segments of the next queued lines.
+
+Repeats the computation of calculate_delta_segments with the positions stored in the line, so the
+segments and step counts are identical to the ones the line was planned with. Lines are processed in
+queue order and a line gets deltaSegmentsReady when all its segments are in the cache. Returns when the
+cache is full or all queued lines are done. Called from the main loop and all wait loops.
+*/
+void delta_generate_segments() {
+	while(delta_gen_lines) {
+		PrintLine *p = &lines[delta_gen_line];
+		if(delta_gen_left==0) { // Start a new line
+			if((p->flags & FLAG_WARMUP) || p->numDeltaSegments==0) {
+				delta_gen_line++; if (delta_gen_line >= MOVE_CACHE_SIZE) delta_gen_line=0;
+				delta_gen_lines--;
+				continue;
+			}
+			if(delta_segment_count>=DELTA_CACHE_SIZE) return;
+			for(byte i=0; i < NUM_AXIS - 1; i++) {
+				delta_gen_cart[i] = p->deltaCartStart[i];
+				delta_gen_towers[i] = p->deltaTowerStart[i];
+			}
+			p->deltaSegmentReadPos = delta_segment_write_pos;
+			delta_gen_left = p->numDeltaSegments;
+		}
+		if(delta_segment_count>=DELTA_CACHE_SIZE) return;
+		for(byte i=0; i < NUM_AXIS - 1; i++)
+			delta_gen_cart[i] += (p->deltaCartEnd[i] - delta_gen_cart[i]) / delta_gen_left;
+		compute_delta_segment(&segments[delta_segment_write_pos], delta_gen_cart, delta_gen_towers, p->deltaMaxSteps);
+		delta_segment_write_pos++; if (delta_segment_write_pos >= DELTA_CACHE_SIZE) delta_segment_write_pos=0;
+		BEGIN_INTERRUPT_PROTECTED
+		delta_segment_count++;
+		if(delta_segment_count>delta_segment_peak) delta_segment_peak = delta_segment_count;
+		END_INTERRUPT_PROTECTED
+		if(--delta_gen_left==0) {
+			MEMORY_BARRIER(); // deltaSegmentReadPos must be written before the line gets ready
+			p->deltaSegmentsReady = 1;
+			delta_gen_line++; if (delta_gen_line >= MOVE_CACHE_SIZE) delta_gen_line=0;
+			delta_gen_lines--;
+		}
+	}
+}
+#endif
+
+/** Writes size and use of the delta segment cache and resets peak and waits if requested. */
+void delta_segment_report(byte reset) {
+	unsigned int used;
+	BEGIN_INTERRUPT_PROTECTED
+	used = delta_segment_count;
+	END_INTERRUPT_PROTECTED
+	OUT_P_I_LN("Delta segments:",DELTA_CACHE_SIZE);
+	OUT_P_I_LN("Used:",used);
+	OUT_P_I_LN("Peak:",delta_segment_peak);
+	OUT_P_L_LN("Waits:",delta_segment_waits);
+#if DELTA_JIT_SEGMENTS
+	OUT_P_L_LN("Stalls:",delta_segment_stalls);
+#endif
+	if(reset) {
+		delta_segment_peak = used;
+		delta_segment_waits = 0;
+#if DELTA_JIT_SEGMENTS
+		delta_segment_stalls = 0;
+#endif
+	}
+}
+
 /**
   Set delta tower positions
   @param xaxis X tower position.
@@ -953,36 +1435,160 @@ inline void set_delta_position(long xaxis, long yaxis, long zaxis) {
 	printer_state.currentDeltaPositionSteps[2] = zaxis;
 }
 
+#if DELTA_INCREMENTAL_IK
+typedef long delta_coord_t;
+#else
+typedef float delta_coord_t;
+#endif
+delta_coord_t delta_tower_x[3];     ///< Tower x positions in steps including the corrections
+delta_coord_t delta_tower_y[3];     ///< Tower y positions in steps including the corrections
+delta_coord_t delta_rod_squared[3]; ///< Squared rod length per tower in steps^2
+
+/** Sets the per tower corrections to the values from the configuration. */
+void delta_reset_corrections() {
+	const float rod[3] = DELTA_ROD_CORRECTION;
+	const float radius[3] = DELTA_RADIUS_CORRECTION;
+	const float angle[3] = DELTA_ANGLE_CORRECTION;
+	for(byte i=0; i < 3; i++) {
+		printer_state.deltaRodCorrection[i] = rod[i];
+		printer_state.deltaRadiusCorrection[i] = radius[i];
+		printer_state.deltaAngleCorrection[i] = angle[i];
+	}
+}
+
+/**
+  Computes tower positions and rod lengths used by calculate_delta from the per tower corrections.
+  Must be called after the corrections change.
+*/
+void delta_update_geometry() {
+	const float angle[3] = {210,330,90}; // Nominal tower angles in degree
+	const float towerX[3] = {DELTA_TOWER1_X_STEPS,DELTA_TOWER2_X_STEPS,DELTA_TOWER3_X_STEPS};
+	const float towerY[3] = {DELTA_TOWER1_Y_STEPS,DELTA_TOWER2_Y_STEPS,DELTA_TOWER3_Y_STEPS};
+	for(byte i=0; i < 3; i++) {
+		// Towers without corrections use the constants calculate_delta always used
+		float x = towerX[i],y = towerY[i];
+		if(printer_state.deltaAngleCorrection[i]!=0 || printer_state.deltaRadiusCorrection[i]!=0) {
+			float a = (angle[i]+printer_state.deltaAngleCorrection[i])*(M_PI/180.0);
+			float radius = (DELTA_RADIUS+printer_state.deltaRadiusCorrection[i])*AXIS_STEPS_PER_MM;
+			x = radius*cos(a);
+			y = radius*sin(a);
+		}
+		float rod = (DELTA_DIAGONAL_ROD+printer_state.deltaRodCorrection[i])*AXIS_STEPS_PER_MM;
+		float rod2 = (printer_state.deltaRodCorrection[i]!=0 ? rod*rod : DELTA_DIAGONAL_ROD_STEPS_SQUARED);
+#if DELTA_INCREMENTAL_IK
+		delta_tower_x[i] = (long)(x<0 ? x-0.5 : x+0.5);
+		delta_tower_y[i] = (long)(y<0 ? y-0.5 : y+0.5);
+		delta_rod_squared[i] = (long)rod2;
+#else
+		delta_tower_x[i] = x;
+		delta_tower_y[i] = y;
+		delta_rod_squared[i] = rod2;
+#endif
+	}
+}
+
+#if DELTA_INCREMENTAL_IK
+long delta_root[3] = {0,0,0}; ///< Last square root per tower, start value for the next one
+
+/** \brief Square root of val rounded down, started at the last root of the tower.
+
+Uses Newton iterations if the start value is within 25% of the result, else isqrt32.
+The iteration ends if the correction is at most 1 step, the rest is fixed by comparing squares.
+Not inline, so host/deltasqrt.cpp can check it.
+*/
+long delta_sqrt(long val,long *root) {
+  long r = *root;
+  long d = 0;
+  if(r>0) d = (val-(long)((unsigned long)r*r))/(r<<1);
+  if(r<=0 || d>(r>>2) || -d>(r>>2))
+    r = isqrt32(val);
+  else {
+    while(d>1 || d<-1) {
+      r += d;
+      d = (val-(long)((unsigned long)r*r))/(r<<1);
+    }
+    while((unsigned long)r*r>(unsigned long)val) r--;
+    while((unsigned long)(r+1)*(r+1)<=(unsigned long)val) r++;
+  }
+  *root = r;
+  return r;
+}
+#endif
+
 /**
-  Calculate the delta tower position from a cartesian position
+  Calculate the delta tower position from a cartesian position. With DELTA_INCREMENTAL_IK
+  integer math is used, else float math.
   @param cartesianPosSteps Array containing cartesian coordinates.
   @param deltaPosSteps Result array with tower coordinates.
   @returns 1 if cartesian coordinates have a valid delta tower position 0 if not.
 */
 byte calculate_delta(long cartesianPosSteps[], long deltaPosSteps[]) {
-	long temp;
-	long opt = DELTA_DIAGONAL_ROD_STEPS_SQUARED - sq(DELTA_TOWER1_Y_STEPS - cartesianPosSteps[Y_AXIS]);
-
-	if ((temp = opt - sq(DELTA_TOWER1_X_STEPS - cartesianPosSteps[X_AXIS])) >= 0)
-		deltaPosSteps[X_AXIS] = sqrt(temp) + cartesianPosSteps[Z_AXIS];
-	else
-		return 0;
-
-	if ((temp = opt - sq(DELTA_TOWER2_X_STEPS - cartesianPosSteps[X_AXIS])) >= 0)
-		deltaPosSteps[Y_AXIS] = sqrt(temp) + cartesianPosSteps[Z_AXIS];
-	else
-		return 0;
-
-	if ((temp = DELTA_DIAGONAL_ROD_STEPS_SQUARED
-		 - sq(DELTA_TOWER3_X_STEPS - cartesianPosSteps[X_AXIS])
-		 - sq(DELTA_TOWER3_Y_STEPS - cartesianPosSteps[Y_AXIS])) >= 0)
-		deltaPosSteps[Z_AXIS] = sqrt(temp) + cartesianPosSteps[Z_AXIS];
-	else
-		return 0;
+	for(byte i=0; i < 3; i++) {
+		delta_coord_t dx = delta_tower_x[i] - cartesianPosSteps[X_AXIS];
+		delta_coord_t dy = delta_tower_y[i] - cartesianPosSteps[Y_AXIS];
+		long temp = delta_rod_squared[i] - dx*dx - dy*dy; // float math truncates the radicand like before
+		if(temp<0) return 0;
+#if DELTA_INCREMENTAL_IK
+		deltaPosSteps[i] = delta_sqrt(temp,&delta_root[i]) + cartesianPosSteps[Z_AXIS];
+#else
+		deltaPosSteps[i] = sqrt(temp) + cartesianPosSteps[Z_AXIS];
+#endif
+	}
+	return 1;
+}
 
+/**
+  Calculate the cartesian position from the tower positions (forward kinematics). The effector is the
+  lower intersection point of the spheres with the rod lengths around the carriages. Float math, only
+  used after homing.
+  @param deltaPosSteps Array containing tower coordinates.
+  @param cartesianPosSteps Result array with cartesian coordinates.
+  @returns 1 if the rods can reach a common point, 0 if not.
+*/
+byte calculate_cartesian(long deltaPosSteps[], long cartesianPosSteps[]) {
+	const float p1[3] = {(float)delta_tower_x[0],(float)delta_tower_y[0],(float)deltaPosSteps[0]};
+	const float p2[3] = {(float)delta_tower_x[1],(float)delta_tower_y[1],(float)deltaPosSteps[1]};
+	const float p3[3] = {(float)delta_tower_x[2],(float)delta_tower_y[2],(float)deltaPosSteps[2]};
+	float ex[3],ey[3],ez[3],v[3];
+	float d2 = 0,i = 0,j2 = 0;
+	for(byte k=0; k < 3; k++) {
+		ex[k] = p2[k]-p1[k];
+		v[k] = p3[k]-p1[k];
+		d2 += ex[k]*ex[k];
+	}
+	float d = sqrt(d2);
+	for(byte k=0; k < 3; k++) {
+		ex[k] /= d;
+		i += ex[k]*v[k];
+	}
+	for(byte k=0; k < 3; k++) {
+		ey[k] = v[k]-i*ex[k];
+		j2 += ey[k]*ey[k];
+	}
+	float j = sqrt(j2);
+	for(byte k=0; k < 3; k++) ey[k] /= j;
+	ez[0] = ex[1]*ey[2]-ex[2]*ey[1];
+	ez[1] = ex[2]*ey[0]-ex[0]*ey[2];
+	ez[2] = ex[0]*ey[1]-ex[1]*ey[0];
+	// Position in the coordinate system of ex, ey, ez with the first carriage as origin
+	float x = ((float)delta_rod_squared[0]-(float)delta_rod_squared[1]+d2)/(2.0*d);
+	float y = ((float)delta_rod_squared[0]-(float)delta_rod_squared[2]+i*i+j2)/(2.0*j)-i*x/j;
+	float z2 = (float)delta_rod_squared[0]-x*x-y*y;
+	if(z2<0) return 0;
+	float z = sqrt(z2);
+	for(byte k=0; k < 3; k++) {
+		float pos = p1[k]+x*ex[k]+y*ey[k]-z*ez[k]; // ez points up, the effector is below the carriages
+		cartesianPosSteps[k] = (long)(pos<0 ? pos-0.5 : pos+0.5);
+	}
 	return 1;
 }
 
+/** Tower position at the endstops. All towers stop at the same height, the one of the effector at
+x = y = 0 and z = zMaxSteps without per tower corrections. */
+long delta_endstop_height() {
+	return printer_state.zMaxSteps+(long)sqrt(DELTA_DIAGONAL_ROD_STEPS_SQUARED-DELTA_RADIUS_STEPS*DELTA_RADIUS_STEPS);
+}
+
 inline void calculate_dir_delta(long difference[], byte *dir, long delta[]) {
   *dir = 0;
 	//Find direction
@@ -1031,11 +1637,8 @@ float calc_zoffset(long factors[], long pointX, long pointY) {
 
 inline void queue_E_move(long e_diff,byte check_endstops,byte pathOptimize) {
   printer_state.flag0 &= ~PRINTER_FLAG0_STEPPER_DISABLED; // Motor is enabled now
-  while(lines_count>=MOVE_CACHE_SIZE) { // wait for a free entry in movement cache
-    gcode_read_serial();
-    check_periodical();
-  }
-  byte newPath=check_new_move(pathOptimize, 0);
+  wait_for_move_cache(MOVE_CACHE_SIZE); // wait for a free entry in movement cache
+  check_new_move(pathOptimize, 0);
   PrintLine *p = &lines[lines_write_pos];
   float axis_diff[4]; // Axis movement in mm
   if(check_endstops) p->flags = FLAG_CHECK_ENDSTOPS;
@@ -1069,18 +1672,102 @@ inline void queue_E_move(long e_diff,byte check_endstops,byte pathOptimize) {
   //Define variables that are needed for the Bresenham algorithm. Please note that  Z is not currently included in the Bresenham algorithm.
   p->primaryAxis = 3;
   p->stepsRemaining = p->delta[3];
-  p->distance = fabs(axis_diff[3]);
   p->moveID = lastMoveID++;
-  calculate_move(p,axis_diff,check_endstops,pathOptimize);
+  calculate_move(p,axis_diff,fabs(axis_diff[3]),check_endstops,pathOptimize);
+}
+
+#if DELTA_ADAPTIVE_SEGMENTS
+/** \brief Effector deviation per squared segment length at x,y in steps, for segments in direction ux,uy.
+
+Inside a segment a tower height h = sqrt(L^2-d^2), with d the horizontal vector to the tower, deviates
+-(h^2+(d.u)^2)/h^3*s^2/8 from its chord in the middle of a segment of length s. The rod vectors r = (d,h)
+map an effector deviation p to tower deviations r.p/h, so p is the solution of R*p = w*s^2/8 with
+w = 1+(d.u)^2/h^2.
+*/
+float delta_segment_deviation(float x,float y,float ux,float uy) {
+	const float towerX[3] = {DELTA_TOWER1_X_STEPS,DELTA_TOWER2_X_STEPS,DELTA_TOWER3_X_STEPS};
+	const float towerY[3] = {DELTA_TOWER1_Y_STEPS,DELTA_TOWER2_Y_STEPS,DELTA_TOWER3_Y_STEPS};
+	float r[3][3],w[3];
+	for(byte i=0; i < 3; i++) {
+		float dx = towerX[i]-x,dy = towerY[i]-y;
+		float h2 = DELTA_DIAGONAL_ROD_STEPS_SQUARED-dx*dx-dy*dy;
+		if(h2<1.0) h2 = 1.0; // Unreachable, calculate_delta reports it
+		float du = dx*ux+dy*uy;
+		r[i][0] = dx;
+		r[i][1] = dy;
+		r[i][2] = sqrt(h2);
+		w[i] = 1.0+du*du/h2;
+	}
+	// Cramer's rule
+	float c0 = r[1][1]*r[2][2]-r[1][2]*r[2][1],c1 = r[1][2]*r[2][0]-r[1][0]*r[2][2],c2 = r[1][0]*r[2][1]-r[1][1]*r[2][0];
+	float det = r[0][0]*c0+r[0][1]*c1+r[0][2]*c2;
+	float px = w[0]*c0+r[0][1]*(w[2]*r[1][2]-w[1]*r[2][2])+r[0][2]*(w[1]*r[2][1]-w[2]*r[1][1]);
+	float py = r[0][0]*(w[1]*r[2][2]-w[2]*r[1][2])+w[0]*c1+r[0][2]*(w[2]*r[1][0]-w[1]*r[2][0]);
+	float pz = r[0][0]*(w[2]*r[1][1]-w[1]*r[2][1])+r[0][1]*(w[1]*r[2][0]-w[2]*r[1][0])+w[0]*c2;
+	return 0.125*sqrt(px*px+py*py+pz*pz)/fabs(det);
+}
+/** \brief Number of delta segments keeping the effector within DELTA_SEGMENT_MAX_ERROR of the straight xy line.
+
+The deviation per squared segment length is computed at both ends and in the middle of the move with
+delta_segment_deviation, the largest one gives the segment length.
+@param difference Move in steps.
+*/
+int delta_error_segments(long difference[]) {
+	float len2 = (float)difference[X_AXIS]*difference[X_AXIS]+(float)difference[Y_AXIS]*difference[Y_AXIS];
+	int segments = 0;
+	if(len2>0) {
+		float inv = 1.0/sqrt(len2);
+		float ux = difference[X_AXIS]*inv,uy = difference[Y_AXIS]*inv,k = 0;
+		for(byte i=0; i < 3; i++) {
+			float x = printer_state.currentPositionSteps[X_AXIS]+0.5*i*difference[X_AXIS];
+			float y = printer_state.currentPositionSteps[Y_AXIS]+0.5*i*difference[Y_AXIS];
+			float ki = delta_segment_deviation(x,y,ux,uy);
+			if(ki>k) k = ki;
+		}
+		// Squared length of the longest allowed segment
+		float seg2 = (DELTA_SEGMENT_MAX_ERROR*AXIS_STEPS_PER_MM)/k;
+		segments = ceil(sqrt(len2/seg2));
+	}
+#if DELTA_JIT_SEGMENTS
+	return max(1,segments);
+#else
+	// Keep z part of the tower steps per segment well inside 16 bit
+	int zsegments = (labs(difference[Z_AXIS])+32767)/32768;
+	return max(1,max(segments,zsegments));
+#endif
 }
+#endif
+
+/** State of the delta move, whose lines are queued by delta_split_continue. */
+typedef struct {
+	long start[4];          ///< Start position in steps
+	long difference[4];     ///< Whole move in steps
+	long delta[4];          ///< Absolute steps of the whole move
+	float distance;         ///< Length of the whole move in mm
+	float feedrate;         ///< Feedrate of the move, lines queued later must not use a changed printer_state.feedrate
+	byte dir;               ///< Direction flags of the whole move
+	byte checkEndstops;
+	byte pathOptimize;
+	byte softEndstop;
+	byte segmentWait;       ///< The next line was counted in delta_segment_waits already
+	int numLines;
+	int segmentsPerLine;
+	int lineNumber;         ///< Next line to queue, 1 = first
+} DeltaSplitState;
+DeltaSplitState delta_split;
+/** Nonzero, while a delta move still has lines to queue. */
+byte delta_split_pending = 0;
 
 /**
   Split a line up into a series of lines with at most MAX_DELTA_SEGMENTS_PER_LINE delta segments.
+  The lines are queued by delta_split_continue.
   @param check_endstops Check endstops during the move.
   @param pathOptimize Run the path optimizer.
-  @param delta_step_rate delta step rate in segments per second for the move.
+  @param softEndstop Limit the move to the printer dimensions.
+  @param wait Queue all lines before returning. Otherwise only the lines that fit without waiting are queued.
 */
-void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop) {
+void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop, byte wait) {
+    PLANNER_STATS_BEGIN;
     if (softEndstop && printer_state.destinationSteps[2] < 0) printer_state.destinationSteps[2] = 0;
 	long difference[NUM_AXIS];
 	float axis_diff[5]; // Axis movement in mm. Virtual axis in 4;
@@ -1122,31 +1809,52 @@ void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop) {
 	int segments_per_line;
 
 	if (save_dir & 48) {
+#if DELTA_ADAPTIVE_SEGMENTS
+		segment_count = delta_error_segments(difference);
+#else
 		// Compute number of seconds for move and hence number of segments needed
 		float seconds = 100 * save_distance / (printer_state.feedrate * printer_state.feedrateMultiply);
 #ifdef DEBUG_SPLIT
 		out.println_float_P(PSTR("Seconds: "), seconds);
 #endif
 		segment_count = max(1, int(((save_dir & 136)==136 ? DELTA_SEGMENTS_PER_SECOND_PRINT : DELTA_SEGMENTS_PER_SECOND_MOVE) * seconds));
+#endif
 		// Now compute the number of lines needed
 		num_lines = (segment_count + MAX_DELTA_SEGMENTS_PER_LINE - 1)/MAX_DELTA_SEGMENTS_PER_LINE;
+#if DELTA_ADAPTIVE_SEGMENTS
+		// Round up, fewer segments would be longer than the error bound allows
+		segments_per_line = (segment_count + num_lines - 1) / num_lines;
+#else
 		// There could be some error here but it doesn't matter since the number of segments will just be reduced slightly
 		segments_per_line = segment_count / num_lines;
+#endif
 	} else {
 		// Optimize pure Z axis move. Since a pure Z axis move is linear all we have to watch out for is unsigned integer overuns in
 		// the queued moves;
 #ifdef DEBUG_SPLIT
 		out.println_long_P(PSTR("Z delta: "), save_delta[2]);
 #endif
-		segment_count = (save_delta[2] + (unsigned long)65534) / (unsigned long)65535;
+		segment_count = (save_delta[2] + (unsigned long)DELTA_MAX_SEGMENT_STEPS - 1) / (unsigned long)DELTA_MAX_SEGMENT_STEPS;
 		num_lines = (segment_count + MAX_DELTA_SEGMENTS_PER_LINE - 1)/MAX_DELTA_SEGMENTS_PER_LINE;
 		segments_per_line = segment_count / num_lines;
 	}
 
-	long start_position[4], fractional_steps[4];
+	DeltaSplitState *s = &delta_split;
 	for (byte i = 0; i < 4; i++) {
-		start_position[i] = printer_state.currentPositionSteps[i];
+		s->start[i] = printer_state.currentPositionSteps[i];
+		s->difference[i] = difference[i];
+		s->delta[i] = save_delta[i];
 	}
+	s->distance = save_distance;
+	s->feedrate = printer_state.feedrate;
+	s->dir = save_dir;
+	s->checkEndstops = check_endstops;
+	s->pathOptimize = pathOptimize;
+	s->softEndstop = softEndstop;
+	s->segmentWait = 0;
+	s->numLines = num_lines;
+	s->segmentsPerLine = segments_per_line;
+	s->lineNumber = 1;
 
 #ifdef DEBUG_SPLIT
 	out.println_int_P(PSTR("Segments:"), segment_count);
@@ -1155,126 +1863,280 @@ void split_delta_move(byte check_endstops,byte pathOptimize, byte softEndstop) {
 #endif
 
 	printer_state.flag0 &= ~PRINTER_FLAG0_STEPPER_DISABLED; // Motor is enabled now
-	while(lines_count>=MOVE_CACHE_SIZE) { // wait for a free entry in movement cache
-		gcode_read_serial();
-		check_periodical();
-	}
 
 	// Insert dummy moves if necessary
 	// Nead to leave at least one slot open for the first split move
-	byte newPath=check_new_move(pathOptimize, min(MOVE_CACHE_SIZE-4,num_lines-1));
+	check_new_move(pathOptimize, min(MOVE_CACHE_SIZE-4,num_lines-1));
+	PLANNER_STATS_CHARGE;
+	delta_split_pending = 1;
+	delta_split_continue(wait);
+}
 
-	for (int line_number=1; line_number < num_lines + 1; line_number++) {
-		while(lines_count>=MOVE_CACHE_SIZE) { // wait for a free entry in movement cache
-			gcode_read_serial();
-			check_periodical();
-		}
-		PrintLine *p = &lines[lines_write_pos];
-		// Downside a comparison per loop. Upside one less distance calculation and simpler code.
-		if (num_lines == 1) {
-			p->numDeltaSegments = segment_count;
-			p->dir = save_dir;
-			for (byte i=0; i < 4; i++) {
-				p->delta[i] = save_delta[i];
-				fractional_steps[i] = difference[i];
-			}
-			p->distance = save_distance;
-		} else {
-			for (byte i=0; i < 4; i++) {
-				printer_state.destinationSteps[i] = start_position[i] + (difference[i] * line_number / num_lines);
-				fractional_steps[i] = printer_state.destinationSteps[i] - printer_state.currentPositionSteps[i];
-				axis_diff[i] = fabs(fractional_steps[i]*inv_axis_steps_per_unit[i]);
-			}
-			calculate_dir_delta(fractional_steps, &p->dir, p->delta);
-			calculate_distance(axis_diff, p->dir, &p->distance);
-		}
+/** Waits until count delta segments are free. Serial input and periodical tasks go on meanwhile. */
+inline void wait_for_delta_segments(int count) {
+#if !DELTA_JIT_SEGMENTS
+	if(delta_segment_count + count <= DELTA_CACHE_SIZE) return;
+	if(!delta_split.segmentWait) delta_segment_waits++;
+	PLANNER_STATS_CHARGE;
+	while(delta_segment_count + count > DELTA_CACHE_SIZE) {
+		gcode_read_serial();
+		check_periodical();
+	}
+	PLANNER_STATS_RESUME;
+#endif
+}
 
-		p->joinFlags = 0;
-		p->moveID = lastMoveID;
+/** Queues the next line of the pending delta move, waits for free cache entries and delta segments. */
+void delta_split_line() {
+	DeltaSplitState *s = &delta_split;
+	long fractional_steps[4];
+	float axis_diff[5]; // Axis movement in mm. Virtual axis in 4;
+	wait_for_move_cache(MOVE_CACHE_SIZE); // wait for a free entry in movement cache
+	wait_for_delta_segments(s->segmentsPerLine);
+	s->segmentWait = 0;
+	PrintLine *p = &lines[lines_write_pos];
+	float distance = 0;
+	for (byte i=0; i < 4; i++) {
+		printer_state.destinationSteps[i] = s->start[i] + (s->difference[i] * s->lineNumber / s->numLines);
+		fractional_steps[i] = printer_state.destinationSteps[i] - printer_state.currentPositionSteps[i];
+		axis_diff[i] = fabs(fractional_steps[i]*inv_axis_steps_per_unit[i]);
+	}
+	// Downside a comparison per loop. Upside one less distance calculation and simpler code.
+	if (s->numLines == 1) {
+		p->dir = s->dir;
+		for (byte i=0; i < 4; i++)
+			p->delta[i] = s->delta[i];
+		distance = s->distance;
+	} else {
+		calculate_dir_delta(fractional_steps, &p->dir, p->delta);
+		calculate_distance(axis_diff, p->dir, &distance);
+	}
 
-		// Only set fixed on last segment
-		if (line_number == num_lines && !pathOptimize)
-			p->joinFlags = FLAG_JOIN_END_FIXED;
+	p->joinFlags = 0;
+	p->moveID = lastMoveID;
 
-		if(check_endstops)
-			p->flags = FLAG_CHECK_ENDSTOPS;
-		else
-			p->flags = 0;
+	// Only set fixed on last segment
+	if (s->lineNumber == s->numLines && !s->pathOptimize)
+		p->joinFlags = FLAG_JOIN_END_FIXED;
 
-		p->numDeltaSegments = segments_per_line;
+	if(s->checkEndstops)
+		p->flags = FLAG_CHECK_ENDSTOPS;
+	else
+		p->flags = 0;
 
-	#if USE_OPS==1
-		p->opsReverseSteps=0;
-	#endif
+	p->numDeltaSegments = s->segmentsPerLine;
 
-		long max_delta_step = calculate_delta_segments(p, softEndstop);
+#if USE_OPS==1
+	p->opsReverseSteps=0;
+#endif
 
-	#ifdef DEBUG_SPLIT
-		out.println_long_P(PSTR("Max DS:"), max_delta_step);
-	#endif
-		long virtual_axis_move = max_delta_step * segments_per_line;
-		if (virtual_axis_move == 0 && p->delta[3] == 0) {
-			if (num_lines!=1)
-				OUT_P_LN("ERROR: No move in delta segment with > 1 segment. This should never happen and may cause a problem!");
-			return;  // Line too short in low precision area
-		}
-		p->primaryAxis = 4; // Virtual axis will lead bresenham step either way
-		if (virtual_axis_move > p->delta[3]) { // Is delta move or E axis leading
-			p->stepsRemaining = virtual_axis_move;
-			axis_diff[4] = virtual_axis_move * inv_axis_steps_per_unit[0]; // Steps/unit same as all the towers
-			// Virtual axis steps per segment
-			p->numPrimaryStepPerSegment = max_delta_step;
-		} else {
-			// Round up the E move to get something divisible by segment count which is greater than E move
-			p->numPrimaryStepPerSegment = (p->delta[3] + segments_per_line - 1) / segments_per_line;
-			p->stepsRemaining = p->numPrimaryStepPerSegment * segments_per_line;
-			axis_diff[4] = p->stepsRemaining * inv_axis_steps_per_unit[0];
-		}
+	long max_delta_step = calculate_delta_segments(p, s->softEndstop);
+
+#ifdef DEBUG_SPLIT
+	out.println_long_P(PSTR("Max DS:"), max_delta_step);
+#endif
+	long virtual_axis_move = max_delta_step * s->segmentsPerLine;
+	if (virtual_axis_move == 0 && p->delta[3] == 0) {
+		if (s->numLines!=1)
+			OUT_P_LN("ERROR: No move in delta segment with > 1 segment. This should never happen and may cause a problem!");
+		delta_split_pending = 0;
+		return;  // Line too short in low precision area
+	}
+	p->primaryAxis = 4; // Virtual axis will lead bresenham step either way
+	if (virtual_axis_move > p->delta[3]) { // Is delta move or E axis leading
+		p->stepsRemaining = virtual_axis_move;
+		axis_diff[4] = virtual_axis_move * inv_axis_steps_per_unit[0]; // Steps/unit same as all the towers
+		// Virtual axis steps per segment
+		p->numPrimaryStepPerSegment = max_delta_step;
+	} else {
+		// Round up the E move to get something divisible by segment count which is greater than E move
+		p->numPrimaryStepPerSegment = (p->delta[3] + s->segmentsPerLine - 1) / s->segmentsPerLine;
+		p->stepsRemaining = p->numPrimaryStepPerSegment * s->segmentsPerLine;
+		axis_diff[4] = p->stepsRemaining * inv_axis_steps_per_unit[0];
+	}
 #ifdef DEBUG_SPLIT
-		out.println_long_P(PSTR("Steps Per Segment:"), p->numPrimaryStepPerSegment);
-		out.println_long_P(PSTR("Virtual axis step:"), p->stepsRemaining);
+	out.println_long_P(PSTR("Steps Per Segment:"), p->numPrimaryStepPerSegment);
+	out.println_long_P(PSTR("Virtual axis step:"), p->stepsRemaining);
 #endif
 
-		calculate_move(p,axis_diff,check_endstops,pathOptimize);
-		for (byte i=0; i < 4; i++) {
-			printer_state.currentPositionSteps[i] += fractional_steps[i];
-		}
+	float feedrate = printer_state.feedrate;
+	printer_state.feedrate = s->feedrate;
+	calculate_move(p,axis_diff,distance,s->checkEndstops,s->pathOptimize);
+	printer_state.feedrate = feedrate;
+	for (byte i=0; i < 4; i++) {
+		printer_state.currentPositionSteps[i] += fractional_steps[i];
 	}
+	DELTA_GENERATE_SEGMENTS;
+	PLANNER_STATS_CHARGE; // segment generation is part of the planning
+	if(s->lineNumber++ < s->numLines) return;
+	delta_split_pending = 0;
+#if ARC_SUPPORT
+	if(!arc_pending) // Segments of one arc share the id
+#endif
 	lastMoveID++; // Will wrap at 255
 }
 
+/** \brief Queue the lines of the pending delta move.
+
+With wait = false, only lines fitting into the free move cache and delta segment cache are queued and
+the function returns, so the main loop keeps reading commands into the buffer. With wait = true all
+remaining lines are queued. Must be called before any other move is queued or the current position is
+used, as it is still inside the move.
+*/
+void delta_split_continue(byte wait) {
+	while(delta_split_pending) {
+		if(!wait) {
+			if(lines_count>=MOVE_CACHE_SIZE) return;
+#if !DELTA_JIT_SEGMENTS
+			if(delta_segment_count + delta_split.segmentsPerLine > DELTA_CACHE_SIZE) {
+				if(!delta_split.segmentWait) delta_segment_waits++;
+				delta_split.segmentWait = 1;
+				return;
+			}
+#endif
+		}
+		PLANNER_STATS_RESUME;
+		delta_split_line();
+	}
+}
+
 #endif
 
 #if ARC_SUPPORT
+/** State of the arc that is converted into segments. */
+typedef struct {
+  float center[2];       ///< Center of the arc in mm
+  float radius[2];       ///< Radius vector from center to the last generated point
+  float offset[2];       ///< Offset to center from arc start, used for drift correction
+  float cosT,sinT;       ///< Rotation per segment
+  float thetaPerSegment;
+  float extruderPerSegment;
+  float e;               ///< Extruder position of the last generated point in steps
+  float feedrate;        ///< Feedrate for the segments, limited by curvature
+  long target[3];        ///< Final x,y,e position in steps
+  uint16_t segment;      ///< Next segment to generate
+  uint16_t segments;     ///< Total number of segments
+  int8_t count;          ///< Segments since the last drift correction
+} ArcState;
+ArcState arc_state;
+/** Nonzero, while an arc still has segments to queue. */
+byte arc_pending = 0;
+
+/** Queue the next arc segment. The last segment goes to the exact target and ends the arc block. */
+void mc_arc_segment() {
+  ArcState *a = &arc_state;
+  float saved_feedrate = printer_state.feedrate;
+  printer_state.feedrate = a->feedrate;
+  if(a->segment<a->segments) {
+    if (a->count < N_ARC_CORRECTION)  //25 pieces
+    {
+      // Apply vector rotation matrix 
+      float r_axisi = a->radius[0]*a->sinT + a->radius[1]*a->cosT;
+      a->radius[0] = a->radius[0]*a->cosT - a->radius[1]*a->sinT;
+      a->radius[1] = r_axisi;
+      a->count++;
+    }
+    else
+    {
+      // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments.
+      // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
+      float cos_Ti  = cos(a->segment*a->thetaPerSegment);
+      float sin_Ti  = sin(a->segment*a->thetaPerSegment);
+      a->radius[0] = -a->offset[0]*cos_Ti + a->offset[1]*sin_Ti;
+      a->radius[1] = -a->offset[0]*sin_Ti - a->offset[1]*cos_Ti;
+      a->count = 0;
+    }
+    a->e += a->extruderPerSegment;
+    printer_state.destinationSteps[0] = (a->center[0] + a->radius[0])*axis_steps_per_unit[0];
+    printer_state.destinationSteps[1] = (a->center[1] + a->radius[1])*axis_steps_per_unit[1];
+    printer_state.destinationSteps[3] = a->e;
+    a->segment++;
+  } else { // Ensure last segment arrives at target location.
+    printer_state.destinationSteps[0] = a->target[0];
+    printer_state.destinationSteps[1] = a->target[1];
+    printer_state.destinationSteps[3] = a->target[2];
+    arc_pending = 0; // Last segment, next move gets a new move id
+  }
+#if DRIVE_SYSTEM == 3
+  split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true, false);
+#else
+  queue_move(ALWAYS_CHECK_ENDSTOPS,true);
+#endif
+  printer_state.feedrate = saved_feedrate;
+}
+/** \brief Queue segments of the pending arc.
+
+Segments are generated just in time. With wait = false, only segments fitting into the free
+move cache are queued and the function returns, so the main loop keeps running. With wait = true
+all remaining segments are queued. Must be called before any other move is queued, as the
+current position is still inside the arc. For delta printers, the lines of the last segment may
+still be pending in delta_split_continue.
+*/
+void mc_arc_continue(byte wait) {
+  byte count = 0;
+  while(arc_pending && (wait || lines_count<MOVE_CACHE_SIZE)) {
+    if((count++ & 4) == 0)
+    {
+       gcode_read_serial();
+       check_periodical();
+       UI_MEDIUM; // do check encoder
+    }
+#if DRIVE_SYSTEM == 3
+    delta_split_continue(wait); // The next segment starts at the end of the last one
+    if(delta_split_pending) return;
+#endif
+    mc_arc_segment();
+  }
+}
 // Arc function taken from grbl
 // The arc is approximated by generating a huge number of tiny, linear segments. The length of each 
-// segment is configured in settings.mm_per_arc_segment.  
+// segment is computed from ARC_MAX_CHORD_ERROR and limited by ARC_SEGMENTS_PER_SECOND.
+// The arc is stored in arc_state and the segments are queued by mc_arc_continue. All segments share
+// one move id, so the path planner treats the arc as one block.
 void mc_arc(float *position, float *target, float *offset, float radius, uint8_t isclockwise)
 {      
   //   int acceleration_manager_was_enabled = plan_is_acceleration_manager_enabled();
   //   plan_set_acceleration_manager_enabled(false); // disable acceleration management for the duration of the arc
-  float center_axis0 = position[0] + offset[0];
-  float center_axis1 = position[1] + offset[1];
-  float linear_travel = 0; //target[axis_linear] - position[axis_linear];
+  mc_arc_continue(true); // Finish previous arc
+  ArcState *a = &arc_state;
+  a->center[0] = position[0] + offset[0];
+  a->center[1] = position[1] + offset[1];
   float extruder_travel = printer_state.destinationSteps[3]-printer_state.currentPositionSteps[3];
-  float r_axis0 = -offset[0];  // Radius vector from center to current location
-  float r_axis1 = -offset[1];
-  float rt_axis0 = target[0] - center_axis0;
-  float rt_axis1 = target[1] - center_axis1;
-  long xtarget = printer_state.destinationSteps[0];
-  long ytarget = printer_state.destinationSteps[1];
-  long etarget = printer_state.destinationSteps[3];
+  a->radius[0] = -offset[0];  // Radius vector from center to current location
+  a->radius[1] = -offset[1];
+  a->offset[0] = offset[0];
+  a->offset[1] = offset[1];
+  float rt_axis0 = target[0] - a->center[0];
+  float rt_axis1 = target[1] - a->center[1];
+  a->target[0] = printer_state.destinationSteps[0];
+  a->target[1] = printer_state.destinationSteps[1];
+  a->target[2] = printer_state.destinationSteps[3];
   
   // CCW angle between position and target from circle center. Only one atan2() trig computation required.
-  float angular_travel = atan2(r_axis0*rt_axis1-r_axis1*rt_axis0, r_axis0*rt_axis0+r_axis1*rt_axis1);
+  float angular_travel = atan2(a->radius[0]*rt_axis1-a->radius[1]*rt_axis0, a->radius[0]*rt_axis0+a->radius[1]*rt_axis1);
   if (angular_travel < 0) { angular_travel += 2*M_PI; }
   if (isclockwise) { angular_travel -= 2*M_PI; }
   
   float millimeters_of_travel = fabs(angular_travel)*radius; //hypot(angular_travel*radius, fabs(linear_travel));
   if (millimeters_of_travel < 0.001) { return; }
-  //uint16_t segments = (radius>=BIG_ARC_RADIUS ? floor(millimeters_of_travel/MM_PER_ARC_SEGMENT_BIG) : floor(millimeters_of_travel/MM_PER_ARC_SEGMENT));
-  // Increase segment size if printing faster then computation speed allows
-  uint16_t segments = (printer_state.feedrate>60 ? floor(millimeters_of_travel/min(MM_PER_ARC_SEGMENT_BIG,printer_state.feedrate*0.01666*MM_PER_ARC_SEGMENT)) : floor(millimeters_of_travel/MM_PER_ARC_SEGMENT));
+  // Longest chord with a maximum distance of ARC_MAX_CHORD_ERROR to the arc: 2*sqrt(e*(2r-e))
+  float mm_per_segment = (radius>ARC_MAX_CHORD_ERROR ? 2.0*sqrt(ARC_MAX_CHORD_ERROR*(2.0*radius-ARC_MAX_CHORD_ERROR)) : radius);
+  // Limit speed, so the centripetal acceleration v^2/r stays within the acceleration limits.
+  // The junctions inside the arc are then not limited any more.
+  a->feedrate = printer_state.feedrate;
+#ifdef RAMP_ACCELERATION
+  float accel = ((printer_state.destinationSteps[3]>printer_state.currentPositionSteps[3]) ?
+     min(max_acceleration_units_per_sq_second[0],max_acceleration_units_per_sq_second[1]) :
+     min(max_travel_acceleration_units_per_sq_second[0],max_travel_acceleration_units_per_sq_second[1]));
+  float vmax2 = accel*radius;
+  if(a->feedrate*a->feedrate>vmax2) a->feedrate = sqrt(vmax2);
+#endif
+  float nseg = ceil(millimeters_of_travel/mm_per_segment);
+  // Increase segment size if the arc is printed faster then the planner can follow
+  float maxseg = ceil(millimeters_of_travel*ARC_SEGMENTS_PER_SECOND/a->feedrate);
+  if(nseg>maxseg) nseg = maxseg;
+  if(nseg>65535) nseg = 65535;
+  uint16_t segments = nseg;
   if(segments == 0) segments = 1;
   /*  
     // Multiply inverse feed_rate to compensate for the fact that this movement is approximated
@@ -1282,9 +2144,8 @@ void mc_arc(float *position, float *target, float *offset, float radius, uint8_t
     // all segments.
     if (invert_feed_rate) { feed_rate *= segments; }
   */
-  float theta_per_segment = angular_travel/segments;
-  float linear_per_segment = linear_travel/segments;
-  float extruder_per_segment = extruder_travel/segments;
+  a->thetaPerSegment = angular_travel/segments;
+  a->extruderPerSegment = extruder_travel/segments;
   
   /* Vector rotation by transformation matrix: r is the original vector, r_T is the rotated vector,
      and phi is the angle of rotation. Based on the solution approach by Jens Geisler.
@@ -1312,74 +2173,18 @@ void mc_arc(float *position, float *target, float *offset, float radius, uint8_t
      This is important when there are successive arc motions. 
   */
   // Vector rotation matrix values
-  float cos_T = 1-0.5*theta_per_segment*theta_per_segment; // Small angle approximation
-  float sin_T = theta_per_segment;
-  
-  float arc_target[4];
-  float sin_Ti;
-  float cos_Ti;
-  float r_axisi;
-  uint16_t i;
-  int8_t count = 0;
+  a->cosT = 1-0.5*a->thetaPerSegment*a->thetaPerSegment; // Small angle approximation
+  a->sinT = a->thetaPerSegment;
 
   // Initialize the linear axis
   //arc_target[axis_linear] = position[axis_linear];
   
   // Initialize the extruder axis
-  arc_target[3] = printer_state.currentPositionSteps[3];
-
-  for (i = 1; i<segments; i++) 
-  { // Increment (segments-1)
-    
-    if((count & 4) == 0)
-    {
-       gcode_read_serial();
-       check_periodical();
-       UI_MEDIUM; // do check encoder
-    }
-
-    if (count < N_ARC_CORRECTION)  //25 pieces
-    {
-      // Apply vector rotation matrix 
-      r_axisi = r_axis0*sin_T + r_axis1*cos_T;
-      r_axis0 = r_axis0*cos_T - r_axis1*sin_T;
-      r_axis1 = r_axisi;
-      count++;
-    }
-    else
-    {
-      // Arc correction to radius vector. Computed only every N_ARC_CORRECTION increments.
-      // Compute exact location by applying transformation matrix from initial radius vector(=-offset).
-      cos_Ti  = cos(i*theta_per_segment);
-      sin_Ti  = sin(i*theta_per_segment);
-      r_axis0 = -offset[0]*cos_Ti + offset[1]*sin_Ti;
-      r_axis1 = -offset[0]*sin_Ti - offset[1]*cos_Ti;
-      count = 0;
-    }
-
-    // Update arc_target location
-    arc_target[0] = center_axis0 + r_axis0;
-    arc_target[1] = center_axis1 + r_axis1;
-    //arc_target[axis_linear] += linear_per_segment;
-    arc_target[3] += extruder_per_segment;
-    
-    printer_state.destinationSteps[0] = arc_target[0]*axis_steps_per_unit[0];
-    printer_state.destinationSteps[1] = arc_target[1]*axis_steps_per_unit[1];
-    printer_state.destinationSteps[3] = arc_target[3];
-#if DRIVE_SYSTEM == 3
-    split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true);
-#else
-    queue_move(ALWAYS_CHECK_ENDSTOPS,true);
-#endif
-  }
-  // Ensure last segment arrives at target location.
-  printer_state.destinationSteps[0] = xtarget;
-  printer_state.destinationSteps[1] = ytarget;
-  printer_state.destinationSteps[3] = etarget;
-#if DRIVE_SYSTEM == 3
-  split_delta_move(ALWAYS_CHECK_ENDSTOPS, true, true);
-#else
-  queue_move(ALWAYS_CHECK_ENDSTOPS,true);
-#endif
+  a->e = printer_state.currentPositionSteps[3];
+  a->segment = 1;
+  a->segments = segments;
+  a->count = 0;
+  arc_pending = 1;
+  mc_arc_continue(false);
 }
 #endif
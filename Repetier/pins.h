@@ -8,6 +8,7 @@ Each board definition follows the following scheme:
 CPU_ARCH
   ARCH_AVR for AVR based boards
   ARCH_ARM for all arm based boards
+  ARCH_HOST for the host build in host/, set by its Makefile
 
 STEPPER_CURRENT_CONTROL
   CURRENT_CONTROL_MANUAL  1  // mechanical poti, default if not defined
@@ -18,6 +19,7 @@ STEPPER_CURRENT_CONTROL
 
 #define ARCH_AVR 1
 #define ARCH_ARM 2
+#define ARCH_HOST 3
 
 #define CURRENT_CONTROL_MANUAL  1  // mechanical poti, default if not defined
 #define CURRENT_CONTROL_DIGIPOT 2  // Use a digipot like RAMBO does
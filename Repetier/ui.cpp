@@ -48,7 +48,7 @@ const int8_t encoder_table[16] PROGMEM = {0,0,0,0,0,0,0,0,1,0,0,0,0,-1,0,0}; //
 #endif
 
 #if UI_AUTORETURN_TO_MENU_AFTER!=0
-long ui_autoreturn_time=0;
+unsigned long ui_autoreturn_time=0;
 #endif
 
 void beep(byte duration,byte count)
@@ -989,7 +989,7 @@ void UIDisplay::parse(char *txt,bool ram) {
           break;
         }
         if(c2=='c') {addLong(baudrate,6);break;}
-        if(c2=='e') {if(errorMsg!=0)addStringP((char PROGMEM *)errorMsg);break;}
+        if(c2=='e') {if(errorMsg!=0)addStringP(errorMsg);break;}
         if(c2=='B') {addInt((int)lines_count,2);break;}
         if(c2=='f') {addInt(printer_state.extrudeMultiply,3);break;}
         if(c2=='m') {addInt(printer_state.feedrateMultiply,3);break;}
@@ -1005,7 +1005,7 @@ void UIDisplay::parse(char *txt,bool ram) {
           printCols[col++]='%';
         break;
       case 'x':
-        if(c2>='0' && c2<='3') 
+        if(c2>='0' && c2<='3') {
 #if NUM_EXTRUDER>0
         if(c2=='0')
           fvalue = (float)(printer_state.currentPositionSteps[c2-'0']+current_extruder->xOffset)*inv_axis_steps_per_unit[c2-'0'];
@@ -1016,6 +1016,7 @@ void UIDisplay::parse(char *txt,bool ram) {
 #else 
         fvalue = (float)printer_state.currentPositionSteps[c2-'0']*inv_axis_steps_per_unit[c2-'0'];
 #endif
+        }
         addFloat(fvalue,3,2);
         break;
       case 'y':
@@ -1125,7 +1126,6 @@ byte nFilesOnCard;
 
 void UIDisplay::updateSDFileCount() {
   dir_t* p;
-  byte offset = menuTop[menuLevel];
   SdBaseFile *root = sd.fat.vwd();
   root->rewind();
   nFilesOnCard = 0;
@@ -1234,7 +1234,7 @@ void UIDisplay::sdrefresh(byte &r) {
 // Refresh current menu page
 void UIDisplay::refreshPage() {
   byte r;
-  byte mtype;
+  byte mtype = 0;
   if(menuLevel==0) {
     UIMenu *men = (UIMenu*)pgm_read_word(&(ui_pages[menuPos[0]]));
     byte nr = pgm_read_word_near(&(men->numEntries));
@@ -1386,7 +1386,7 @@ void UIDisplay::okAction() {
   }
 #endif
   if(entType==2) { // Enter submenu
-    pushMenu((void*)action,false);
+    pushMenu((void*)(size_t)action,false);
     BEEP_SHORT
     return;
   }
@@ -1419,7 +1419,6 @@ void UIDisplay::nextPreviousAction(char next) {
   byte mtype = pgm_read_byte(&(men->menuType));
   UIMenuEntry **entries = (UIMenuEntry**)pgm_read_word(&(men->entries));
   UIMenuEntry *ent =(UIMenuEntry *)pgm_read_word(&(entries[menuPos[menuLevel]]));
-  unsigned char entType = pgm_read_byte(&(ent->menuType));// 0 = Info, 1 = Headline, 2 = submenu ref, 3 = direct action command
   int action = pgm_read_word(&(ent->action));
   if(mtype==2 && activeAction==0) { // browse through menu items
     if((UI_INVERT_MENU_DIRECTION && next<0) || (!UI_INVERT_MENU_DIRECTION && next>0)) {
@@ -1620,7 +1619,7 @@ void UIDisplay::nextPreviousAction(char next) {
   case UI_ACTION_BAUDRATE:
 #if EEPROM_MODE!=0
     {
-      char p=0;
+      int8_t p=0;
       long rate;
       do {
         rate = pgm_read_dword(&(baudrates[p]));
@@ -1769,6 +1768,12 @@ void UIDisplay::executeAction(int action) {
       printPosition();
       break;
     case UI_ACTION_SET_ORIGIN:
+#if MOVE_COALESCING
+      coalesce_flush(); // Held back move ends at the old origin
+#endif
+#if DRIVE_SYSTEM==3
+      delta_split_continue(true);
+#endif
       printer_state.currentPositionSteps[0] = -printer_state.offsetX;
       printer_state.currentPositionSteps[1] = -printer_state.offsetY;
       printer_state.currentPositionSteps[2] = 0;
@@ -1854,6 +1859,12 @@ void UIDisplay::executeAction(int action) {
       kill(true);
       break;
     case UI_ACTION_RESET_EXTRUDER:
+#if MOVE_COALESCING
+      coalesce_flush();
+#endif
+#if DRIVE_SYSTEM==3
+      delta_split_continue(true);
+#endif
       printer_state.currentPositionSteps[3] = 0;
       break;
     case UI_ACTION_EXTRUDER_RELATIVE:
@@ -2082,6 +2093,7 @@ void UIDisplay::executeAction(int action) {
 			printer_state.countZSteps = -printer_state.countZSteps;
 		printer_state.zLength = inv_axis_steps_per_unit[2] * printer_state.countZSteps;
 		printer_state.zMaxSteps = printer_state.countZSteps;
+		delta_split_continue(true);
 		for (byte i=0; i<3; i++) {
 			printer_state.currentPositionSteps[i] = 0;
 		}
@@ -2211,7 +2223,7 @@ void UIDisplay::slowAction() {
     sei();
     int nextAction = 0;
     ui_check_slow_keys(nextAction);
-    if(lastButtonAction!=nextAction) {
+    if(lastButtonAction!=(unsigned int)nextAction) {
       lastButtonStart = time;
       lastButtonAction = nextAction;
       cli();
@@ -2279,10 +2291,14 @@ void UIDisplay::slowAction() {
       refresh = 1;
     } else if(time-lastRefresh>=1000) refresh=1;
   } else if(time-lastRefresh>=1000) {
-    UIMenu *men = (UIMenu*)menu[menuLevel];
-    byte mtype = pgm_read_byte((void*)&(men->menuType));
-    if(mtype!=1)
+    if(menuLevel==0) // status pages in the first seconds, menu[0] is not set
       refresh=1;
+    else {
+      UIMenu *men = (UIMenu*)menu[menuLevel];
+      byte mtype = pgm_read_byte((void*)&(men->menuType));
+      if(mtype!=1)
+        refresh=1;
+    }
   }
   if(refresh) {
     refreshPage();
@@ -2298,7 +2314,7 @@ void UIDisplay::fastAction() {
     sei();
     int nextAction = 0;
     ui_check_keys(nextAction);
-    if(lastButtonAction!=nextAction) {
+    if(lastButtonAction!=(unsigned int)nextAction) {
       lastButtonStart = millis();
       lastButtonAction = nextAction;
       cli();